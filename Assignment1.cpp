@@ -2,40 +2,10 @@
 #include <vector>
 #include <algorithm> 
 
-using namespace std;
-
-// union
-vector<float> fuzzyUnion(const vector<float> &A, const vector<float> &B)
-{
-    vector<float> result(A.size());
-    for (int i = 0; i < A.size(); i++)
-    {
-        result[i] = max(A[i], B[i]);
-    }
-    return result;
-}
-
-//  intersection
-vector<float> fuzzyIntersection(const vector<float> &A, const vector<float> &B)
-{
-    vector<float> result(A.size());
-    for (int i = 0; i < A.size(); i++)
-    {
-        result[i] = min(A[i], B[i]);
-    }
-    return result;
-}
+#include "fuzzy_expr.h"
+#include "fuzzy_tnorm.h"
 
-// complement
-vector<float> fuzzyComplement(const vector<float> &A)
-{
-    vector<float> result(A.size());
-    for (int i = 0; i < A.size(); i++)
-    {
-        result[i] = 1.0 - A[i];
-    }
-    return result;
-}
+using namespace std;
 
 void printSet(const vector<float> &S)
 {
@@ -56,9 +26,10 @@ int main()
     cout << "Set B: ";
     printSet(B);
 
-    vector<float> uni = fuzzyUnion(A, B);
-    vector<float> inter = fuzzyIntersection(A, B);
-    vector<float> compA = fuzzyComplement(A);
+    vector<float> uni = tnormUnion<ZadehTNorm>(A, B);
+    vector<float> inter = tnormIntersection<ZadehTNorm>(A, B);
+    vector<float> compA;
+    fuzzyComplementInto(A, compA);
 
     cout << "A union B: ";
     printSet(uni);
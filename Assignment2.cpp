@@ -1,58 +1,22 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
-using namespace std;
-
-vector<vector<float>> fuzzyUnion(const vector<vector<float>> &R, const vector<vector<float>> &S)
-{
-    vector<vector<float>> result(R.size(), vector<float>(R[0].size()));
-
-    for (int i = 0; i < R.size(); i++)
-    {
-        for (int j = 0; j < R[0].size(); j++)
-        {
-            result[i][j] = max(R[i][j], S[i][j]);
-        }
-    }
-    return result;
-}
 
-vector<vector<float>> fuzzyIntersection(const vector<vector<float>> &R, const vector<vector<float>> &S)
-{
-    vector<vector<float>> result(R.size(), vector<float>(R[0].size()));
+#include "fuzzy_composition.h"
+#include "fuzzy_expr.h"
+#include "fuzzy_relation.h"
+#include "fuzzy_tnorm.h"
 
-    for (int i = 0; i < R.size(); i++)
-    {
-        for (int j = 0; j < R[0].size(); j++)
-        {
-            result[i][j] = min(R[i][j], S[i][j]);
-        }
-    }
-    return result;
-}
-
-vector<vector<float>> fuzzyComplement(const vector<vector<float>> &R)
-{
-    vector<vector<float>> result(R.size(), vector<float>(R[0].size()));
-
-    for (int i = 0; i < R.size(); i++)
-    {
-        for (int j = 0; j < R[0].size(); j++)
-        {
-            result[i][j] = 1.0 - R[i][j];
-        }
-    }
-    return result;
-}
+using namespace std;
 
-void printRelation(const vector<vector<float>> &R)
+void printRelation(const FuzzyRelation &R)
 {
-    for (const auto &row : R)
+    for (size_t i = 0; i < R.rows(); i++)
     {
         cout << "{ ";
-        for (float val : row)
+        for (size_t j = 0; j < R.cols(); j++)
         {
-            cout << val << " ";
+            cout << R(i, j) << " ";
         }
         cout << "}" << endl;
     }
@@ -60,11 +24,11 @@ void printRelation(const vector<vector<float>> &R)
 
 int main()
 {
-    vector<vector<float>> R = {
+    FuzzyRelation R = {
         {0.2, 0.7, 1.0},
         {0.5, 0.3, 0.9}};
 
-    vector<vector<float>> S = {
+    FuzzyRelation S = {
         {0.6, 0.4, 0.8},
         {0.1, 0.9, 0.5}};
 
@@ -73,9 +37,10 @@ int main()
     cout << "Relation S:" << endl;
     printRelation(S);
 
-    auto unionRel = fuzzyUnion(R, S);
-    auto interRel = fuzzyIntersection(R, S);
-    auto compR = fuzzyComplement(R);
+    FuzzyRelation unionRel, interRel, compR(R.rows(), R.cols());
+    tnormRelationUnion<ZadehTNorm>(R, S, unionRel);
+    tnormRelationIntersection<ZadehTNorm>(R, S, interRel);
+    relationComplement(R, compR);
 
     cout << "\nUnion (R ∪ S):" << endl;
     printRelation(unionRel);
@@ -87,7 +52,7 @@ int main()
     printRelation(compR);
 
     // Define another relation T (3x2 matrix) for composition
-    vector<vector<float>> T = {
+    FuzzyRelation T = {
         {0.3, 0.6},
         {0.8, 0.2},
         {0.4, 0.9}};
@@ -95,5 +60,14 @@ int main()
     cout << "\nRelation T (for composition):" << endl;
     printRelation(T);
 
+    auto maxMinRel = maxMinComposition(R, T);
+    auto maxProdRel = maxProductComposition(R, T);
+
+    cout << "\nMax-Min Composition (R o T):" << endl;
+    printRelation(maxMinRel);
+
+    cout << "\nMax-Product Composition (R . T):" << endl;
+    printRelation(maxProdRel);
+
     return 0; // program ends successfully
 }
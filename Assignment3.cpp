@@ -1,117 +1,147 @@
 #include <bits/stdc++.h>
+#include "gwo.h"
+#include "island_model.h"
+#include "memo_cache.h"
 using namespace std;
 
-// Objective function: Sphere function f(x) = x^2
-double sphereFn(double x)
+// Objective function: Sphere function f(x) = sum of x_d^2
+struct SphereFn
 {
-    return x * x;
-}
-
-double randomDouble(double min, double max)
-{
-    return min + (max - min) * ((double)rand() / RAND_MAX);
-}
-
-int main()
+    double operator()(const double *x, size_t dims) const
+    {
+        double sum = 0.0;
+        for (size_t d = 0; d < dims; d++)
+            sum += x[d] * x[d];
+        return sum;
+    }
+};
+
+//   Assignment3 [wolves iterations dimensions lower upper [seed]] [--islands K] [--processes]
+//               [--memo N [--quantum Q]]
+//
+// Without arguments the parameters are read from the prompts. --islands runs
+// K packs of `wolves` wolves in parallel (threads, or processes with
+// --processes) that pass their two best wolves around a ring every 10
+// iterations. --memo caches up to N fitness values of a single pack by
+// position (rounded to multiples of Q if given), so wolves clamped to the
+// same point of the bounds are evaluated once.
+int main(int argc, char **argv)
 {
-    srand(time(0));
-
-    // User input
-    int numWolves, maxIter;
+    int numWolves, maxIter, dims;
     double lowerBound, upperBound;
-    cout << "Enter number of wolves: ";
-    cin >> numWolves;
-    cout << "Enter number of iterations: ";
-    cin >> maxIter;
-    cout << "Enter search space lower bound: ";
-    cin >> lowerBound;
-    cout << "Enter search space upper bound: ";
-    cin >> upperBound;
-
-    // Initialize wolf positions
-    vector<double> wolves(numWolves);
-    for (int i = 0; i < numWolves; i++)
-        wolves[i] = randomDouble(lowerBound, upperBound);
-
-    double alpha, beta, delta;  // best three wolves
-    alpha = beta = delta = 1e9; // very large number
-
-    double alphaPos = 0, betaPos = 0, deltaPos = 0;
+    uint64_t seed = time(0);
+    int islands = 1;
+    IslandParams islandParams;
+    size_t memo = 0;
+    double quantum = 0.0;
+    vector<char *> args(1, argv[0]);
+    for (int a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--islands") == 0 && a + 1 < argc)
+            islands = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--memo") == 0 && a + 1 < argc)
+            memo = strtoul(argv[++a], 0, 10);
+        else if (strcmp(argv[a], "--quantum") == 0 && a + 1 < argc)
+            quantum = atof(argv[++a]);
+        else if (strcmp(argv[a], "--processes") == 0)
+            islandParams.execution = ISLANDS_AS_PROCESSES;
+        else
+            args.push_back(argv[a]);
+    }
+    if (args.size() >= 6)
+    {
+        numWolves = atoi(args[1]);
+        maxIter = atoi(args[2]);
+        dims = atoi(args[3]);
+        lowerBound = atof(args[4]);
+        upperBound = atof(args[5]);
+        if (args.size() >= 7)
+            seed = strtoull(args[6], 0, 10);
+    }
+    else
+    {
+        // User input
+        cout << "Enter number of wolves: ";
+        cin >> numWolves;
+        cout << "Enter number of iterations: ";
+        cin >> maxIter;
+        cout << "Enter number of dimensions: ";
+        cin >> dims;
+        cout << "Enter search space lower bound: ";
+        cin >> lowerBound;
+        cout << "Enter search space upper bound: ";
+        cin >> upperBound;
+    }
+    if (numWolves < 1 || maxIter < 0 || dims < 1 || lowerBound > upperBound || islands < 1)
+    {
+        cout << "Invalid parameters." << endl;
+        return 1;
+    }
 
-    // Optimization loop
-    for (int t = 0; t < maxIter; t++)
+    if (islands > 1)
     {
-        // Update alpha, beta, delta wolves
-        for (int i = 0; i < numWolves; i++)
+        // One pack per island, each on its own thread (or process)
+        vector<unique_ptr<GreyWolfOptimizer> > packs;
+        vector<unique_ptr<GwoSearch<SphereFn> > > searches;
+        vector<GwoSearch<SphereFn> *> islandSearches;
+        for (int k = 0; k < islands; k++)
         {
-            double fitness = sphereFn(wolves[i]);
-            if (fitness < alpha)
-            {
-                delta = beta;
-                deltaPos = betaPos;
-                beta = alpha;
-                betaPos = alphaPos;
-                alpha = fitness;
-                alphaPos = wolves[i];
-            }
-            else if (fitness < beta)
-            {
-                delta = beta;
-                deltaPos = betaPos;
-                beta = fitness;
-                betaPos = wolves[i];
-            }
-            else if (fitness < delta)
-            {
-                delta = fitness;
-                deltaPos = wolves[i];
-            }
+            packs.push_back(unique_ptr<GreyWolfOptimizer>(
+                new GreyWolfOptimizer(numWolves, dims, lowerBound, upperBound, seed + k, serialThreadPool())));
+            searches.push_back(unique_ptr<GwoSearch<SphereFn> >(new GwoSearch<SphereFn>(*packs[k], SphereFn())));
+            islandSearches.push_back(searches[k].get());
         }
-
-        // Parameter 'a' decreases from 2 to 0
-        double a = 2.0 - (2.0 * t / maxIter);
-
-        // Update positions of wolves
-        for (int i = 0; i < numWolves; i++)
+        IslandModel<GwoSearch<SphereFn> > model(islandSearches, islandParams);
+        RunLimits limits;
+        limits.maxIterations = maxIter;
+        RunResult result = model.run(limits);
+        if (model.failedIslands() == (size_t)islands)
         {
-            double r1 = randomDouble(0, 1);
-            double r2 = randomDouble(0, 1);
-
-            double A1 = 2 * a * r1 - a;
-            double C1 = 2 * r2;
-
-            double D_alpha = fabs(C1 * alphaPos - wolves[i]);
-            double X1 = alphaPos - A1 * D_alpha;
-
-            r1 = randomDouble(0, 1);
-            r2 = randomDouble(0, 1);
-            double A2 = 2 * a * r1 - a;
-            double C2 = 2 * r2;
-
-            double D_beta = fabs(C2 * betaPos - wolves[i]);
-            double X2 = betaPos - A2 * D_beta;
-
-            r1 = randomDouble(0, 1);
-            r2 = randomDouble(0, 1);
-            double A3 = 2 * a * r1 - a;
-            double C3 = 2 * r2;
-
-            double D_delta = fabs(C3 * deltaPos - wolves[i]);
-            double X3 = deltaPos - A3 * D_delta;
-
-            // New position
-            wolves[i] = (X1 + X2 + X3) / 3.0;
-
-            // Bound check
-            if (wolves[i] < lowerBound)
-                wolves[i] = lowerBound;
-            if (wolves[i] > upperBound)
-                wolves[i] = upperBound;
+            cerr << "All " << islands << " islands failed" << endl;
+            return 1;
         }
+        if (model.failedIslands())
+            cerr << "Warning: " << model.failedIslands() << " of " << islands << " islands failed" << endl;
+
+        const double *x = model.bestPosition();
+        cout << "Best solution found: x = (";
+        for (int d = 0; d < dims && d < 5; d++)
+            cout << (d ? ", " : "") << x[d];
+        if (dims > 5)
+            cout << ", ...";
+        cout << "), f(x) = " << result.bestFitness << " (island " << model.bestIsland() + 1 << ")" << endl;
+        cout << "Seed: " << seed << ", migrants sent " << model.migrantsSent() << ", accepted "
+             << model.migrantsAccepted() << endl;
+        cout << islands << " islands x " << numWolves << " wolves x " << dims << " dimensions x " << maxIter
+             << " iterations in " << result.seconds << " s" << endl;
+        return 0;
     }
 
-    cout << "Best solution found: x = " << alphaPos
-         << ", f(x) = " << alpha << endl;
+    GreyWolfOptimizer gwo(numWolves, dims, lowerBound, upperBound, seed);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    MemoCache<> cache(memo ? memo : 1);
+    double best = memo ? gwo.run(MemoizedObjective<SphereFn>(SphereFn(), cache, quantum), maxIter)
+                       : gwo.run(SphereFn(), maxIter);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    // Best solution, first few coordinates for large dimensions
+    const double *x = gwo.alphaPosition();
+    cout << "Best solution found: x = (";
+    for (int d = 0; d < dims && d < 5; d++)
+        cout << (d ? ", " : "") << x[d];
+    if (dims > 5)
+        cout << ", ...";
+    cout << "), f(x) = " << best << endl;
+    cout << "Seed: " << seed << " (pass it as the sixth argument to repeat the run)" << endl;
+    cout << numWolves << " wolves x " << dims << " dimensions x " << maxIter << " iterations in "
+         << elapsed.count() << " s" << endl;
+    if (memo)
+    {
+        MemoStats stats = cache.stats();
+        cout << "Memo: " << stats.hits << " hits, " << stats.misses << " misses (" << 100.0 * stats.hitRate()
+             << "%), " << stats.evictions << " evictions" << endl;
+    }
 
     return 0;
 }
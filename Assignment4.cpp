@@ -1,152 +1,173 @@
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <cmath>
-#include <algorithm>
+#include <chrono>
+#include "aco_tsp.h"
+#include "tsp_local_search.h"
 
 using namespace std;
 
-// Number of nodes
-const int N = 5;
-
 // Parameters
 const int NUM_ANTS = 10;
 const int NUM_ITERATIONS = 100;
 const double ALPHA = 1.0; // Importance of pheromone
 const double BETA = 5.0;  // Importance of distance
 const double EVAPORATION = 0.5;
-const double Q = 100;
-
-// Graph distances (symmetric)
-double distances[N][N] = {
-    {0, 2, 2, 5, 7},
-    {2, 0, 4, 8, 2},
-    {2, 4, 0, 1, 3},
-    {5, 8, 1, 0, 2},
-    {7, 2, 3, 2, 0}};
-
-// Pheromone levels on edges
-double pheromones[N][N];
-
-// Initialize pheromones
-void initializePheromones()
+const int LOCAL_SEARCH_NEIGHBOURS = 10;
+
+// The original 5-city example, as a TSPLIB instance
+const char *SMALL_TSP =
+    "NAME : small5\n"
+    "TYPE : TSP\n"
+    "DIMENSION : 5\n"
+    "EDGE_WEIGHT_TYPE : EXPLICIT\n"
+    "EDGE_WEIGHT_FORMAT : FULL_MATRIX\n"
+    "EDGE_WEIGHT_SECTION\n"
+    "0 2 2 5 7\n"
+    "2 0 4 8 2\n"
+    "2 4 0 1 3\n"
+    "5 8 1 0 2\n"
+    "7 2 3 2 0\n"
+    "EOF\n";
+
+// Degenerate layout: n cities at random points of a line (every y = 0),
+// whose optimal tour runs out to one end and back, about twice the span
+void collinearInstance(size_t n, uint64_t seed, TspInstance &tsp)
 {
-    for (int i = 0; i < N; i++)
-        for (int j = 0; j < N; j++)
-            pheromones[i][j] = 1.0;
+    Xoshiro256 rng(seed);
+    tsp.name = "collinear";
+    tsp.n = n;
+    tsp.type = TSP_EUC_2D;
+    for (size_t i = 0; i < n; i++)
+    {
+        tsp.x.push_back(rng.uniform(0.0, 1e6));
+        tsp.y.push_back(0.0);
+    }
 }
 
-// Choose next city probabilistically
-int chooseNextCity(int current, const vector<bool> &visited)
+// Run the ACO algorithm
+void runACO(const TspInstance &tsp, const AcoParams &params, int iterations, bool localSearch, size_t memo)
 {
-    vector<double> probabilities(N, 0.0);
-    double sum = 0.0;
-
-    // Calculate probability for each unvisited city
-    for (int i = 0; i < N; i++)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    AcoTspSolver solver(tsp, params);
+    TspLocalSearch search(tsp, LOCAL_SEARCH_NEIGHBOURS);
+    MemoCache<ImprovedTour> cache(memo ? memo : 1);
+    if (localSearch && memo)
+        attachLocalSearch(solver, search, cache);
+    else if (localSearch)
+        attachLocalSearch(solver, search);
+    chrono::duration<double> setup = chrono::steady_clock::now() - start;
+    cout << tsp.n << " cities, " << solver.candidateCount() << " candidates per city, "
+         << (localSearch ? "2-opt + Or-opt" : "no local search") << ", setup " << setup.count() << " s" << endl;
+
+    for (int iter = 0; iter < iterations; iter++)
     {
-        if (!visited[i])
-        {
-            probabilities[i] = pow(pheromones[current][i], ALPHA) * pow(1.0 / distances[current][i], BETA);
-            sum += probabilities[i];
-        }
+        solver.iterate();
+        cout << "Iteration " << iter + 1 << " Best length: " << solver.bestLength() << endl;
     }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
 
-    // Roulette wheel selection
-    double r = ((double)rand() / RAND_MAX) * sum;
-    double cumulative = 0.0;
-    for (int i = 0; i < N; i++)
+    const vector<int> &bestTour = solver.bestTour();
+    if (bestTour.size() <= 100)
     {
-        if (!visited[i])
-        {
-            cumulative += probabilities[i];
-            if (cumulative >= r)
-                return i;
-        }
+        cout << "\nBest tour found:\n";
+        for (int city : bestTour)
+            cout << city << " ";
+        cout << bestTour[0];
     }
-
-    // Fallback (should not happen)
-    for (int i = 0; i < N; i++)
+    cout << "\nTour length: " << solver.bestLength() << endl;
+    cout << "Time: " << elapsed.count() << " s" << endl;
+    if (localSearch && memo)
     {
-        if (!visited[i])
-            return i;
+        MemoStats stats = cache.stats();
+        cout << "Memo: " << stats.hits << " hits, " << stats.misses << " misses (" << 100.0 * stats.hitRate()
+             << "%), " << stats.evictions << " evictions" << endl;
     }
-    return -1;
 }
 
-// Run the ACO algorithm
-void runACO()
+//   Assignment4 [instance.tsp] [--ants N] [--iterations N] [--candidates K] [--seed S]
+//               [--selection roulette|iroulette|tournament] [--no-local-search] [--memo N]
+//               [--collinear N]
+//
+// Without an instance file it solves the built-in 5-city example;
+// --collinear generates N cities on a line instead. --memo
+// keeps the local search results of up to N constructed tours, so an ant
+// that builds a tour seen before skips the search.
+int main(int argc, char **argv)
 {
-    initializePheromones();
-    int bestLength = 1e9;
-    vector<int> bestTour;
-
-    for (int iter = 0; iter < NUM_ITERATIONS; iter++)
+    const char *file = 0;
+    AcoParams params;
+    params.ants = NUM_ANTS;
+    params.alpha = ALPHA;
+    params.beta = BETA;
+    params.rho = EVAPORATION;
+    params.seed = time(0);
+    int iterations = NUM_ITERATIONS;
+    bool localSearch = true;
+    size_t memo = 0;
+    size_t collinear = 0;
+    for (int a = 1; a < argc; a++)
     {
-        vector<vector<int>> allTours(NUM_ANTS);
-        vector<int> tourLengths(NUM_ANTS, 0);
-
-        // Each ant builds a tour
-        for (int k = 0; k < NUM_ANTS; k++)
-        {
-            vector<bool> visited(N, false);
-            vector<int> tour;
-            int current = rand() % N;
-            tour.push_back(current);
-            visited[current] = true;
-
-            for (int step = 1; step < N; step++)
-            {
-                int nextCity = chooseNextCity(current, visited);
-                tour.push_back(nextCity);
-                visited[nextCity] = true;
-                tourLengths[k] += distances[current][nextCity];
-                current = nextCity;
-            }
-            // Return to start city
-            tourLengths[k] += distances[current][tour[0]];
-            tour.push_back(tour[0]);
-
-            allTours[k] = tour;
-
-            if (tourLengths[k] < bestLength)
-            {
-                bestLength = tourLengths[k];
-                bestTour = tour;
-            }
-        }
-
-        // Evaporate pheromones
-        for (int i = 0; i < N; i++)
-            for (int j = 0; j < N; j++)
-                pheromones[i][j] *= (1 - EVAPORATION);
-
-        // Deposit new pheromones
-        for (int k = 0; k < NUM_ANTS; k++)
+        bool hasValue = a + 1 < argc;
+        if (strcmp(argv[a], "--ants") == 0 && hasValue)
+            params.ants = strtoul(argv[++a], 0, 10);
+        else if (strcmp(argv[a], "--iterations") == 0 && hasValue)
+            iterations = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--candidates") == 0 && hasValue)
+            params.candidates = strtoul(argv[++a], 0, 10);
+        else if (strcmp(argv[a], "--seed") == 0 && hasValue)
+            params.seed = strtoull(argv[++a], 0, 10);
+        else if (strcmp(argv[a], "--collinear") == 0 && hasValue)
+            collinear = strtoul(argv[++a], 0, 10);
+        else if (strcmp(argv[a], "--memo") == 0 && hasValue)
+            memo = strtoul(argv[++a], 0, 10);
+        else if (strcmp(argv[a], "--no-local-search") == 0)
+            localSearch = false;
+        else if (strcmp(argv[a], "--selection") == 0 && hasValue)
         {
-            double contribution = Q / tourLengths[k];
-            for (int i = 0; i < N; i++)
-            {
-                int from = allTours[k][i];
-                int to = allTours[k][i + 1];
-                pheromones[from][to] += contribution;
-                pheromones[to][from] += contribution;
-            }
+            const char *method = argv[++a];
+            if (strcmp(method, "iroulette") == 0)
+                params.selection = SELECT_I_ROULETTE;
+            else if (strcmp(method, "tournament") == 0)
+                params.selection = SELECT_TOURNAMENT;
+            else
+                params.selection = SELECT_ROULETTE;
         }
-
-        cout << "Iteration " << iter + 1 << " Best length: " << bestLength << endl;
+        else
+            file = argv[a];
+    }
+    if (params.ants == 0)
+    {
+        cout << "Need at least one ant." << endl;
+        return 1;
     }
 
-    cout << "\nBest tour found:\n";
-    for (int city : bestTour)
-        cout << city << " ";
-    cout << "\nTour length: " << bestLength << endl;
-}
+    TspInstance tsp;
+    string error;
+    bool loaded;
+    if (collinear)
+    {
+        collinearInstance(collinear, params.seed, tsp);
+        loaded = collinear >= 3;
+        error = "need at least 3 cities";
+    }
+    else if (file)
+        loaded = loadTsplibFile(file, tsp, error);
+    else
+    {
+        istringstream in(SMALL_TSP);
+        loaded = loadTsplib(in, tsp, error);
+    }
+    if (!loaded)
+    {
+        cout << "Instance error: " << error << endl;
+        return 1;
+    }
 
-int main()
-{
-    srand(time(0));
-    runACO();
+    cout << "Seed: " << params.seed << endl;
+    runACO(tsp, params, iterations, localSearch, memo);
     return 0;
 }
@@ -2,27 +2,32 @@
  * A simple C++ simulation of Ant Colony Optimization (ACO)
  *
  * This program finds the shortest path between a START_NODE and an END_NODE
- * in a hardcoded, weighted graph. It demonstrates the core principles of ACO:
+ * in a weighted graph: the small built-in example, or a large sparse graph
+ * (e.g. a road network) loaded from a DIMACS or edge-list file. It
+ * demonstrates the core principles of ACO:
  * 1. Probabilistic path construction based on pheromones and heuristics.
  * 2. Pheromone evaporation (trails fade over time).
  * 3. Pheromone deposition (ants reinforce paths they took, proportional
  * to the quality of the path).
+ *
+ * The ants themselves live in aco_graph.h, which stores the graph in CSR
+ * form so each step only looks at the current node's edges.
  */
 
 #include <iostream>
 #include <vector>
-#include <cmath>   // For pow()
-#include <cstdlib> // For rand() and RAND_MAX
-#include <ctime>   // For time()
-#include <iomanip> // For std::setprecision and std::fixed
-#include <cfloat>  // For DBL_MAX (a very large number)
+#include <cstdlib>     // For strtoull()
+#include <ctime>       // For time()
+#include <iomanip>     // For std::setprecision and std::fixed
+#include <chrono>      // For timing large graphs
+#include "aco_graph.h" // CSR graph, loaders and the ACO path solver
 
 // Use standard namespace for simplicity
 using namespace std;
 
 // --- Constants ---
 
-// Graph and Problem
+// Graph and Problem (built-in example)
 const int NUM_NODES = 5; // Number of nodes (cities) in the graph
 const int START_NODE = 0;
 const int END_NODE = 4;
@@ -55,215 +60,120 @@ void printPath(const vector<int> &path)
     }
 }
 
-int main()
+//   Assignment5 [seed] [graph-file start end]
+//
+// Without a graph file it solves the built-in 5-node example. Files whose
+// first line starts with "c" or "p" are read as DIMACS (1-based, directed
+// arcs), anything else as an undirected "u v [w]" edge list (0-based).
+// start and end are 0-based either way.
+int main(int argc, char **argv)
 {
-    // Seed the random number generator
-    srand(static_cast<unsigned>(time(0)));
+    // Seed the random number generator; pass a seed as the first argument
+    // to repeat a run
+    uint64_t seed = argc > 1 ? strtoull(argv[1], 0, 10) : time(0);
 
     // --- 1. Initialize Graph and Data Structures ---
 
-    // distances[i][j] = distance from node i to node j
-    // A simple, symmetric, fully-connected graph.
-    vector<vector<double>> distances = {
-        {0, 10, 20, 30, 15},
-        {10, 0, 12, 5, 25},
-        {20, 12, 0, 18, 8},
-        {30, 5, 18, 0, 22},
-        {15, 25, 8, 22, 0}};
-
-    // pheromones[i][j] = pheromone level on edge (i, j)
-    // Initialize all pheromone levels to a small constant (1.0)
-    vector<vector<double>> pheromones(NUM_NODES, vector<double>(NUM_NODES, 1.0));
-
-    // heuristics[i][j] = 1 / distance(i, j)
-    // Pre-calculate heuristics to avoid repeated division
-    vector<vector<double>> heuristics(NUM_NODES, vector<double>(NUM_NODES));
-    for (int i = 0; i < NUM_NODES; ++i)
+    CsrGraph graph;
+    int startNode = START_NODE, endNode = END_NODE;
+    if (argc > 4)
     {
-        for (int j = 0; j < NUM_NODES; ++j)
+        string error;
+        if (!loadGraphFile(argv[2], graph, error))
         {
-            if (i != j)
-            {
-                // Heuristic value: 1.0 / distance. More desirable for shorter paths.
-                heuristics[i][j] = 1.0 / distances[i][j];
-            }
-            else
+            cout << "Graph error: " << error << endl;
+            return 1;
+        }
+        startNode = atoi(argv[3]);
+        endNode = atoi(argv[4]);
+        if (startNode < 0 || endNode < 0 || (size_t)startNode >= graph.nodes || (size_t)endNode >= graph.nodes)
+        {
+            cout << "Start and end must be nodes 0 .. " << graph.nodes - 1 << endl;
+            return 1;
+        }
+    }
+    else
+    {
+        // distances[i][j] = distance from node i to node j
+        // A simple, symmetric, fully-connected graph; 0 means no edge.
+        double distances[NUM_NODES][NUM_NODES] = {
+            {0, 10, 20, 30, 15},
+            {10, 0, 12, 5, 25},
+            {20, 12, 0, 18, 8},
+            {30, 5, 18, 0, 22},
+            {15, 25, 8, 22, 0}};
+        vector<GraphArc> edges;
+        for (int i = 0; i < NUM_NODES; ++i)
+        {
+            for (int j = i + 1; j < NUM_NODES; ++j)
             {
-                heuristics[i][j] = 0; // No heuristic to move to the same node
+                if (distances[i][j] > 0)
+                {
+                    GraphArc edge = {i, j, distances[i][j]};
+                    edges.push_back(edge);
+                }
             }
         }
+        buildCsrGraph(NUM_NODES, edges, false, graph);
     }
 
-    // Variables to track the best path found
-    vector<int> overallBestPath;
-    double overallBestPathLength = DBL_MAX;
+    // Pheromone starts at 1.0 on every edge; the heuristic is 1 / distance
+    AcoPathParams params;
+    params.ants = NUM_ANTS;
+    params.alpha = ALPHA;
+    params.beta = BETA;
+    params.rho = EVAPORATION_RATE;
+    params.q = Q;
+    params.tau0 = 1.0;
+    params.seed = seed;
+    AcoPathSolver solver(graph, startNode, endNode, params);
 
     cout << fixed << setprecision(2);
     cout << "Starting ACO Simulation..." << endl;
-    cout << "Finding path from " << START_NODE << " to " << END_NODE << endl;
+    cout << "Graph: " << graph.nodes << " nodes, " << graph.arcCount() << " arcs" << endl;
+    cout << "Finding path from " << startNode << " to " << endNode << endl;
     cout << "Parameters: Ants=" << NUM_ANTS << ", Iterations=" << NUM_ITERATIONS
-         << ", Alpha=" << ALPHA << ", Beta=" << BETA << ", Evap=" << EVAPORATION_RATE << endl;
+         << ", Alpha=" << ALPHA << ", Beta=" << BETA << ", Evap=" << EVAPORATION_RATE << ", Seed=" << seed << endl;
     cout << "----------------------------------------------------" << endl;
 
     // --- 2. Main ACO Loop ---
+    // Each iteration the ants construct paths in parallel, then the
+    // pheromones evaporate and every successful ant deposits Q / length on
+    // the edges it used (both directions)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
     for (int iter = 0; iter < NUM_ITERATIONS; ++iter)
     {
-
-        // Store paths and lengths for all ants in this iteration
-        vector<vector<int>> antPaths(NUM_ANTS);
-        vector<double> antPathLengths(NUM_ANTS, DBL_MAX);
-
-        // --- 2a. Ants Construct Paths ---
-        for (int ant = 0; ant < NUM_ANTS; ++ant)
-        {
-            int currentNode = START_NODE;
-            vector<int> currentPath;
-            currentPath.push_back(currentNode);
-            double currentPathLength = 0.0;
-
-            // Keep track of visited nodes for this ant
-            vector<bool> visited(NUM_NODES, false);
-            visited[START_NODE] = true;
-
-            // Build a path until the ant reaches the END_NODE
-            while (currentNode != END_NODE)
-            {
-
-                // Calculate probabilities for moving to all unvisited neighbors
-                vector<double> moveProbs(NUM_NODES, 0.0);
-                double probSum = 0.0;
-
-                for (int nextNode = 0; nextNode < NUM_NODES; ++nextNode)
-                {
-                    if (!visited[nextNode] && distances[currentNode][nextNode] > 0)
-                    {
-                        // Calculate the "desirability" of this move
-                        double pheromone = pow(pheromones[currentNode][nextNode], ALPHA);
-                        double heuristic = pow(heuristics[currentNode][nextNode], BETA);
-                        moveProbs[nextNode] = pheromone * heuristic;
-                        probSum += moveProbs[nextNode];
-                    }
-                }
-
-                // Handle dead ends (e.g., stuck with no unvisited neighbors)
-                if (probSum == 0.0)
-                {
-                    // Ant fails, mark path length as max (or very high)
-                    currentPathLength = DBL_MAX;
-                    break;
-                }
-
-                // --- Roulette Wheel Selection ---
-                // Choose the next node based on the calculated probabilities
-                double randVal = (double)rand() / RAND_MAX * probSum;
-                int chosenNode = -1;
-                for (int nextNode = 0; nextNode < NUM_NODES; ++nextNode)
-                {
-                    if (moveProbs[nextNode] > 0)
-                    {
-                        randVal -= moveProbs[nextNode];
-                        if (randVal <= 0.0)
-                        {
-                            chosenNode = nextNode;
-                            break;
-                        }
-                    }
-                }
-
-                // This should not happen if probSum > 0, but as a fallback:
-                if (chosenNode == -1)
-                {
-                    for (int nextNode = 0; nextNode < NUM_NODES; ++nextNode)
-                    {
-                        if (moveProbs[nextNode] > 0)
-                        {
-                            chosenNode = nextNode;
-                            break;
-                        }
-                    }
-                }
-
-                // Move the ant to the chosen node
-                currentNode = chosenNode;
-                visited[currentNode] = true;
-                currentPath.push_back(currentNode);
-                // Note: We'd add path length here, but we'll re-calculate it
-                // from the final path vector for simplicity.
-            }
-
-            // --- Store this ant's path and calculate its length ---
-            if (currentNode == END_NODE)
-            { // Ant successfully found the end
-                currentPathLength = 0.0;
-                for (size_t i = 0; i < currentPath.size() - 1; ++i)
-                {
-                    currentPathLength += distances[currentPath[i]][currentPath[i + 1]];
-                }
-                antPaths[ant] = currentPath;
-                antPathLengths[ant] = currentPathLength;
-
-                // Check if this ant found a new overall best path
-                if (currentPathLength < overallBestPathLength)
-                {
-                    overallBestPathLength = currentPathLength;
-                    overallBestPath = currentPath;
-                }
-            }
-            // If ant failed (currentPathLength == DBL_MAX), it's already set
-        }
-
-        // --- 2b. Update Pheromones ---
-
-        // 1. Evaporation: Decrease pheromones on all edges
-        for (int i = 0; i < NUM_NODES; ++i)
-        {
-            for (int j = 0; j < NUM_NODES; ++j)
-            {
-                pheromones[i][j] *= (1.0 - EVAPORATION_RATE);
-            }
-        }
-
-        // 2. Deposition: Add new pheromones from ants' paths
-        for (int ant = 0; ant < NUM_ANTS; ++ant)
-        {
-            if (antPathLengths[ant] < DBL_MAX)
-            { // If ant was successful
-                // Amount of pheromone to deposit is inversely related to path length
-                double depositAmount = Q / antPathLengths[ant];
-
-                // Deposit pheromones on each edge of the ant's path
-                for (size_t i = 0; i < antPaths[ant].size() - 1; ++i)
-                {
-                    int u = antPaths[ant][i];
-                    int v = antPaths[ant][i + 1];
-                    // Add to both directions for a symmetric graph
-                    pheromones[u][v] += depositAmount;
-                    pheromones[v][u] += depositAmount;
-                }
-            }
-        }
+        solver.iterate();
 
         // --- Optional: Print progress ---
         if ((iter + 1) % 10 == 0)
         {
-            cout << "Iteration " << (iter + 1) << ": Best Path Length = " << overallBestPathLength << endl;
+            cout << "Iteration " << (iter + 1) << ": Best Path Length = ";
+            if (solver.bestPath().empty())
+                cout << "none yet" << endl;
+            else
+                cout << solver.bestLength() << endl;
         }
     }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
 
     // --- 3. Final Result ---
     cout << "----------------------------------------------------" << endl;
-    cout << "Simulation finished." << endl;
-    if (overallBestPathLength == DBL_MAX)
+    cout << "Simulation finished in " << elapsed.count() << " s." << endl;
+    if (solver.bestPath().empty())
     {
-        cout << "No path found from " << START_NODE << " to " << END_NODE << "." << endl;
+        cout << "No path found from " << startNode << " to " << endNode << "." << endl;
     }
     else
     {
         cout << "Overall Best Path Found:" << endl;
-        printPath(overallBestPath);
+        if (solver.bestPath().size() <= 100)
+            printPath(solver.bestPath());
+        else
+            cout << solver.bestPath().size() << " nodes";
         cout << endl;
-        cout << "Path Length: " << overallBestPathLength << endl;
+        cout << "Path Length: " << solver.bestLength() << endl;
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,508 @@
+#ifndef ACO_GRAPH_H
+#define ACO_GRAPH_H
+
+// Ant Colony Optimization for start -> end paths on large sparse graphs
+// (road networks: millions of nodes, average degree around 4).
+//
+//   - the graph is CSR: arcs of node u are offset[u] .. offset[u + 1] in
+//     target/weight, sorted by target, and reverse[e] is the opposite arc
+//     (or -1), so pheromone and heuristic live in flat per-arc arrays;
+//   - a step looks only at the current node's arcs, O(degree), drawn by the
+//     ant's WeightedSampler from the precomputed choice info. With alpha = 0
+//     the weights are eta^beta alone and never change, so each node gets an
+//     alias table once: a step draws from it in O(1) and redraws while the
+//     drawn neighbour is visited, falling back to the roulette after
+//     ACO_ALIAS_TRIES misses;
+//   - each ant's visited set is a generation-stamped array: starting a new
+//     path bumps the generation instead of clearing (or reallocating) n
+//     flags;
+//   - ants run in parallel with their own generator streams and deposit
+//     buffers; pheromone is a PheromoneStore as in aco_tsp.h, so the
+//     update costs O(arcs touched).
+// An ant that reaches a node with no unvisited neighbour steps back and
+// tries another way (the dead end stays marked), so on a connected graph
+// every ant arrives unless it runs out of steps; one that does, or that
+// backs up to the start, fails and deposits nothing.
+//
+// Graphs load from DIMACS shortest-path files ("p sp n m" and "a u v w"
+// lines, 1-based) or from plain edge lists ("u v [w]" lines, 0-based,
+// undirected unless asked otherwise).
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pheromone_store.h"
+#include "rng.h"
+#include "sampler.h"
+#include "thread_pool.h"
+
+// Alias draws per step before an ant falls back to the roulette
+static const int ACO_ALIAS_TRIES = 4;
+
+struct GraphArc
+{
+    int from, to;
+    double weight;
+};
+
+struct CsrGraph
+{
+    size_t nodes;
+    std::vector<size_t> offset; // nodes + 1
+    std::vector<int> target;
+    std::vector<double> weight;
+    std::vector<int> reverse; // arc to -> from, or -1
+
+    CsrGraph() : nodes(0) {}
+
+    size_t arcCount() const { return target.size(); }
+    size_t degree(size_t u) const { return offset[u + 1] - offset[u]; }
+
+    // Arc u -> v, or -1
+    long findArc(size_t u, int v) const
+    {
+        const int *first = target.data() + offset[u], *last = target.data() + offset[u + 1];
+        const int *it = std::lower_bound(first, last, v);
+        return it != last && *it == v ? (long)(it - target.data()) : -1;
+    }
+};
+
+// CSR form of `arcs` over `nodes` nodes; undirected graphs get both
+// directions of every arc. Parallel arcs keep the lightest.
+inline void buildCsrGraph(size_t nodes, const std::vector<GraphArc> &arcs, bool directed, CsrGraph &g)
+{
+    g.nodes = nodes;
+    g.offset.assign(nodes + 1, 0);
+    for (size_t i = 0; i < arcs.size(); i++)
+    {
+        g.offset[arcs[i].from + 1]++;
+        if (!directed)
+            g.offset[arcs[i].to + 1]++;
+    }
+    for (size_t u = 0; u < nodes; u++)
+        g.offset[u + 1] += g.offset[u];
+
+    // Counting sort by source, then each adjacency by target
+    std::vector<size_t> fill(g.offset.begin(), g.offset.end() - 1);
+    std::vector<std::pair<int, double> > adj(g.offset[nodes]);
+    for (size_t i = 0; i < arcs.size(); i++)
+    {
+        adj[fill[arcs[i].from]++] = std::make_pair(arcs[i].to, arcs[i].weight);
+        if (!directed)
+            adj[fill[arcs[i].to]++] = std::make_pair(arcs[i].from, arcs[i].weight);
+    }
+    g.target.clear();
+    g.weight.clear();
+    size_t kept = 0;
+    for (size_t u = 0; u < nodes; u++)
+    {
+        const size_t begin = g.offset[u], end = g.offset[u + 1];
+        std::sort(adj.begin() + begin, adj.begin() + end);
+        g.offset[u] = kept;
+        for (size_t e = begin; e < end; e++)
+            if (adj[e].first != (int)u && (e == begin || adj[e].first != adj[e - 1].first))
+            {
+                g.target.push_back(adj[e].first);
+                g.weight.push_back(adj[e].second);
+                kept++;
+            }
+    }
+    g.offset[nodes] = kept;
+
+    g.reverse.resize(kept);
+    for (size_t u = 0; u < nodes; u++)
+        for (size_t e = g.offset[u]; e < g.offset[u + 1]; e++)
+            g.reverse[e] = (int)g.findArc(g.target[e], (int)u);
+}
+
+// Parses a DIMACS shortest-path graph; on failure returns false with a message
+inline bool loadDimacsGraph(std::istream &in, CsrGraph &g, std::string &error)
+{
+    std::string line;
+    size_t nodes = 0, declared = 0;
+    bool haveProblem = false;
+    std::vector<GraphArc> arcs;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string tag;
+        if (!(fields >> tag) || tag == "c")
+            continue;
+        if (tag == "p")
+        {
+            std::string kind;
+            if (!(fields >> kind >> nodes >> declared) || nodes == 0)
+            {
+                error = "bad problem line: " + line;
+                return false;
+            }
+            haveProblem = true;
+            arcs.reserve(declared);
+        }
+        else if (tag == "a")
+        {
+            long u, v;
+            double w;
+            if (!haveProblem)
+            {
+                error = "arc before the problem line";
+                return false;
+            }
+            if (!(fields >> u >> v >> w) || u < 1 || v < 1 || (size_t)u > nodes || (size_t)v > nodes)
+            {
+                error = "bad arc line: " + line;
+                return false;
+            }
+            GraphArc arc = {(int)(u - 1), (int)(v - 1), w};
+            arcs.push_back(arc);
+        }
+    }
+    if (!haveProblem)
+    {
+        error = "missing problem line";
+        return false;
+    }
+    buildCsrGraph(nodes, arcs, true, g);
+    return true;
+}
+
+// Parses "u v [w]" lines (0-based ids, weight 1 when missing; '#' and '%'
+// start comments); on failure returns false with a message
+inline bool loadEdgeList(std::istream &in, CsrGraph &g, std::string &error, bool directed = false)
+{
+    std::string line;
+    std::vector<GraphArc> arcs;
+    size_t nodes = 0;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        long u, v;
+        double w = 1.0;
+        if (line.empty() || line[0] == '#' || line[0] == '%')
+            continue;
+        if (!(fields >> u >> v))
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+            error = "bad edge line: " + line;
+            return false;
+        }
+        fields >> w;
+        if (u < 0 || v < 0)
+        {
+            error = "negative node id: " + line;
+            return false;
+        }
+        GraphArc arc = {(int)u, (int)v, w};
+        arcs.push_back(arc);
+        nodes = std::max(nodes, (size_t)std::max(u, v) + 1);
+    }
+    if (nodes == 0)
+    {
+        error = "no edges";
+        return false;
+    }
+    buildCsrGraph(nodes, arcs, directed, g);
+    return true;
+}
+
+// DIMACS when the first line starts with "c" or "p", an edge list otherwise
+inline bool loadGraphFile(const std::string &path, CsrGraph &g, std::string &error, bool directed = false)
+{
+    std::ifstream in(path.c_str());
+    if (!in)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string tag;
+    in >> tag;
+    in.seekg(0);
+    if (tag == "c" || tag == "p")
+        return loadDimacsGraph(in, g, error);
+    return loadEdgeList(in, g, error, directed);
+}
+
+// Visited flags reset in O(1): a node is visited when its stamp equals the
+// current generation
+struct VisitedStamp
+{
+    std::vector<unsigned> stamp;
+    unsigned generation;
+
+    VisitedStamp() : generation(0) {}
+
+    void reset(size_t n)
+    {
+        if (stamp.size() != n || ++generation == 0)
+        {
+            stamp.assign(n, 0);
+            generation = 1;
+        }
+    }
+
+    bool contains(size_t u) const { return stamp[u] == generation; }
+    void insert(size_t u) { stamp[u] = generation; }
+};
+
+struct AcoPathParams
+{
+    size_t ants;
+    double alpha;    // pheromone influence
+    double beta;     // distance influence
+    double rho;      // evaporation rate
+    double q;        // deposit: q / path length per arc
+    double tau0;     // initial pheromone
+    size_t maxSteps; // moves per path, steps back included; 0 means 2 * nodes
+    uint64_t seed;
+
+    AcoPathParams() : ants(10), alpha(1.0), beta(2.0), rho(0.5), q(100.0), tau0(1.0), maxSteps(0), seed(1) {}
+};
+
+class AcoPathSolver
+{
+public:
+    AcoPathSolver(const CsrGraph &graph, int start, int end, const AcoPathParams &params = AcoPathParams(),
+                  ThreadPool &pool = defaultThreadPool())
+        : g(graph), start(start), end(end), params(params), pool(pool), iter(0), best(HUGE_VAL)
+    {
+        const size_t m = g.arcCount();
+        etaBeta.resize(m);
+        for (size_t e = 0; e < m; e++)
+            etaBeta[e] = std::pow(1.0 / (g.weight[e] > 0.0 ? g.weight[e] : 1e-9), params.beta);
+        pheromone.init(m, params.tau0);
+        choice.resize(m);
+        computeChoiceInfo();
+        if (params.alpha == 0.0)
+            buildAliasTables();
+
+        ants.resize(params.ants);
+        deposits.resize(params.ants);
+        size_t maxDegree = 0;
+        for (size_t u = 0; u < g.nodes; u++)
+            maxDegree = std::max(maxDegree, g.degree(u));
+        for (size_t a = 0; a < ants.size(); a++)
+        {
+            ants[a].rng.reseed(params.seed, a);
+            ants[a].sampler.reserve(maxDegree);
+            pheromone.prepare(deposits[a]);
+        }
+    }
+
+    // One iteration: every ant walks from start towards end, then pheromone
+    // is updated
+    void iterate()
+    {
+        pool.parallelFor(0, ants.size(), 1, [&](size_t lo, size_t hi)
+                         {
+            for (size_t a = lo; a < hi; a++)
+            {
+                constructPath(ants[a]);
+                collectDeposits(ants[a], deposits[a]);
+            } });
+        for (size_t a = 0; a < ants.size(); a++)
+        {
+            if (ants[a].length < best)
+            {
+                best = ants[a].length;
+                bestPath_ = ants[a].path;
+            }
+        }
+        updatePheromone();
+        iter++;
+    }
+
+    double run(size_t iterations)
+    {
+        for (size_t t = 0; t < iterations; t++)
+            iterate();
+        return best;
+    }
+
+    size_t iteration() const { return iter; }
+    size_t antCount() const { return ants.size(); }
+    // Nodes of the ant's last path (start .. end), empty when it failed
+    const std::vector<int> &path(size_t ant) const { return ants[ant].path; }
+    double antLength(size_t ant) const { return ants[ant].length; }
+    // Empty, with length HUGE_VAL, until some ant reaches the end
+    const std::vector<int> &bestPath() const { return bestPath_; }
+    double bestLength() const { return best; }
+
+private:
+    struct Ant
+    {
+        Xoshiro256 rng;
+        VisitedStamp visited;
+        WeightedSampler sampler;
+        std::vector<int> path;
+        std::vector<int> arcs;
+        double length;
+    };
+
+    const CsrGraph &g;
+    int start, end;
+    AcoPathParams params;
+    ThreadPool &pool;
+    size_t iter;
+    std::vector<double> etaBeta;   // per arc (1 / w)^beta
+    PheromoneStore pheromone;      // per arc
+    std::vector<double> choice;    // per arc stored tau^alpha * eta^beta
+    std::vector<double> aliasProb; // per arc, each node's alias table of
+    std::vector<int> aliasIndex;   //   eta^beta when alpha = 0, else empty
+    std::vector<Ant> ants;
+    std::vector<DepositBuffer> deposits; // one per ant
+    std::vector<int> bestPath_;
+    double best;
+
+    // Choice info from the stored pheromone (the store's scale cancels in
+    // the roulette)
+    void refreshChoice(size_t e)
+    {
+        const double t = pheromone.storedValue(e);
+        choice[e] = (params.alpha == 1.0 ? t : std::pow(t, params.alpha)) * etaBeta[e];
+    }
+
+    void computeChoiceInfo()
+    {
+        pool.parallelFor(0, choice.size(), 1 << 14, [&](size_t lo, size_t hi)
+                         {
+            for (size_t e = lo; e < hi; e++)
+                refreshChoice(e); });
+    }
+
+    // A node whose weights are all zero keeps probabilities of 0 and
+    // aliases of -1, so every draw from it misses
+    void buildAliasTables()
+    {
+        aliasProb.assign(g.arcCount(), 0.0);
+        aliasIndex.assign(g.arcCount(), -1);
+        std::vector<int> small, large;
+        for (size_t u = 0; u < g.nodes; u++)
+        {
+            const size_t first = g.offset[u];
+            buildAlias(etaBeta.data() + first, g.degree(u), aliasProb.data() + first, aliasIndex.data() + first, small,
+                       large);
+        }
+    }
+
+    void constructPath(Ant &ant) const
+    {
+        const size_t maxSteps = params.maxSteps ? params.maxSteps : 2 * g.nodes;
+        ant.visited.reset(g.nodes);
+        ant.path.assign(1, start);
+        ant.arcs.clear();
+        ant.visited.insert(start);
+        double length = 0.0;
+        int u = start;
+        for (size_t step = 0; u != end; step++)
+        {
+            const size_t first = g.offset[u], degree = g.degree(u);
+            int s = -1;
+            if (!aliasProb.empty() && degree)
+                for (int t = 0; t < ACO_ALIAS_TRIES && s < 0; t++)
+                {
+                    const int i = aliasDraw(aliasProb.data() + first, aliasIndex.data() + first, degree,
+                                            ant.rng.nextDouble());
+                    if (i >= 0 && !ant.visited.contains(g.target[first + i]))
+                        s = i;
+                }
+            if (s < 0)
+            {
+                double *weights = ant.sampler.weights(degree);
+                for (size_t i = 0; i < degree; i++)
+                    weights[i] = ant.visited.contains(g.target[first + i]) ? 0.0 : choice[first + i];
+                s = ant.sampler.roulette(ant.rng);
+            }
+            if (step >= maxSteps || (s < 0 && ant.arcs.empty()))
+            {
+                ant.path.clear();
+                ant.arcs.clear();
+                ant.length = HUGE_VAL;
+                return;
+            }
+            if (s < 0)
+            {
+                // Dead end: step back, leaving u marked
+                length -= g.weight[ant.arcs.back()];
+                ant.arcs.pop_back();
+                ant.path.pop_back();
+                u = ant.path.back();
+                continue;
+            }
+            const size_t e = first + s;
+            length += g.weight[e];
+            u = g.target[e];
+            ant.visited.insert(u);
+            ant.path.push_back(u);
+            ant.arcs.push_back((int)e);
+        }
+        ant.length = length;
+    }
+
+    // q / length on every arc of the ant's path and on its reverse
+    void collectDeposits(const Ant &ant, DepositBuffer &buffer) const
+    {
+        buffer.clear();
+        if (ant.arcs.empty())
+            return;
+        const double amount = params.q / ant.length;
+        for (size_t i = 0; i < ant.arcs.size(); i++)
+        {
+            const int e = ant.arcs[i];
+            buffer.add(e, amount);
+            if (g.reverse[e] >= 0)
+                buffer.add(g.reverse[e], amount);
+        }
+    }
+
+    // Lazy evaporation, then the merged deposits. With alpha = 0 the choice
+    // info does not depend on the pheromone and is left as it is.
+    void updatePheromone()
+    {
+        if (!aliasProb.empty())
+        {
+            pheromone.evaporate(params.rho);
+            pheromone.merge(deposits, pool);
+            return;
+        }
+        if (pheromone.evaporate(params.rho))
+        {
+            pheromone.merge(deposits, pool);
+            computeChoiceInfo();
+        }
+        else
+            pheromone.merge(deposits, [this](size_t e)
+                            { refreshChoice(e); }, pool);
+    }
+};
+
+// runSearch() adapter (metaheuristic.h): an evaluation is one ant's walk,
+// and the fitness the best path length (HUGE_VAL until an ant arrives). The
+// solver carries on from its current state; start() spends nothing.
+class AcoPathSearch
+{
+public:
+    explicit AcoPathSearch(AcoPathSolver &solver) : solver(solver) {}
+
+    size_t start() { return 0; }
+
+    size_t step(double)
+    {
+        solver.iterate();
+        return solver.antCount();
+    }
+
+    double bestFitness() const { return solver.bestLength(); }
+
+private:
+    AcoPathSolver &solver;
+};
+
+#endif // ACO_GRAPH_H
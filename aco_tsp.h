@@ -0,0 +1,704 @@
+#ifndef ACO_TSP_H
+#define ACO_TSP_H
+
+// Ant Colony Optimization (Ant System) for symmetric TSP instances in
+// TSPLIB format.
+//
+// Sized for instances of 10k+ cities:
+//   - each city keeps a candidate list of its k nearest neighbours, and
+//     pheromone lives on candidate slots only ([city][k], not N x N);
+//   - once per iteration the choice info tau^alpha * eta^beta is computed
+//     for every candidate slot, so a construction step is a selection over
+//     at most k precomputed weights with no pow() calls, drawn by the ant's
+//     WeightedSampler (exact roulette by default, or the independent
+//     roulette / tournament approximations for long candidate lists);
+//   - when every candidate of the current city is already visited the ant
+//     moves to the nearest unvisited city (the usual fallback);
+//   - ants build their tours in parallel on the thread pool, each with its
+//     own generator stream (Xoshiro256(seed, ant)) and scratch, so a run is
+//     reproducible from its seed whatever the thread count;
+//   - pheromone is a PheromoneStore: evaporation is lazy and each ant fills
+//     its own deposit buffer, merged in parallel, so the update costs
+//     O(edges touched). Choice info is refreshed for touched slots only;
+//   - an optional tour stage (local search, see tsp_local_search.h) improves
+//     each ant's tour on the same worker, before the pheromone update.
+//
+// Loading supports NODE_COORD_SECTION with EUC_2D, CEIL_2D, ATT and GEO
+// distances, and EXPLICIT matrices (FULL_MATRIX, UPPER_ROW, LOWER_ROW,
+// UPPER_DIAG_ROW, LOWER_DIAG_ROW). Nearest neighbours of coordinate
+// instances come from a uniform grid, O(n k) rather than O(n^2).
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pheromone_store.h"
+#include "rng.h"
+#include "sampler.h"
+#include "thread_pool.h"
+
+enum TspWeightType
+{
+    TSP_EUC_2D,
+    TSP_CEIL_2D,
+    TSP_ATT,
+    TSP_GEO,
+    TSP_EXPLICIT
+};
+
+struct TspInstance
+{
+    std::string name;
+    size_t n;
+    TspWeightType type;
+    std::vector<double> x, y;      // coordinates (all types but EXPLICIT)
+    std::vector<double> matrix;    // [n][n], EXPLICIT only
+
+    TspInstance() : n(0), type(TSP_EUC_2D) {}
+
+    // TSPLIB distance between cities i and j (integral, as TSPLIB defines it)
+    double distance(size_t i, size_t j) const
+    {
+        switch (type)
+        {
+        case TSP_EXPLICIT:
+            return matrix[i * n + j];
+        case TSP_CEIL_2D:
+            return std::ceil(euclidean(i, j));
+        case TSP_ATT:
+        {
+            const double dx = x[i] - x[j], dy = y[i] - y[j];
+            const double r = std::sqrt((dx * dx + dy * dy) / 10.0);
+            const double t = std::floor(r + 0.5);
+            return t < r ? t + 1.0 : t;
+        }
+        case TSP_GEO:
+            return geo(i, j);
+        default:
+            return std::floor(euclidean(i, j) + 0.5);
+        }
+    }
+
+    // Unrounded Euclidean distance, used to rank neighbours
+    double euclidean(size_t i, size_t j) const
+    {
+        const double dx = x[i] - x[j], dy = y[i] - y[j];
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    // Any key that orders j by distance from i: the squared Euclidean
+    // distance for planar instances (no sqrt or rounding), else distance()
+    double rankKey(size_t i, size_t j) const
+    {
+        if (type == TSP_GEO || type == TSP_EXPLICIT)
+            return distance(i, j);
+        const double dx = x[i] - x[j], dy = y[i] - y[j];
+        return dx * dx + dy * dy;
+    }
+
+private:
+    static double geoRadians(double v)
+    {
+        const double deg = (double)(int)v;
+        return 3.141592 * (deg + 5.0 * (v - deg) / 3.0) / 180.0;
+    }
+
+    double geo(size_t i, size_t j) const
+    {
+        if (i == j)
+            return 0.0;
+        const double latI = geoRadians(x[i]), lonI = geoRadians(y[i]);
+        const double latJ = geoRadians(x[j]), lonJ = geoRadians(y[j]);
+        const double q1 = std::cos(lonI - lonJ), q2 = std::cos(latI - latJ), q3 = std::cos(latI + latJ);
+        return (double)(int)(6378.388 * std::acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
+    }
+};
+
+// Length of the closed tour (a permutation of the cities)
+inline double tourLength(const TspInstance &tsp, const std::vector<int> &tour)
+{
+    double length = 0.0;
+    for (size_t i = 0; i + 1 < tour.size(); i++)
+        length += tsp.distance(tour[i], tour[i + 1]);
+    if (!tour.empty())
+        length += tsp.distance(tour.back(), tour[0]);
+    return length;
+}
+
+// Parses a TSPLIB problem; on failure returns false with a message
+inline bool loadTsplib(std::istream &in, TspInstance &tsp, std::string &error)
+{
+    tsp = TspInstance();
+    std::string line, weightFormat = "FULL_MATRIX";
+    bool haveType = false;
+    while (std::getline(in, line))
+    {
+        std::string key = line, value;
+        size_t colon = line.find(':');
+        if (colon != std::string::npos)
+        {
+            key = line.substr(0, colon);
+            value = line.substr(colon + 1);
+        }
+        std::istringstream keyStream(key), valueStream(value);
+        keyStream >> key;
+        valueStream >> value;
+        if (key.empty())
+            continue;
+
+        if (key == "NAME")
+            tsp.name = value;
+        else if (key == "TYPE")
+        {
+            if (value != "TSP")
+            {
+                error = "only symmetric TSP instances are supported (TYPE " + value + ")";
+                return false;
+            }
+        }
+        else if (key == "DIMENSION")
+            tsp.n = (size_t)std::strtoul(value.c_str(), 0, 10);
+        else if (key == "EDGE_WEIGHT_TYPE")
+        {
+            haveType = true;
+            if (value == "EUC_2D")
+                tsp.type = TSP_EUC_2D;
+            else if (value == "CEIL_2D")
+                tsp.type = TSP_CEIL_2D;
+            else if (value == "ATT")
+                tsp.type = TSP_ATT;
+            else if (value == "GEO")
+                tsp.type = TSP_GEO;
+            else if (value == "EXPLICIT")
+                tsp.type = TSP_EXPLICIT;
+            else
+            {
+                error = "unsupported EDGE_WEIGHT_TYPE " + value;
+                return false;
+            }
+        }
+        else if (key == "EDGE_WEIGHT_FORMAT")
+            weightFormat = value;
+        else if (key == "NODE_COORD_SECTION")
+        {
+            if (tsp.n == 0)
+            {
+                error = "NODE_COORD_SECTION before DIMENSION";
+                return false;
+            }
+            tsp.x.assign(tsp.n, 0.0);
+            tsp.y.assign(tsp.n, 0.0);
+            for (size_t c = 0; c < tsp.n; c++)
+            {
+                long id;
+                double cx, cy;
+                if (!(in >> id >> cx >> cy) || id < 1 || (size_t)id > tsp.n)
+                {
+                    error = "bad or missing node coordinates";
+                    return false;
+                }
+                tsp.x[id - 1] = cx;
+                tsp.y[id - 1] = cy;
+            }
+        }
+        else if (key == "EDGE_WEIGHT_SECTION")
+        {
+            if (tsp.n == 0)
+            {
+                error = "EDGE_WEIGHT_SECTION before DIMENSION";
+                return false;
+            }
+            const size_t n = tsp.n;
+            tsp.matrix.assign(n * n, 0.0);
+            bool upper = weightFormat == "UPPER_ROW" || weightFormat == "UPPER_DIAG_ROW";
+            bool lower = weightFormat == "LOWER_ROW" || weightFormat == "LOWER_DIAG_ROW";
+            bool diag = weightFormat == "UPPER_DIAG_ROW" || weightFormat == "LOWER_DIAG_ROW";
+            if (!upper && !lower && weightFormat != "FULL_MATRIX")
+            {
+                error = "unsupported EDGE_WEIGHT_FORMAT " + weightFormat;
+                return false;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                size_t from = 0, to = n;
+                if (upper)
+                    from = diag ? i : i + 1;
+                if (lower)
+                    to = diag ? i + 1 : i;
+                for (size_t j = from; j < to; j++)
+                {
+                    double w;
+                    if (!(in >> w))
+                    {
+                        error = "EDGE_WEIGHT_SECTION is too short";
+                        return false;
+                    }
+                    tsp.matrix[i * n + j] = w;
+                    if (upper || lower)
+                        tsp.matrix[j * n + i] = w;
+                }
+            }
+        }
+        else if (key == "EOF")
+            break;
+        else if (key == "DISPLAY_DATA_SECTION" || key == "TOUR_SECTION")
+        {
+            // Not needed: skip to the next section keyword
+            while (in >> line && line != "EOF" && line != "-1")
+                ;
+        }
+    }
+
+    if (tsp.n < 2)
+        error = "instance needs DIMENSION >= 2";
+    else if (!haveType)
+        error = "missing EDGE_WEIGHT_TYPE";
+    else if (tsp.type == TSP_EXPLICIT && tsp.matrix.empty())
+        error = "missing EDGE_WEIGHT_SECTION";
+    else if (tsp.type != TSP_EXPLICIT && tsp.x.empty())
+        error = "missing NODE_COORD_SECTION";
+    else
+        return true;
+    return false;
+}
+
+inline bool loadTsplibFile(const std::string &path, TspInstance &tsp, std::string &error)
+{
+    std::ifstream in(path.c_str());
+    if (!in)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    return loadTsplib(in, tsp, error);
+}
+
+// cand[i * k + s] = s-th nearest neighbour of city i (k < n)
+inline void buildCandidateLists(const TspInstance &tsp, size_t k, std::vector<int> &cand,
+                                ThreadPool &pool = defaultThreadPool())
+{
+    const size_t n = tsp.n;
+    cand.assign(n * k, 0);
+    // Max-heap of the k best (distance, city) so far
+    typedef std::pair<double, int> Entry;
+
+    if (tsp.type == TSP_EXPLICIT || tsp.type == TSP_GEO)
+    {
+        pool.parallelFor(0, n, 64, [&](size_t lo, size_t hi)
+                         {
+            std::vector<Entry> heap;
+            for (size_t i = lo; i < hi; i++)
+            {
+                heap.clear();
+                for (size_t j = 0; j < n; j++)
+                {
+                    if (j == i)
+                        continue;
+                    Entry e(tsp.distance(i, j), (int)j);
+                    if (heap.size() < k)
+                    {
+                        heap.push_back(e);
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                    else if (e < heap.front())
+                    {
+                        std::pop_heap(heap.begin(), heap.end());
+                        heap.back() = e;
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                }
+                std::sort_heap(heap.begin(), heap.end());
+                for (size_t s = 0; s < k; s++)
+                    cand[i * k + s] = heap[s].second;
+            } });
+        return;
+    }
+
+    // Planar instances: bucket the cities into a grid of about two per cell
+    // and search rings of cells outward from each city
+    double minX = tsp.x[0], maxX = minX, minY = tsp.y[0], maxY = minY;
+    for (size_t i = 1; i < n; i++)
+    {
+        minX = std::min(minX, tsp.x[i]);
+        maxX = std::max(maxX, tsp.x[i]);
+        minY = std::min(minY, tsp.y[i]);
+        maxY = std::max(maxY, tsp.y[i]);
+    }
+    const double spanX = maxX - minX, spanY = maxY - minY;
+    const double area = std::max(spanX, 1e-9) * std::max(spanY, 1e-9);
+    double cell = std::sqrt(2.0 * area / (double)n);
+    // A (nearly) collinear layout has almost no area: keep at most about n / 2
+    // cells along the longer side, so the grid stays O(n) cells
+    cell = std::max(cell, 2.0 * std::max(spanX, spanY) / (double)n);
+    cell = cell > 0.0 ? cell : 1.0;
+    const int cols = (int)(spanX / cell) + 1, rows = (int)(spanY / cell) + 1;
+    std::vector<int> cellStart(cols * rows + 1, 0), cellCity(n), cityCell(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        int cx = (int)((tsp.x[i] - minX) / cell), cy = (int)((tsp.y[i] - minY) / cell);
+        cityCell[i] = std::min(cy, rows - 1) * cols + std::min(cx, cols - 1);
+        cellStart[cityCell[i] + 1]++;
+    }
+    for (int c = 0; c < cols * rows; c++)
+        cellStart[c + 1] += cellStart[c];
+    {
+        std::vector<int> fillPos(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < n; i++)
+            cellCity[fillPos[cityCell[i]]++] = (int)i;
+    }
+
+    pool.parallelFor(0, n, 256, [&](size_t lo, size_t hi)
+                     {
+        std::vector<Entry> heap;
+        for (size_t i = lo; i < hi; i++)
+        {
+            heap.clear();
+            const int cx = cityCell[i] % cols, cy = cityCell[i] / cols;
+            const int maxRing = std::max(cols, rows);
+            for (int r = 0; r <= maxRing; r++)
+            {
+                for (int gy = cy - r; gy <= cy + r; gy++)
+                {
+                    if (gy < 0 || gy >= rows)
+                        continue;
+                    // Only the border cells of ring r
+                    const int step = (gy == cy - r || gy == cy + r) ? 1 : 2 * r;
+                    for (int gx = cx - r; gx <= cx + r; gx += step)
+                    {
+                        if (gx < 0 || gx >= cols)
+                            continue;
+                        const int c = gy * cols + gx;
+                        for (int p = cellStart[c]; p < cellStart[c + 1]; p++)
+                        {
+                            const size_t j = cellCity[p];
+                            if (j == i)
+                                continue;
+                            Entry e(tsp.euclidean(i, j), (int)j);
+                            if (heap.size() < k)
+                            {
+                                heap.push_back(e);
+                                std::push_heap(heap.begin(), heap.end());
+                            }
+                            else if (e < heap.front())
+                            {
+                                std::pop_heap(heap.begin(), heap.end());
+                                heap.back() = e;
+                                std::push_heap(heap.begin(), heap.end());
+                            }
+                        }
+                    }
+                }
+                // Cells beyond ring r are at least r * cell away
+                if (heap.size() == k && heap.front().first <= (double)r * cell)
+                    break;
+            }
+            std::sort_heap(heap.begin(), heap.end());
+            for (size_t s = 0; s < k; s++)
+                cand[i * k + s] = heap[s].second;
+        } });
+}
+
+// Cities not yet on a tour: O(1) membership and removal, plus a dense list
+// so that the nearest-unvisited fallback scans only the cities left
+struct UnvisitedSet
+{
+    std::vector<int> cities;   // unvisited cities, in no particular order
+    std::vector<int> position; // index in cities, -1 once visited
+
+    void reset(size_t n)
+    {
+        cities.resize(n);
+        position.resize(n);
+        for (size_t c = 0; c < n; c++)
+            cities[c] = position[c] = (int)c;
+    }
+
+    bool contains(int city) const { return position[city] >= 0; }
+
+    void remove(int city)
+    {
+        const int p = position[city], last = cities.back();
+        cities[p] = last;
+        position[last] = p;
+        cities.pop_back();
+        position[city] = -1;
+    }
+};
+
+struct AcoParams
+{
+    size_t ants;
+    size_t candidates; // nearest-neighbour list length k
+    double alpha;      // pheromone influence
+    double beta;       // distance influence
+    double rho;        // evaporation rate
+    double q;          // deposit: q / tour length per edge
+    uint64_t seed;
+    SelectionMethod selection; // how the next city is drawn from the candidates
+    size_t tournamentSize;     // for SELECT_TOURNAMENT
+
+    AcoParams()
+        : ants(10), candidates(20), alpha(1.0), beta(5.0), rho(0.5), q(1.0), seed(1),
+          selection(SELECT_ROULETTE), tournamentSize(4) {}
+};
+
+// Improves ant `ant`'s tour in place and returns its new length
+typedef std::function<double(size_t ant, std::vector<int> &tour, double length)> TourStage;
+
+class AcoTspSolver
+{
+public:
+    AcoTspSolver(const TspInstance &tsp, const AcoParams &params = AcoParams(),
+                 ThreadPool &pool = defaultThreadPool())
+        : tsp(tsp), params(params), pool(pool), n(tsp.n), iter(0), best(HUGE_VAL)
+    {
+        k = std::min(params.candidates, n - 1);
+        k = k ? k : 1;
+        buildCandidateLists(tsp, k, cand, pool);
+
+        etaBeta.resize(n * k);
+        for (size_t s = 0; s < n * k; s++)
+        {
+            const double d = tsp.distance(s / k, cand[s]);
+            etaBeta[s] = std::pow(1.0 / (d > 0.0 ? d : 1e-9), params.beta);
+        }
+
+        // Ant System start: tau0 = ants / length of a nearest-neighbour tour
+        std::vector<int> nn;
+        nearestNeighbourTour(0, nn);
+        tau0 = (double)params.ants / tourLength(tsp, nn);
+        pheromone.init(n * k, tau0);
+        choice.resize(n * k);
+        computeChoiceInfo();
+
+        ants.resize(params.ants);
+        deposits.resize(params.ants);
+        for (size_t a = 0; a < ants.size(); a++)
+        {
+            ants[a].rng.reseed(params.seed, a);
+            ants[a].sampler.reserve(k);
+            pheromone.prepare(deposits[a]);
+        }
+    }
+
+    // One iteration: every ant builds a tour, then pheromone is updated
+    void iterate()
+    {
+        pool.parallelFor(0, ants.size(), 1, [&](size_t lo, size_t hi)
+                         {
+            for (size_t a = lo; a < hi; a++)
+            {
+                constructTour(ants[a]);
+                if (stage)
+                    ants[a].length = stage(a, ants[a].tour, ants[a].length);
+                collectDeposits(ants[a], deposits[a]);
+            } });
+        for (size_t a = 0; a < ants.size(); a++)
+        {
+            if (ants[a].length < best)
+            {
+                best = ants[a].length;
+                bestTour_ = ants[a].tour;
+            }
+        }
+        updatePheromone();
+        iter++;
+    }
+
+    double run(size_t iterations)
+    {
+        for (size_t t = 0; t < iterations; t++)
+            iterate();
+        return best;
+    }
+
+    // Runs after every tour construction, concurrently for different ants
+    void setTourStage(TourStage tourStage) { stage = tourStage; }
+
+    size_t iteration() const { return iter; }
+    size_t antCount() const { return ants.size(); }
+    size_t candidateCount() const { return k; }
+    const std::vector<int> &tour(size_t ant) const { return ants[ant].tour; }
+    double antLength(size_t ant) const { return ants[ant].length; }
+    const std::vector<int> &bestTour() const { return bestTour_; }
+    double bestLength() const { return best; }
+
+private:
+    struct Ant
+    {
+        Xoshiro256 rng;
+        UnvisitedSet unvisited;
+        WeightedSampler sampler;
+        std::vector<int> tour;
+        double length;
+    };
+
+    const TspInstance &tsp;
+    AcoParams params;
+    ThreadPool &pool;
+    size_t n, k, iter;
+    std::vector<int> cand;         // [city][k] nearest neighbours
+    std::vector<double> etaBeta;   // [city][k] (1 / d)^beta
+    PheromoneStore pheromone;      // [city][k]
+    std::vector<double> choice;    // [city][k] stored tau^alpha * eta^beta
+    double tau0;
+    std::vector<Ant> ants;
+    std::vector<DepositBuffer> deposits; // one per ant
+    TourStage stage;
+    std::vector<int> bestTour_;
+    double best;
+
+    // Choice info from the stored pheromone; the store's scale is common to
+    // a whole row, so it cancels in the roulette and is left out
+    void refreshChoice(size_t s)
+    {
+        const double t = pheromone.storedValue(s);
+        choice[s] = (params.alpha == 1.0 ? t : std::pow(t, params.alpha)) * etaBeta[s];
+    }
+
+    void computeChoiceInfo()
+    {
+        pool.parallelFor(0, n * k, 1 << 14, [&](size_t lo, size_t hi)
+                         {
+            for (size_t s = lo; s < hi; s++)
+                refreshChoice(s); });
+    }
+
+    // Nearest unvisited city from `from`: the fallback when all candidates
+    // are taken, linear in the cities left
+    int nearestUnvisited(size_t from, const UnvisitedSet &unvisited) const
+    {
+        int bestCity = -1;
+        double bestDist = HUGE_VAL;
+        for (size_t p = 0; p < unvisited.cities.size(); p++)
+        {
+            const int j = unvisited.cities[p];
+            const double d = tsp.rankKey(from, j);
+            // Rarely taken, so the tie-break costs nothing in the scan
+            if (d <= bestDist && (d < bestDist || j < bestCity))
+            {
+                bestDist = d;
+                bestCity = j;
+            }
+        }
+        return bestCity;
+    }
+
+    void nearestNeighbourTour(int start, std::vector<int> &tour) const
+    {
+        UnvisitedSet unvisited;
+        unvisited.reset(n);
+        tour.assign(1, start);
+        unvisited.remove(start);
+        for (size_t step = 1; step < n; step++)
+        {
+            const int *c = &cand[tour.back() * k];
+            int next = -1;
+            for (size_t s = 0; s < k && next < 0; s++)
+                if (unvisited.contains(c[s]))
+                    next = c[s];
+            if (next < 0)
+                next = nearestUnvisited(tour.back(), unvisited);
+            tour.push_back(next);
+            unvisited.remove(next);
+        }
+    }
+
+    void constructTour(Ant &ant) const
+    {
+        ant.unvisited.reset(n);
+        ant.tour.clear();
+        int current = (int)ant.rng.below((uint32_t)n);
+        ant.tour.push_back(current);
+        ant.unvisited.remove(current);
+        double length = 0.0;
+        for (size_t step = 1; step < n; step++)
+        {
+            const int *c = &cand[current * k];
+            const double *w = &choice[current * k];
+            double *weights = ant.sampler.weights(k);
+            for (size_t s = 0; s < k; s++)
+                weights[s] = ant.unvisited.contains(c[s]) ? w[s] : 0.0;
+            const int s = ant.sampler.select(params.selection, ant.rng, params.tournamentSize);
+            const int next = s >= 0 ? c[s] : nearestUnvisited(current, ant.unvisited);
+            length += tsp.distance(current, next);
+            ant.tour.push_back(next);
+            ant.unvisited.remove(next);
+            current = next;
+        }
+        ant.length = length + tsp.distance(current, ant.tour[0]);
+    }
+
+    // Slot of city `to` in the candidate list of `from`, or -1
+    int slotOf(int from, int to) const
+    {
+        const int *c = &cand[from * k];
+        for (size_t s = 0; s < k; s++)
+            if (c[s] == to)
+                return (int)s;
+        return -1;
+    }
+
+    // The ant's deposit, q / length on each tour edge in both directions
+    // (edges outside the candidate lists carry no pheromone)
+    void collectDeposits(const Ant &ant, DepositBuffer &buffer) const
+    {
+        buffer.clear();
+        const std::vector<int> &t = ant.tour;
+        const double amount = params.q / ant.length;
+        for (size_t i = 0; i < t.size(); i++)
+        {
+            const int u = t[i], v = t[i + 1 < t.size() ? i + 1 : 0];
+            int s = slotOf(u, v);
+            if (s >= 0)
+                buffer.add(u * k + s, amount);
+            s = slotOf(v, u);
+            if (s >= 0)
+                buffer.add(v * k + s, amount);
+        }
+    }
+
+    // Lazy evaporation, then the merged deposits
+    void updatePheromone()
+    {
+        if (pheromone.evaporate(params.rho))
+        {
+            pheromone.merge(deposits, pool);
+            computeChoiceInfo();
+        }
+        else
+            pheromone.merge(deposits, [this](size_t s)
+                            { refreshChoice(s); }, pool);
+    }
+};
+
+// runSearch() adapter (metaheuristic.h): an evaluation is one tour. The
+// solver carries on from its current state; start() spends nothing.
+class AcoTspSearch
+{
+public:
+    explicit AcoTspSearch(AcoTspSolver &solver) : solver(solver) {}
+
+    size_t start() { return 0; }
+
+    size_t step(double)
+    {
+        solver.iterate();
+        return solver.antCount();
+    }
+
+    double bestFitness() const { return solver.bestLength(); }
+
+private:
+    AcoTspSolver &solver;
+};
+
+#endif // ACO_TSP_H
@@ -0,0 +1,119 @@
+#ifndef ALIGNED_BUFFER_H
+#define ALIGNED_BUFFER_H
+
+// Move-only heap array aligned to a cache line, used for the flat matrices
+// (relations, populations) that the SIMD loops stream through.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+
+static const size_t CACHE_LINE = 64;
+
+// Elements needed to pad `count` values of T up to a whole number of cache lines
+template <typename T>
+size_t paddedCount(size_t count)
+{
+    const size_t perLine = CACHE_LINE / sizeof(T);
+    return (count + perLine - 1) / perLine * perLine;
+}
+
+// Floats per cache line: the inner trip count of loops over paddedCount()
+// float arrays (zero past the end), constant so that they vectorize at -O2
+static const size_t CACHE_LINE_FLOATS = CACHE_LINE / sizeof(float);
+
+template <typename T>
+class AlignedBuffer
+{
+public:
+    AlignedBuffer() : ptr(0), count(0) {}
+
+    // Zero-filled; only meant for trivially copyable T (float, double, int...)
+    explicit AlignedBuffer(size_t count) : ptr(0), count(0)
+    {
+        allocate(count);
+    }
+
+    ~AlignedBuffer()
+    {
+        release();
+    }
+
+    AlignedBuffer(AlignedBuffer &&other) : ptr(other.ptr), count(other.count)
+    {
+        other.ptr = 0;
+        other.count = 0;
+    }
+
+    AlignedBuffer &operator=(AlignedBuffer &&other)
+    {
+        if (this != &other)
+        {
+            release();
+            ptr = other.ptr;
+            count = other.count;
+            other.ptr = 0;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    AlignedBuffer(const AlignedBuffer &) = delete;
+    AlignedBuffer &operator=(const AlignedBuffer &) = delete;
+
+    // Reallocates (and zero-fills) only when the element count changes
+    void resize(size_t newCount)
+    {
+        if (newCount != count)
+        {
+            release();
+            allocate(newCount);
+        }
+    }
+
+    void fill(T value)
+    {
+        for (size_t i = 0; i < count; i++)
+            ptr[i] = value;
+    }
+
+    T *data() { return ptr; }
+    const T *data() const { return ptr; }
+    size_t size() const { return count; }
+    T &operator[](size_t i) { return ptr[i]; }
+    const T &operator[](size_t i) const { return ptr[i]; }
+
+private:
+    T *ptr;
+    size_t count;
+
+    // Over-allocate by one cache line and keep the original pointer just in
+    // front of the aligned block (portable: no aligned_alloc in C++11).
+    void allocate(size_t n)
+    {
+        if (n == 0)
+            return;
+        size_t bytes = n * sizeof(T) + CACHE_LINE + sizeof(void *);
+        void *raw = std::malloc(bytes);
+        if (!raw)
+            throw std::bad_alloc();
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void *);
+        uintptr_t aligned = (start + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+        reinterpret_cast<void **>(aligned)[-1] = raw;
+        ptr = reinterpret_cast<T *>(aligned);
+        count = n;
+        std::memset(ptr, 0, n * sizeof(T));
+    }
+
+    void release()
+    {
+        if (ptr)
+            std::free(reinterpret_cast<void **>(ptr)[-1]);
+        ptr = 0;
+        count = 0;
+    }
+};
+
+#endif // ALIGNED_BUFFER_H
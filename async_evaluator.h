@@ -0,0 +1,250 @@
+#ifndef ASYNC_EVALUATOR_H
+#define ASYNC_EVALUATOR_H
+
+// Asynchronous evaluation for expensive objectives, such as a simulation
+// that takes milliseconds per call with a latency that varies between calls.
+//
+// AsyncEvaluator runs each evaluation as its own thread pool task and hands
+// the results back in the order they finish. The point is copied, so the
+// caller may change it as soon as submit() returns. An evaluation that
+// throws is caught on the worker and rethrown by the next() that would have
+// returned its result.
+//
+// runAsync() drives a search with it in one of two modes:
+//   - ASYNC_GENERATIONAL: the whole population is proposed and submitted as
+//     one batch, and the next batch starts once the last result is back.
+//     The moves are the same as step()'s, but with a task per evaluation
+//     instead of a parallelFor chunk, so one slow point holds up only the
+//     end of the batch;
+//   - ASYNC_STEADY_STATE: there are no batches. Every member always has one
+//     evaluation in flight. When it finishes, the member is accepted, moved
+//     using the bests as they are at that moment and resubmitted, so a slow
+//     evaluation holds up only its own member.
+//
+// The search needs the hooks GwoSearch (gwo.h) and PsoSearch (pso.h) have:
+//
+//   size_t populationSize() const
+//   void restart()                                  // back to no members
+//   const double *propose(size_t i, double progress) // next point of member i
+//   void accept(size_t i, double fitness)           // its fitness
+//   double bestFitness() const
+//
+// The point propose() returns has to stay valid until the member's accept().
+// Evaluations run on the pool's workers while the calling thread waits for
+// results, so the pool should have a worker for every evaluation that is
+// meant to run at once; an external simulation mostly waits, so that can be
+// more workers than cores. With a serial pool every evaluation runs inside
+// submit(). Steady-state results depend on the order evaluations finish in,
+// so they do not repeat from run to run.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "metaheuristic.h"
+#include "thread_pool.h"
+
+template <typename Objective>
+class AsyncEvaluator
+{
+public:
+    AsyncEvaluator(const Objective &f, size_t dims, ThreadPool &pool = defaultThreadPool())
+        : f(f), dims(dims), pool(pool), pending(0) {}
+
+    // Waits for the evaluations still in flight
+    ~AsyncEvaluator() { drain(); }
+
+    AsyncEvaluator(const AsyncEvaluator &) = delete;
+    AsyncEvaluator &operator=(const AsyncEvaluator &) = delete;
+
+    size_t dimensions() const { return dims; }
+
+    // Queues f(x) under `tag`; x holds dims values and is copied
+    void submit(size_t tag, const double *x)
+    {
+        const std::vector<double> point(x, x + dims);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending++;
+        }
+        pool.submit([this, tag, point]()
+                    {
+            Result r;
+            r.tag = tag;
+            try
+            {
+                r.fitness = f(point.data(), dims);
+            }
+            catch (...)
+            {
+                r.error = std::current_exception();
+            }
+            // Notify under the lock: once next() has the result the
+            // evaluator may be destroyed
+            std::lock_guard<std::mutex> lock(mutex);
+            done.push_back(r);
+            ready.notify_one(); });
+    }
+
+    // Waits for the next evaluation to finish; false if none is in flight.
+    // Rethrows what the evaluation threw.
+    bool next(size_t &tag, double &fitness)
+    {
+        Result r;
+        if (!pop(r))
+            return false;
+        if (r.error)
+            std::rethrow_exception(r.error);
+        tag = r.tag;
+        fitness = r.fitness;
+        return true;
+    }
+
+    // Evaluations submitted and not yet returned by next()
+    size_t inFlight() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pending;
+    }
+
+    // Discards the results (and errors) of everything in flight once it has
+    // finished
+    void drain()
+    {
+        Result r;
+        while (pop(r))
+        {
+        }
+    }
+
+    // out[r] = f(rows + r * stride) for r < count, all in flight at once.
+    // Unlike evaluatePopulation() there is a task per row, so a slow row
+    // does not hold up the rest of its chunk. Results still in flight from
+    // submit() are dropped.
+    void evaluateBatch(const double *rows, size_t stride, size_t count, double *out)
+    {
+        drain();
+        for (size_t r = 0; r < count; r++)
+            submit(r, rows + r * stride);
+        size_t tag;
+        double fitness;
+        while (next(tag, fitness))
+            out[tag] = fitness;
+    }
+
+private:
+    struct Result
+    {
+        size_t tag;
+        double fitness;
+        std::exception_ptr error; // set when f threw
+
+        Result() : tag(0), fitness(0.0) {}
+    };
+
+    Objective f;
+    size_t dims;
+    ThreadPool &pool;
+
+    mutable std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Result> done; // finished, in order
+    size_t pending;
+
+    // Waits for the next finished evaluation; false if none is in flight
+    bool pop(Result &r)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (pending == 0)
+            return false;
+        ready.wait(lock, [this]()
+                   { return !done.empty(); });
+        r = done.front();
+        done.pop_front();
+        pending--;
+        return true;
+    }
+};
+
+enum AsyncMode
+{
+    ASYNC_GENERATIONAL,
+    ASYNC_STEADY_STATE
+};
+
+// Restarts `search` and runs it on `evaluator` until a limit in `limits`
+// stops it. An iteration is a population's worth of evaluations, so the
+// iteration limit and stagnation count those. Once a limit is reached no
+// more points are submitted, and the evaluations still in flight finish
+// and are counted. Neither mode submits more than the evaluation or
+// iteration budget allows. An exception from the objective ends the run
+// and propagates; the evaluator discards what is still in flight when it is
+// drained or destroyed.
+template <typename Search, typename Objective>
+RunResult runAsync(Search &search, AsyncEvaluator<Objective> &evaluator, const RunLimits &limits,
+                   AsyncMode mode = ASYNC_STEADY_STATE)
+{
+    typedef std::chrono::steady_clock Clock;
+    RunResult r;
+    const Clock::time_point begin = Clock::now();
+    const size_t n = search.populationSize();
+    size_t budget = limits.maxEvaluations;
+    if (limits.maxIterations && (!budget || limits.maxIterations * n < budget))
+        budget = limits.maxIterations * n;
+
+    evaluator.drain();
+    search.restart();
+    size_t submitted = 0;
+    for (size_t i = 0; i < n && (!budget || submitted < budget); i++, submitted++)
+        evaluator.submit(i, search.propose(i, 0.0));
+
+    double reference = HUGE_VAL;
+    size_t stale = 0;
+    size_t tag;
+    double fitness;
+    while (evaluator.next(tag, fitness))
+    {
+        search.accept(tag, fitness);
+        r.evaluations++;
+        r.bestFitness = search.bestFitness();
+        r.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        recordTarget(limits, r);
+        if (r.evaluations % n == 0)
+        {
+            r.iterations++;
+            stale = improved(limits, r.bestFitness, reference) ? 0 : stale + 1;
+        }
+        if (r.reason == STOP_NONE)
+            r.reason = limitReached(limits, r, stale, 0);
+        if (r.reason != STOP_NONE)
+            continue;
+
+        const double progress = budgetProgress(limits, r);
+        if (mode == ASYNC_STEADY_STATE)
+        {
+            if (!budget || submitted < budget)
+            {
+                evaluator.submit(tag, search.propose(tag, progress));
+                submitted++;
+            }
+        }
+        else if (evaluator.inFlight() == 0)
+        {
+            for (size_t i = 0; i < n && (!budget || submitted < budget); i++, submitted++)
+                evaluator.submit(i, search.propose(i, progress));
+        }
+    }
+
+    r.bestFitness = search.bestFitness();
+    r.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    if (r.reason == STOP_NONE)
+        r.reason = limits.maxIterations && r.iterations >= limits.maxIterations ? STOP_ITERATIONS
+                                                                                : STOP_EVALUATIONS;
+    return r;
+}
+
+#endif // ASYNC_EVALUATOR_H
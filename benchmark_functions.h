@@ -0,0 +1,339 @@
+#ifndef BENCHMARK_FUNCTIONS_H
+#define BENCHMARK_FUNCTIONS_H
+
+// Standard continuous test functions for the population optimizers (gwo.h,
+// pso.h), all minimized, each an objective in the form they expect:
+//
+//   SphereFunction      sum x^2                                [-100, 100]
+//   RastriginFunction   10 D + sum (x^2 - 10 cos 2 pi x)       [-5.12, 5.12]
+//   RosenbrockFunction  sum 100 (x' - x^2)^2 + (1 - x)^2       [-30, 30]
+//   AckleyFunction      -20 e^(-0.2 rms(x)) - e^(mean cos 2 pi x) + 20 + e
+//                                                              [-32, 32]
+//   GriewankFunction    1 + sum x^2 / 4000 - prod cos(x_i / sqrt i)
+//                                                              [-600, 600]
+//   SchwefelFunction    418.98.. D - sum x sin(sqrt |x|)       [-500, 500]
+//
+// The minimum is 0 for every one of them (at x = 0, at x = 1 for
+// Rosenbrock and at x = 420.97.. for Schwefel). Each struct also gives the
+// conventional bounds, so a benchmark can set up every optimizer on the same
+// problem.
+//
+// A call sums over the dimensions in BENCH_LANES independent accumulators,
+// compiled per ISA like membership.h's batch loop, so one point is a vector
+// loop; evaluatePopulation() in metaheuristic.h runs it over a whole
+// population on the thread pool. The trigonometry uses fastCos / fastSin
+// and the square roots fastRsqrt / fastSqrt below, because the libm calls
+// (and sqrt's errno path) would keep the loops scalar.
+
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+
+#include "aligned_buffer.h"
+#include "bit_cast.h"
+#include "simd_level.h"
+
+static const size_t BENCH_LANES = CACHE_LINE / sizeof(double);
+
+static const double BENCH_PI = 3.14159265358979323846;
+
+// cos(r + q pi / 2) for |r| <= pi / 4: the cosine or sine series of r,
+// picked and negated by the quadrant. Both series are evaluated so the
+// selection is a blend rather than a branch.
+inline double quadrantCos(double r, int64_t q)
+{
+    const double r2 = r * r;
+    double c = 1.0 / 20922789888000.0;
+    c = c * r2 - 1.0 / 87178291200.0;
+    c = c * r2 + 1.0 / 479001600.0;
+    c = c * r2 - 1.0 / 3628800.0;
+    c = c * r2 + 1.0 / 40320.0;
+    c = c * r2 - 1.0 / 720.0;
+    c = c * r2 + 1.0 / 24.0;
+    c = c * r2 - 0.5;
+    c = c * r2 + 1.0;
+    double s = -1.0 / 1307674368000.0;
+    s = s * r2 + 1.0 / 6227020800.0;
+    s = s * r2 - 1.0 / 39916800.0;
+    s = s * r2 + 1.0 / 362880.0;
+    s = s * r2 - 1.0 / 5040.0;
+    s = s * r2 + 1.0 / 120.0;
+    s = s * r2 - 1.0 / 6.0;
+    s = s * r2 * r + r;
+    // Quadrants 1, 3 use -sin r, sin r; quadrants 1, 2 are negative. Done
+    // on the bits: AVX2 has no 64-bit blend on a compare the vectorizer uses
+    const int64_t odd = -(q & 1);
+    const int64_t v = (bitCast<int64_t>(s) & odd) | (bitCast<int64_t>(c) & ~odd);
+    return bitCast<double>(v ^ (((q + 1) & 2) << 62));
+}
+
+// cos x with absolute error around 1e-16 for |x| up to ~1e6. x is reduced
+// by the nearest multiple of pi / 2, found with the same rounding trick as
+// fastExp and subtracted in three parts (Cody-Waite) so the remainder stays
+// exact.
+inline double fastCos(double x)
+{
+    const double magic = 6755399441055744.0; // 1.5 * 2^52
+    const double r0 = x * 0.63661977236758134 + magic;
+    const int64_t q = bitCast<int64_t>(r0) - bitCast<int64_t>(magic);
+    const double fn = r0 - magic;
+    const double r = x - fn * 1.57079632673412561417 - fn * 6.07710050650619224932e-11 -
+                     fn * 2.02226624879595063154e-21;
+    return quadrantCos(r, q);
+}
+
+// sin x = cos(x - pi / 2), done as a quadrant shift so it stays exact
+inline double fastSin(double x)
+{
+    const double magic = 6755399441055744.0;
+    const double r0 = x * 0.63661977236758134 + magic;
+    const int64_t q = bitCast<int64_t>(r0) - bitCast<int64_t>(magic);
+    const double fn = r0 - magic;
+    const double r = x - fn * 1.57079632673412561417 - fn * 6.07710050650619224932e-11 -
+                     fn * 2.02226624879595063154e-21;
+    return quadrantCos(r, q + 3);
+}
+
+// 1 / sqrt x for x > 0: the classic exponent-halving bit trick gives a
+// first guess within 4%, and four Newton steps (written out,
+// so the loops around it still vectorize) take it to full precision
+inline double fastRsqrt(double x)
+{
+    double y = bitCast<double>(0x5fe6eb50c7b537a9LL - (bitCast<int64_t>(x) >> 1));
+    const double half = 0.5 * x;
+    y = y * (1.5 - half * y * y);
+    y = y * (1.5 - half * y * y);
+    y = y * (1.5 - half * y * y);
+    return y * (1.5 - half * y * y);
+}
+
+// sqrt x for x >= 0
+inline double fastSqrt(double x)
+{
+    return x * fastRsqrt(x);
+}
+
+// sum, or product, of term(x, i) for i < n. Term is a functor
+// double operator()(const double *x, size_t i) const. Compiled per ISA.
+#define BENCH_DEFINE_LANE_LOOPS(NAME, ATTR)                                      \
+    template <typename Term>                                                     \
+    ATTR double laneSum##NAME(const Term &term, const double *x, size_t n)       \
+    {                                                                            \
+        double acc[BENCH_LANES] = {0.0};                                         \
+        size_t i = 0;                                                            \
+        for (; i + BENCH_LANES <= n; i += BENCH_LANES)                           \
+            for (size_t j = 0; j < BENCH_LANES; j++)                             \
+                acc[j] += term(x, i + j);                                        \
+        if (i < n && n >= BENCH_LANES)                                           \
+        {                                                                        \
+            /* last block overlaps the previous one; skip the lanes done */      \
+            const size_t base = n - BENCH_LANES, skip = i - base;                \
+            for (size_t j = 0; j < BENCH_LANES; j++)                             \
+            {                                                                    \
+                const double t = term(x, base + j);                              \
+                acc[j] += j >= skip ? t : 0.0;                                   \
+            }                                                                    \
+        }                                                                        \
+        else                                                                     \
+            for (; i < n; i++)                                                   \
+                acc[0] += term(x, i);                                            \
+        double sum = 0.0;                                                        \
+        for (size_t j = 0; j < BENCH_LANES; j++)                                 \
+            sum += acc[j];                                                       \
+        return sum;                                                              \
+    }                                                                            \
+                                                                                 \
+    template <typename Term>                                                     \
+    ATTR double laneProduct##NAME(const Term &term, const double *x, size_t n)   \
+    {                                                                            \
+        double acc[BENCH_LANES];                                                 \
+        for (size_t j = 0; j < BENCH_LANES; j++)                                 \
+            acc[j] = 1.0;                                                        \
+        size_t i = 0;                                                            \
+        for (; i + BENCH_LANES <= n; i += BENCH_LANES)                           \
+            for (size_t j = 0; j < BENCH_LANES; j++)                             \
+                acc[j] *= term(x, i + j);                                        \
+        if (i < n && n >= BENCH_LANES)                                           \
+        {                                                                        \
+            /* last block overlaps the previous one; skip the lanes done */      \
+            const size_t base = n - BENCH_LANES, skip = i - base;                \
+            for (size_t j = 0; j < BENCH_LANES; j++)                             \
+            {                                                                    \
+                const double t = term(x, base + j);                              \
+                acc[j] *= j >= skip ? t : 1.0;                                   \
+            }                                                                    \
+        }                                                                        \
+        else                                                                     \
+            for (; i < n; i++)                                                   \
+                acc[0] *= term(x, i);                                            \
+        double product = 1.0;                                                    \
+        for (size_t j = 0; j < BENCH_LANES; j++)                                 \
+            product *= acc[j];                                                   \
+        return product;                                                          \
+    }
+
+BENCH_DEFINE_LANE_LOOPS(Default, )
+#ifdef FUZZY_X86
+BENCH_DEFINE_LANE_LOOPS(Avx2, FUZZY_TARGET("avx2,fma"))
+BENCH_DEFINE_LANE_LOOPS(Avx512, FUZZY_TARGET("avx512f,avx512dq"))
+#endif
+
+#undef BENCH_DEFINE_LANE_LOOPS
+
+template <typename Term>
+double laneSum(const Term &term, const double *x, size_t n)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        return laneSumAvx512(term, x, n);
+    case SIMD_AVX2:
+        return laneSumAvx2(term, x, n);
+    default:
+        break;
+    }
+#endif
+    return laneSumDefault(term, x, n);
+}
+
+template <typename Term>
+double laneProduct(const Term &term, const double *x, size_t n)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        return laneProductAvx512(term, x, n);
+    case SIMD_AVX2:
+        return laneProductAvx2(term, x, n);
+    default:
+        break;
+    }
+#endif
+    return laneProductDefault(term, x, n);
+}
+
+// Per-dimension terms
+struct SquareTerm
+{
+    double operator()(const double *x, size_t i) const { return x[i] * x[i]; }
+};
+
+struct RastriginTerm
+{
+    double operator()(const double *x, size_t i) const
+    {
+        return x[i] * x[i] - 10.0 * fastCos(2.0 * BENCH_PI * x[i]);
+    }
+};
+
+// Pairs (x_i, x_i+1), for i < D - 1
+struct RosenbrockTerm
+{
+    double operator()(const double *x, size_t i) const
+    {
+        const double a = x[i + 1] - x[i] * x[i], b = 1.0 - x[i];
+        return 100.0 * a * a + b * b;
+    }
+};
+
+struct CosTerm
+{
+    double operator()(const double *x, size_t i) const { return fastCos(2.0 * BENCH_PI * x[i]); }
+};
+
+// cos(x_i / sqrt(i + 1)). The index becomes a double by placing it in the
+// mantissa of 2^52 and subtracting 2^52, which vectorizes on every ISA
+// (the integer conversions do not before AVX-512).
+struct GriewankTerm
+{
+    double operator()(const double *x, size_t i) const
+    {
+        const double index = bitCast<double>((int64_t)(i + 1) | 0x4330000000000000LL) - 4503599627370496.0;
+        return fastCos(x[i] * fastRsqrt(index));
+    }
+};
+
+struct SchwefelTerm
+{
+    double operator()(const double *x, size_t i) const
+    {
+        return x[i] * fastSin(fastSqrt(std::fabs(x[i])));
+    }
+};
+
+struct SphereFunction
+{
+    static const char *name() { return "Sphere"; }
+    static double lower() { return -100.0; }
+    static double upper() { return 100.0; }
+
+    double operator()(const double *x, size_t dims) const { return laneSum(SquareTerm(), x, dims); }
+};
+
+struct RastriginFunction
+{
+    static const char *name() { return "Rastrigin"; }
+    static double lower() { return -5.12; }
+    static double upper() { return 5.12; }
+
+    double operator()(const double *x, size_t dims) const
+    {
+        return 10.0 * (double)dims + laneSum(RastriginTerm(), x, dims);
+    }
+};
+
+struct RosenbrockFunction
+{
+    static const char *name() { return "Rosenbrock"; }
+    static double lower() { return -30.0; }
+    static double upper() { return 30.0; }
+
+    double operator()(const double *x, size_t dims) const
+    {
+        return dims > 1 ? laneSum(RosenbrockTerm(), x, dims - 1) : 0.0;
+    }
+};
+
+struct AckleyFunction
+{
+    static const char *name() { return "Ackley"; }
+    static double lower() { return -32.0; }
+    static double upper() { return 32.0; }
+
+    double operator()(const double *x, size_t dims) const
+    {
+        const double squares = laneSum(SquareTerm(), x, dims) / (double)dims;
+        const double cosines = laneSum(CosTerm(), x, dims) / (double)dims;
+        const double f = -20.0 * std::exp(-0.2 * std::sqrt(squares)) - std::exp(cosines) + 20.0 + std::exp(1.0);
+        return f > 0.0 ? f : 0.0;
+    }
+};
+
+struct GriewankFunction
+{
+    static const char *name() { return "Griewank"; }
+    static double lower() { return -600.0; }
+    static double upper() { return 600.0; }
+
+    double operator()(const double *x, size_t dims) const
+    {
+        const double f = 1.0 + laneSum(SquareTerm(), x, dims) / 4000.0 - laneProduct(GriewankTerm(), x, dims);
+        return f > 0.0 ? f : 0.0;
+    }
+};
+
+struct SchwefelFunction
+{
+    static const char *name() { return "Schwefel"; }
+    static double lower() { return -500.0; }
+    static double upper() { return 500.0; }
+
+    double operator()(const double *x, size_t dims) const
+    {
+        return 418.9828872724339 * (double)dims - laneSum(SchwefelTerm(), x, dims);
+    }
+};
+
+#endif // BENCHMARK_FUNCTIONS_H
@@ -0,0 +1,15 @@
+#ifndef BIT_CAST_H
+#define BIT_CAST_H
+
+#include <cstring>
+
+// The bits of `from` as a To of the same size (a register move once inlined)
+template <typename To, typename From>
+To bitCast(From from)
+{
+    To to;
+    std::memcpy(&to, &from, sizeof(To));
+    return to;
+}
+
+#endif // BIT_CAST_H
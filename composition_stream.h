@@ -0,0 +1,204 @@
+#ifndef COMPOSITION_STREAM_H
+#define COMPOSITION_STREAM_H
+
+// Streaming front-end for batched set composition. Queries arrive one at a
+// time through submit(); a background thread collects them into a batch and
+// composes the batch against R as soon as either maxBatch queries are waiting
+// or the oldest one has waited maxDelay. Two batch buffers alternate, so new
+// queries are accepted while the previous batch is being composed. Result
+// callbacks run on the stream thread and receive a pointer to R.cols()
+// values that is only valid during the call.
+//
+// A callback may call back into the stream. submit() from a callback never
+// blocks: past a full batch the query is queued and goes out with a later
+// batch. flush() from a callback only asks for the next batch to go out
+// without waiting for the deadline; it cannot wait for its own callbacks.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fuzzy_composition.h"
+#include "fuzzy_relation.h"
+#include "thread_pool.h"
+
+template <typename T, typename Op = IntersectionOp>
+class CompositionStream
+{
+public:
+    typedef std::function<void(const T *result, size_t n)> Callback;
+    typedef std::chrono::steady_clock Clock;
+
+    // R must outlive the stream
+    CompositionStream(const FuzzyRelationT<T> &R, size_t maxBatch, Clock::duration maxDelay,
+                      ThreadPool &pool = defaultThreadPool())
+        : R(R), maxBatch(maxBatch ? maxBatch : 1), maxDelay(maxDelay), pool(pool),
+          pending(this->maxBatch, R.rows()), inflight(this->maxBatch, R.rows()),
+          pendingCount(0), busy(false), flushRequested(false), stopping(false),
+          batchCount(0), queryCount(0)
+    {
+        pendingCallbacks.reserve(this->maxBatch);
+        inflightCallbacks.reserve(this->maxBatch);
+        worker = std::thread(&CompositionStream::run, this);
+    }
+
+    // Composes whatever is still queued before returning
+    ~CompositionStream()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    CompositionStream(const CompositionStream &) = delete;
+    CompositionStream &operator=(const CompositionStream &) = delete;
+
+    // Copies `set` (R.rows() values) into the pending batch. Blocks only when
+    // the pending batch is full and the previous one is still being composed
+    // (never from a callback; see above).
+    void submit(const T *set, Callback done)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (pendingCount == maxBatch && std::this_thread::get_id() == worker.get_id())
+        {
+            // The stream thread is the one that would make space
+            overflowSets.insert(overflowSets.end(), set, set + R.rows());
+            overflowCallbacks.push_back(std::move(done));
+            return;
+        }
+        space.wait(lock, [this]()
+                   { return pendingCount < maxBatch; });
+        if (pendingCount == 0)
+            oldest = Clock::now();
+        T *row = pending.row(pendingCount++);
+        for (size_t i = 0; i < R.rows(); i++)
+            row[i] = set[i];
+        pendingCallbacks.push_back(std::move(done));
+        // First query starts the deadline clock; a full batch goes out at once
+        if (pendingCount == 1 || pendingCount == maxBatch)
+            wake.notify_all();
+    }
+
+    // Composes everything submitted so far and waits for its callbacks
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        flushRequested = true;
+        wake.notify_all();
+        if (std::this_thread::get_id() == worker.get_id())
+            return;
+        idle.wait(lock, [this]()
+                  { return pendingCount == 0 && !busy; });
+    }
+
+    size_t batches() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return batchCount;
+    }
+
+    double averageBatchSize() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return batchCount ? (double)queryCount / batchCount : 0.0;
+    }
+
+private:
+    const FuzzyRelationT<T> &R;
+    const size_t maxBatch;
+    const Clock::duration maxDelay;
+    ThreadPool &pool;
+
+    FuzzyRelationT<T> pending, inflight, results;
+    std::vector<Callback> pendingCallbacks, inflightCallbacks;
+    // Queries a callback submitted while the pending batch was full
+    std::vector<T> overflowSets;
+    std::vector<Callback> overflowCallbacks;
+    size_t pendingCount;
+    Clock::time_point oldest;
+    bool busy, flushRequested, stopping;
+    size_t batchCount, queryCount;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake, space, idle;
+    std::thread worker;
+
+    bool batchReady() const
+    {
+        return pendingCount == maxBatch || flushRequested || stopping ||
+               (pendingCount > 0 && Clock::now() >= oldest + maxDelay);
+    }
+
+    // Moves queued callback submissions into the just-emptied pending batch
+    void refillFromOverflow()
+    {
+        size_t moved = 0;
+        for (; moved < overflowCallbacks.size() && pendingCount < maxBatch; moved++)
+        {
+            const T *set = overflowSets.data() + moved * R.rows();
+            T *row = pending.row(pendingCount++);
+            for (size_t i = 0; i < R.rows(); i++)
+                row[i] = set[i];
+            pendingCallbacks.push_back(std::move(overflowCallbacks[moved]));
+        }
+        if (moved == 0)
+            return;
+        oldest = Clock::now();
+        overflowSets.erase(overflowSets.begin(), overflowSets.begin() + moved * R.rows());
+        overflowCallbacks.erase(overflowCallbacks.begin(), overflowCallbacks.begin() + moved);
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            wake.wait(lock, [this]()
+                      { return pendingCount > 0 || stopping || flushRequested; });
+            if (pendingCount == 0)
+            {
+                if (stopping)
+                    return;
+                flushRequested = false;
+                idle.notify_all();
+                wake.wait(lock, [this]()
+                          { return pendingCount > 0 || stopping; });
+                continue;
+            }
+            while (!batchReady())
+                wake.wait_until(lock, oldest + maxDelay);
+
+            // Swap buffers so submitters can fill the other one meanwhile
+            std::swap(pending, inflight);
+            pendingCallbacks.swap(inflightCallbacks);
+            size_t count = pendingCount;
+            pendingCount = 0;
+            refillFromOverflow();
+            busy = true;
+            space.notify_all();
+            lock.unlock();
+
+            results.resize(count, R.cols());
+            composeRelations<Op>(inflight.view().block(0, 0, count, R.rows()), R.view(), results.view(), pool);
+            for (size_t q = 0; q < count; q++)
+                inflightCallbacks[q](results.row(q), R.cols());
+            inflightCallbacks.clear();
+
+            lock.lock();
+            busy = false;
+            batchCount++;
+            queryCount += count;
+            if (pendingCount == 0)
+                idle.notify_all();
+        }
+    }
+};
+
+#endif // COMPOSITION_STREAM_H
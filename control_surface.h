@@ -0,0 +1,333 @@
+#ifndef CONTROL_SURFACE_H
+#define CONTROL_SURFACE_H
+
+// Offline-compiled control surface for a FuzzyController with one to three
+// inputs. The rule base is evaluated once on a regular grid over the input
+// ranges; online inference is then a clamp, an index computation and a
+// bilinear (2 inputs) or trilinear (3 inputs) interpolation between the
+// neighbouring grid values, instead of fuzzification, rule firing and
+// defuzzification.
+//
+// compile() also measures how far the surface strays from exact inference:
+// it evaluates the controller on a grid SURFACE_CHECK_REFINE times finer
+// along every axis (2 for three inputs, to bound the cost) and records the
+// largest difference. This is a measured maximum, not a proof; between
+// check points the error can be slightly larger.
+// compileWithin() doubles the grid until that deviation meets a bound.
+// writeHeader() emits the table and interpolation as a standalone C++11
+// header with constexpr data.
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "controller_batch.h"
+#include "fuzzy_inference.h"
+#include "thread_pool.h"
+
+static const size_t SURFACE_MAX_INPUTS = 3;
+static const size_t SURFACE_CHECK_REFINE = 4;
+// compileWithin()'s default cap on the whole grid: 4 MB of floats, 1025
+// points per axis for two inputs and 65 for three
+static const size_t SURFACE_MAX_NODES = size_t(1) << 20;
+
+// Shortest text that reads back as the same float, as a C++ float literal
+inline std::string floatLiteral(float v)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", v);
+    std::string text = buf;
+    if (text.find_first_of(".en") == std::string::npos)
+        text += ".0";
+    return text + "f";
+}
+
+class ControlSurface
+{
+public:
+    ControlSurface() : dims(0), output(0), deviation(0.0f)
+    {
+        for (size_t d = 0; d < SURFACE_MAX_INPUTS; d++)
+        {
+            points[d] = 1;
+            lo[d] = 0.0f;
+            step[d] = invStep[d] = 1.0f;
+            strides[d] = 0;
+        }
+    }
+
+    // Tabulates output `outputIndex` on pointsPerAxis points per input
+    // (at least 2). Returns false if the controller has no inputs or more
+    // than SURFACE_MAX_INPUTS.
+    bool compile(const FuzzyController &controller, size_t pointsPerAxis, size_t outputIndex = 0,
+                 ThreadPool &pool = defaultThreadPool())
+    {
+        dims = controller.inputCount();
+        if (dims == 0 || dims > SURFACE_MAX_INPUTS || outputIndex >= controller.outputCount())
+        {
+            dims = 0;
+            return false;
+        }
+        output = outputIndex;
+        pointsPerAxis = pointsPerAxis < 2 ? 2 : pointsPerAxis;
+        for (size_t d = 0; d < SURFACE_MAX_INPUTS; d++)
+        {
+            if (d < dims)
+            {
+                const FuzzyVariable &in = controller.input(d);
+                points[d] = pointsPerAxis;
+                lo[d] = in.lo;
+                step[d] = (in.hi - in.lo) / (float)(pointsPerAxis - 1);
+                invStep[d] = 1.0f / step[d];
+            }
+            else
+            {
+                points[d] = 1;
+                lo[d] = 0.0f;
+                step[d] = invStep[d] = 1.0f;
+            }
+        }
+        // Last input varies fastest
+        strides[dims - 1] = 1;
+        for (size_t d = dims - 1; d > 0; d--)
+            strides[d - 1] = strides[d] * points[d];
+        for (size_t d = dims; d < SURFACE_MAX_INPUTS; d++)
+            strides[d] = 0;
+
+        std::vector<size_t> counts(points, points + dims);
+        table.resize(nodeCount());
+        float *dst = table.data();
+        sampleGrid(controller, counts, 1, pool, [dst](size_t start, const float *values, size_t count)
+                   {
+            for (size_t k = 0; k < count; k++)
+                dst[start + k] = values[k]; });
+        deviation = measureDeviation(controller, pool);
+        return true;
+    }
+
+    // Starts at 9 points per axis and doubles the cell count until the
+    // deviation is at most maxError or the next grid would have more than
+    // maxNodes nodes in all. Returns whether the bound was met.
+    bool compileWithin(const FuzzyController &controller, float maxError, size_t maxNodes = SURFACE_MAX_NODES,
+                       size_t outputIndex = 0, ThreadPool &pool = defaultThreadPool())
+    {
+        size_t n = 9;
+        for (;;)
+        {
+            if (!compile(controller, n, outputIndex, pool))
+                return false;
+            if (deviation <= maxError)
+                return true;
+            const size_t next = 2 * n - 1;
+            size_t nodes = 1;
+            for (size_t d = 0; d < dims; d++)
+                nodes *= next;
+            if (nodes > maxNodes)
+                return false;
+            n = next;
+        }
+    }
+
+    size_t inputCount() const { return dims; }
+    size_t pointsPerAxis() const { return points[0]; }
+    size_t nodeCount() const { return points[0] * points[1] * points[2]; }
+    size_t memoryBytes() const { return table.size() * sizeof(float); }
+    // Largest |surface - controller| found while compiling
+    float maxDeviation() const { return deviation; }
+    const float *data() const { return table.data(); }
+
+    // x[d] for each input; inputs outside their range are clamped
+    float operator()(const float *x) const
+    {
+        size_t cell[SURFACE_MAX_INPUTS];
+        float frac[SURFACE_MAX_INPUTS];
+        for (size_t d = 0; d < dims; d++)
+            locate(d, x[d], cell[d], frac[d]);
+
+        const float *t = table.data();
+        if (dims == 1)
+        {
+            const float *p = t + cell[0];
+            return p[0] + frac[0] * (p[1] - p[0]);
+        }
+        if (dims == 2)
+            return bilinear(t + cell[0] * strides[0] + cell[1], strides[0], frac[0], frac[1]);
+        const float *p = t + cell[0] * strides[0] + cell[1] * strides[1] + cell[2];
+        float front = bilinear(p, strides[1], frac[1], frac[2]);
+        float back = bilinear(p + strides[0], strides[1], frac[1], frac[2]);
+        return front + frac[0] * (back - front);
+    }
+
+    // out[k] = surface(in[0][k], in[1][k], ...)
+    void evaluate(const float *const *in, float *out, size_t n) const
+    {
+        float x[SURFACE_MAX_INPUTS];
+        for (size_t k = 0; k < n; k++)
+        {
+            for (size_t d = 0; d < dims; d++)
+                x[d] = in[d][k];
+            out[k] = (*this)(x);
+        }
+    }
+
+    // Standalone header: the table as a constexpr array and
+    // `inline float <name>(float x0, ...)` doing the same interpolation
+    void writeHeader(std::ostream &os, const std::string &name) const
+    {
+        std::string guard = name;
+        for (size_t i = 0; i < guard.size(); i++)
+            guard[i] = (char)toupper((unsigned char)guard[i]);
+        guard += "_SURFACE_H";
+
+        os << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+        os << "// Generated by ControlSurface::writeHeader: " << dims << "-input control surface, "
+           << points[0] << " points per axis, max deviation " << deviation << "\n\n";
+        os << "#include <cstddef>\n\n";
+        os << "constexpr size_t " << name << "_points = " << points[0] << ";\n";
+        for (size_t d = 0; d < dims; d++)
+            os << "constexpr float " << name << "_lo" << d << " = " << floatLiteral(lo[d]) << ", " << name
+               << "_inv_step" << d << " = " << floatLiteral(invStep[d]) << ";\n";
+        os << "constexpr float " << name << "_table[" << table.size() << "] = {";
+        for (size_t i = 0; i < table.size(); i++)
+            os << (i % 8 == 0 ? "\n    " : " ") << floatLiteral(table[i]) << ",";
+        os << "\n};\n\n";
+
+        // Cell lookup and interpolation, as in ControlSurface::operator()
+        os << "inline float " << name << "(";
+        for (size_t d = 0; d < dims; d++)
+            os << (d ? ", " : "") << "float x" << d;
+        os << ")\n{\n";
+        os << "    const float last = (float)(" << name << "_points - 1);\n";
+        for (size_t d = 0; d < dims; d++)
+        {
+            os << "    float u" << d << " = (x" << d << " - " << name << "_lo" << d << ") * " << name << "_inv_step" << d
+               << ";\n";
+            os << "    u" << d << " = u" << d << " > 0.0f ? u" << d << " : 0.0f;\n";
+            os << "    u" << d << " = u" << d << " < last ? u" << d << " : last;\n";
+            os << "    size_t i" << d << " = (size_t)u" << d << ";\n";
+            os << "    i" << d << " = i" << d << " < " << name << "_points - 2 ? i" << d << " : " << name
+               << "_points - 2;\n";
+            os << "    float f" << d << " = u" << d << " - (float)i" << d << ";\n";
+        }
+        os << "    const float *p = " << name << "_table";
+        for (size_t d = 0; d < dims; d++)
+            os << " + i" << d << " * " << strides[d];
+        os << ";\n";
+        // Corner sum: each corner weighted by f or (1 - f) per axis
+        os << "    return";
+        for (size_t c = 0; c < ((size_t)1 << dims); c++)
+        {
+            os << (c ? "\n         + " : " ");
+            size_t offset = 0;
+            for (size_t d = 0; d < dims; d++)
+            {
+                bool upper = (c >> (dims - 1 - d)) & 1;
+                offset += upper ? strides[d] : 0;
+                os << (upper ? "f" : "(1.0f - f") << d << (upper ? "" : ")") << " * ";
+            }
+            os << "p[" << offset << "]";
+        }
+        os << ";\n}\n\n#endif // " << guard << "\n";
+    }
+
+private:
+    size_t dims, output;
+    size_t points[SURFACE_MAX_INPUTS], strides[SURFACE_MAX_INPUTS];
+    float lo[SURFACE_MAX_INPUTS], step[SURFACE_MAX_INPUTS], invStep[SURFACE_MAX_INPUTS];
+    AlignedBuffer<float> table;
+    float deviation;
+
+    void locate(size_t d, float x, size_t &cell, float &frac) const
+    {
+        const float last = (float)(points[d] - 1);
+        float u = (x - lo[d]) * invStep[d];
+        u = u > 0.0f ? u : 0.0f;
+        u = u < last ? u : last;
+        size_t i = (size_t)u;
+        i = i < points[d] - 2 ? i : points[d] - 2;
+        cell = i;
+        frac = u - (float)i;
+    }
+
+    static float bilinear(const float *p, size_t rowStride, float fy, float fx)
+    {
+        float top = p[0] + fx * (p[1] - p[0]);
+        float bottom = p[rowStride] + fx * (p[rowStride + 1] - p[rowStride]);
+        return top + fy * (bottom - top);
+    }
+
+    // Evaluates the controller on every node of a grid with counts[d] points
+    // along input d, spaced step[d] / refine, in row-major order (last input
+    // fastest). Nodes go through the batch API in slabs so the input columns
+    // stay small; sink(start, values, count) gets output `output` of nodes
+    // start .. start + count - 1.
+    template <typename Sink>
+    void sampleGrid(const FuzzyController &controller, const std::vector<size_t> &counts, size_t refine,
+                    ThreadPool &pool, Sink sink) const
+    {
+        size_t total = 1;
+        for (size_t d = 0; d < dims; d++)
+            total *= counts[d];
+        const size_t slab = 1 << 16;
+        std::vector<std::vector<float> > columns(dims, std::vector<float>(slab));
+        std::vector<std::vector<float> > results(controller.outputCount(), std::vector<float>(slab));
+        std::vector<const float *> inPtrs(dims);
+        std::vector<float *> outPtrs(controller.outputCount());
+        BatchScratch scratch;
+        for (size_t d = 0; d < dims; d++)
+            inPtrs[d] = columns[d].data();
+        for (size_t o = 0; o < outPtrs.size(); o++)
+            outPtrs[o] = results[o].data();
+
+        for (size_t start = 0; start < total; start += slab)
+        {
+            size_t count = total - start < slab ? total - start : slab;
+            for (size_t k = 0; k < count; k++)
+            {
+                size_t node = start + k;
+                for (size_t d = dims; d-- > 0;)
+                {
+                    size_t i = node % counts[d];
+                    node /= counts[d];
+                    columns[d][k] = lo[d] + step[d] * (float)i / (float)refine;
+                }
+            }
+            evaluateBatchParallel(controller, inPtrs.data(), outPtrs.data(), count, scratch, pool);
+            sink(start, results[output].data(), count);
+        }
+    }
+
+    // Max |surface - exact| over the grid refined along every axis, compared
+    // slab by slab so the refined grid is never held in memory
+    float measureDeviation(const FuzzyController &controller, ThreadPool &pool) const
+    {
+        const size_t refine = dims < 3 ? SURFACE_CHECK_REFINE : 2;
+        std::vector<size_t> counts(dims);
+        for (size_t d = 0; d < dims; d++)
+            counts[d] = refine * (points[d] - 1) + 1;
+
+        float worst = 0.0f;
+        sampleGrid(controller, counts, refine, pool, [&](size_t start, const float *exact, size_t count)
+                   {
+            float x[SURFACE_MAX_INPUTS];
+            for (size_t k = 0; k < count; k++)
+            {
+                size_t node = start + k;
+                for (size_t d = dims; d-- > 0;)
+                {
+                    x[d] = lo[d] + step[d] * (float)(node % counts[d]) / (float)refine;
+                    node /= counts[d];
+                }
+                const float err = std::fabs((*this)(x) - exact[k]);
+                worst = err > worst ? err : worst;
+            } });
+        return worst;
+    }
+};
+
+#endif // CONTROL_SURFACE_H
@@ -0,0 +1,203 @@
+#ifndef CONTROLLER_BATCH_H
+#define CONTROLLER_BATCH_H
+
+// Multithreaded batch evaluation of a FuzzyController over SoA columns, and
+// a streaming front-end that runs a controller over an unbounded sensor feed
+// in fixed-size chunks.
+//
+// The feed is either CSV text (one sample per line, one column per input in
+// the rule base's input order, optional non-numeric header line) or raw
+// binary records of inputCount() native-endian floats. Rows are read into a
+// reused chunk of SoA columns, evaluated across the pool and handed to a
+// sink; memory stays at one chunk however long the feed runs.
+
+#include <cstddef>
+#include <cstdlib>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fuzzy_inference.h"
+#include "thread_pool.h"
+
+// Samples per parallelFor chunk; each chunk reuses one scratch for many blocks
+static const size_t CONTROLLER_GRAIN = 16 * INFERENCE_BLOCK;
+
+// Scratch for evaluateBatchParallel, kept by callers that evaluate batch
+// after batch: one InferenceScratch and one set of column pointers per
+// parallelFor chunk, grown on first use and reused afterwards
+struct BatchScratch
+{
+    std::vector<InferenceScratch> chunks;
+    std::vector<const float *> inChunks; // [chunk][input]
+    std::vector<float *> outChunks;      // [chunk][output]
+};
+
+// out[o][k] = controller output o for sample k (inputs in[i][k]), split
+// across the pool
+inline void evaluateBatchParallel(const FuzzyController &controller, const float *const *in, float *const *out,
+                                  size_t n, BatchScratch &scratch, ThreadPool &pool = defaultThreadPool())
+{
+    const size_t inputs = controller.inputCount(), outputs = controller.outputCount();
+    const size_t chunks = (n + CONTROLLER_GRAIN - 1) / CONTROLLER_GRAIN;
+    if (scratch.chunks.size() < chunks)
+        scratch.chunks.resize(chunks);
+    if (scratch.inChunks.size() < chunks * inputs)
+        scratch.inChunks.resize(chunks * inputs);
+    if (scratch.outChunks.size() < chunks * outputs)
+        scratch.outChunks.resize(chunks * outputs);
+    pool.parallelFor(0, n, CONTROLLER_GRAIN, [&](size_t lo, size_t hi)
+                     {
+        const size_t c = lo / CONTROLLER_GRAIN;
+        const float **inChunk = scratch.inChunks.data() + c * inputs;
+        float **outChunk = scratch.outChunks.data() + c * outputs;
+        for (size_t i = 0; i < inputs; i++)
+            inChunk[i] = in[i] + lo;
+        for (size_t o = 0; o < outputs; o++)
+            outChunk[o] = out[o] + lo;
+        controller.evaluateBatch(inChunk, outChunk, hi - lo, scratch.chunks[c]); });
+}
+
+// One-off form; allocates its scratch for the call
+inline void evaluateBatchParallel(const FuzzyController &controller, const float *const *in, float *const *out,
+                                  size_t n, ThreadPool &pool = defaultThreadPool())
+{
+    BatchScratch scratch;
+    evaluateBatchParallel(controller, in, out, n, scratch, pool);
+}
+
+enum SensorFormat
+{
+    SENSOR_CSV,
+    SENSOR_BINARY
+};
+
+class ControllerStream
+{
+public:
+    // Sink called once per chunk: sink(inputs, outputs, rows), where
+    // inputs[i] / outputs[o] are columns of `rows` values, valid during the call
+    ControllerStream(const FuzzyController &controller, size_t chunkRows = 65536,
+                     ThreadPool &pool = defaultThreadPool())
+        : controller(controller), chunkRows(chunkRows ? chunkRows : 1), pool(pool),
+          inputColumns(controller.inputCount()), outputColumns(controller.outputCount()),
+          inputPtrs(controller.inputCount()), outputPtrs(controller.outputCount())
+    {
+        for (size_t i = 0; i < inputColumns.size(); i++)
+        {
+            inputColumns[i].resize(this->chunkRows);
+            inputPtrs[i] = inputColumns[i].data();
+        }
+        for (size_t o = 0; o < outputColumns.size(); o++)
+        {
+            outputColumns[o].resize(this->chunkRows);
+            outputPtrs[o] = outputColumns[o].data();
+        }
+        if (controller.inputCount())
+            binaryRow.resize(this->chunkRows * controller.inputCount());
+    }
+
+    // Runs the whole feed through the controller. Returns false with a
+    // message (and the rows processed so far in `rows`) on malformed input.
+    template <typename Sink>
+    bool process(std::istream &in, SensorFormat format, Sink sink, size_t &rows, std::string &error)
+    {
+        rows = 0;
+        lineNo = 0;
+        for (;;)
+        {
+            size_t count = 0;
+            bool ok = format == SENSOR_CSV ? readCsv(in, count, error) : readBinary(in, count, error);
+            if (count > 0)
+            {
+                evaluateBatchParallel(controller, constInputs(), outputPtrs.data(), count, scratch, pool);
+                const float *const *outputs = outputPtrs.data();
+                sink(constInputs(), outputs, count);
+                rows += count;
+            }
+            if (!ok)
+                return false;
+            if (count < chunkRows)
+                return true;
+        }
+    }
+
+private:
+    const FuzzyController &controller;
+    const size_t chunkRows;
+    ThreadPool &pool;
+    std::vector<AlignedBuffer<float> > inputColumns, outputColumns;
+    std::vector<float *> inputPtrs, outputPtrs;
+    std::vector<float> binaryRow;
+    BatchScratch scratch;
+    std::string line;
+    size_t lineNo;
+
+    const float *const *constInputs() const
+    {
+        return inputPtrs.data();
+    }
+
+    // Fills up to chunkRows rows; count < chunkRows means end of feed
+    bool readCsv(std::istream &in, size_t &count, std::string &error)
+    {
+        const size_t inputs = inputPtrs.size();
+        while (count < chunkRows && std::getline(in, line))
+        {
+            lineNo++;
+            const char *p = line.c_str();
+            size_t field = 0;
+            for (; field < inputs; field++)
+            {
+                char *end;
+                float v = std::strtof(p, &end);
+                if (end == p)
+                    break;
+                inputPtrs[field][count] = v;
+                p = end;
+                while (*p == ' ' || *p == '\t' || *p == '\r')
+                    p++;
+                if (*p == ',' || *p == ';')
+                    p++;
+            }
+            if (field == inputs && *p == '\0')
+            {
+                count++;
+                continue;
+            }
+            // Blank lines and a leading header are skipped
+            bool blank = line.find_first_not_of(" \t\r") == std::string::npos;
+            if (blank || (lineNo == 1 && field == 0))
+                continue;
+            std::ostringstream msg;
+            msg << "line " << lineNo << ": expected " << inputs << " numeric columns";
+            if (field == inputs)
+                msg << ", found more";
+            error = msg.str();
+            return false;
+        }
+        return true;
+    }
+
+    bool readBinary(std::istream &in, size_t &count, std::string &error)
+    {
+        const size_t inputs = inputPtrs.size();
+        const size_t recordBytes = inputs * sizeof(float);
+        in.read(reinterpret_cast<char *>(binaryRow.data()), chunkRows * recordBytes);
+        size_t bytes = (size_t)in.gcount();
+        count = bytes / recordBytes;
+        // Records to columns
+        for (size_t k = 0; k < count; k++)
+            for (size_t i = 0; i < inputs; i++)
+                inputPtrs[i][k] = binaryRow[k * inputs + i];
+        if (bytes % recordBytes)
+        {
+            error = "binary feed ends in a partial record";
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif // CONTROLLER_BATCH_H
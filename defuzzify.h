@@ -0,0 +1,421 @@
+#ifndef DEFUZZIFY_H
+#define DEFUZZIFY_H
+
+// Defuzzification of an aggregated Mamdani output set: centroid, bisector,
+// and mean / smallest / largest of maximum.
+//
+// PiecewiseDefuzzifier is exact for output terms that are piecewise linear
+// (triangular, trapezoidal, constant). Each active term, clipped (min
+// implication) or scaled (product implication) by its firing level, is
+// still a trapezoid; their max is a polyline whose corners are the term
+// corners plus the points where two terms cross. The defuzzifier builds
+// that polyline and integrates each linear piece in closed form, adding its
+// area and first moment to running totals, so the centroid needs no grid.
+//
+// defuzzifySampled handles every other shape from an aggregated set sampled
+// on a uniform grid; its area / moment / peak reduction is compiled per ISA
+// like the other kernels.
+//
+// Both work in caller-owned storage: PiecewiseDefuzzifier keeps its vectors
+// between calls (clear() does not free), and the sampled path only reads
+// the aggregate buffer, so steady-state evaluation does not allocate.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "fuzzy_kernels.h"
+
+enum DefuzzMethod
+{
+    DEFUZZ_CENTROID,
+    DEFUZZ_BISECTOR,
+    DEFUZZ_MOM,
+    DEFUZZ_SOM,
+    DEFUZZ_LOM
+};
+
+// Trapezoid a <= b <= c <= d with plateau `height`; a triangle has b == c
+struct TrapezoidShape
+{
+    float a, b, c, d, height;
+
+    // Slope and intercept of the piece containing x (x strictly inside a
+    // piece, so vertical edges never matter)
+    void lineAt(float x, float &slope, float &intercept) const
+    {
+        if (x <= a || x >= d)
+        {
+            slope = intercept = 0.0f;
+        }
+        else if (x < b)
+        {
+            slope = height / (b - a);
+            intercept = -slope * a;
+        }
+        else if (x <= c)
+        {
+            slope = 0.0f;
+            intercept = height;
+        }
+        else
+        {
+            slope = -height / (d - c);
+            intercept = -slope * d;
+        }
+    }
+};
+
+// One linear piece of the aggregated set
+struct LinearPiece
+{
+    float x0, x1, y0, y1;
+};
+
+class PiecewiseDefuzzifier
+{
+public:
+    PiecewiseDefuzzifier() : lo(0.0f), hi(1.0f) {}
+
+    // Starts a new aggregated set over the output range [lo, hi]
+    void clear(float rangeLo, float rangeHi)
+    {
+        lo = rangeLo;
+        hi = rangeHi;
+        shapes.clear();
+    }
+
+    // Term trapezoid(a, b, c, d) (peak 1) fired at `level`; min implication
+    // clips it at the level, product implication scales it
+    void addClipped(float a, float b, float c, float d, float level)
+    {
+        TrapezoidShape s = {a, a + level * (b - a), d - level * (d - c), d, level};
+        shapes.push_back(s);
+    }
+
+    void addScaled(float a, float b, float c, float d, float level)
+    {
+        TrapezoidShape s = {a, b, c, d, level};
+        shapes.push_back(s);
+    }
+
+    // Constant term: height k everywhere on the range
+    void addConstant(float k)
+    {
+        TrapezoidShape s = {lo, lo, hi, hi, k};
+        shapes.push_back(s);
+    }
+
+    // `fallback` when nothing fired
+    float defuzzify(DefuzzMethod method, float fallback)
+    {
+        buildEnvelope();
+        if (peak <= 0.0f)
+            return fallback;
+        switch (method)
+        {
+        case DEFUZZ_CENTROID:
+            // A set of zero area (only vertical spikes) has no centroid
+            return area > 0.0f ? moment / area : meanOfMaximum();
+        case DEFUZZ_BISECTOR:
+            return area > 0.0f ? bisector() : meanOfMaximum();
+        case DEFUZZ_SOM:
+            return maximumEdge(true);
+        case DEFUZZ_LOM:
+            return maximumEdge(false);
+        default:
+            return meanOfMaximum();
+        }
+    }
+
+private:
+    float lo, hi;
+    std::vector<TrapezoidShape> shapes;
+    std::vector<float> xs, cuts;
+    std::vector<LinearPiece> pieces;
+    std::vector<float> slopes, intercepts;
+    float area, moment, peak;
+
+    // Aggregated value at x from the lines active on the current interval
+    float envelope(float x, size_t active) const
+    {
+        float y = 0.0f;
+        for (size_t i = 0; i < active; i++)
+        {
+            float v = slopes[i] * x + intercepts[i];
+            y = v > y ? v : y;
+        }
+        return y;
+    }
+
+    void addPiece(float x0, float x1, float y0, float y1)
+    {
+        LinearPiece p = {x0, x1, y0, y1};
+        pieces.push_back(p);
+        const float dx = x1 - x0;
+        area += 0.5f * (y0 + y1) * dx;
+        // Integral of x * y over the piece
+        moment += dx * (x0 * (2.0f * y0 + y1) + x1 * (y0 + 2.0f * y1)) / 6.0f;
+        peak = y0 > peak ? y0 : peak;
+        peak = y1 > peak ? y1 : peak;
+    }
+
+    // Sorted insert; the lists here hold a handful of points
+    static void insertSorted(std::vector<float> &v, float x)
+    {
+        v.push_back(x);
+        size_t i = v.size() - 1;
+        for (; i > 0 && v[i - 1] > x; i--)
+            v[i] = v[i - 1];
+        v[i] = x;
+    }
+
+    void buildEnvelope()
+    {
+        pieces.clear();
+        area = moment = peak = 0.0f;
+
+        xs.clear();
+        xs.push_back(lo);
+        for (size_t i = 0; i < shapes.size(); i++)
+        {
+            const float corners[4] = {shapes[i].a, shapes[i].b, shapes[i].c, shapes[i].d};
+            for (int k = 0; k < 4; k++)
+                if (corners[k] > lo && corners[k] < hi)
+                    insertSorted(xs, corners[k]);
+        }
+        xs.push_back(hi);
+
+        const size_t n = shapes.size();
+        slopes.resize(n);
+        intercepts.resize(n);
+        for (size_t j = 0; j + 1 < xs.size(); j++)
+        {
+            const float x0 = xs[j], x1 = xs[j + 1];
+            if (x1 <= x0)
+                continue;
+            // Every shape is linear on (x0, x1): no corner lies inside. Only
+            // shapes that are nonzero there take part.
+            const float mid = 0.5f * (x0 + x1);
+            size_t active = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                shapes[i].lineAt(mid, slopes[active], intercepts[active]);
+                active += slopes[active] != 0.0f || intercepts[active] != 0.0f;
+            }
+            if (active == 0)
+            {
+                addPiece(x0, x1, 0.0f, 0.0f);
+                continue;
+            }
+
+            // Split where two lines cross, so the max is linear on each part
+            cuts.clear();
+            cuts.push_back(x0);
+            for (size_t p = 0; p < active; p++)
+                for (size_t q = p + 1; q < active; q++)
+                {
+                    float ds = slopes[p] - slopes[q];
+                    if (ds == 0.0f)
+                        continue;
+                    float x = (intercepts[q] - intercepts[p]) / ds;
+                    if (x > x0 && x < x1)
+                        insertSorted(cuts, x);
+                }
+            cuts.push_back(x1);
+
+            float y0 = envelope(x0, active);
+            for (size_t k = 0; k + 1 < cuts.size(); k++)
+            {
+                float y1 = envelope(cuts[k + 1], active);
+                if (cuts[k + 1] > cuts[k])
+                    addPiece(cuts[k], cuts[k + 1], y0, y1);
+                y0 = y1;
+            }
+        }
+    }
+
+    // Point where the running area reaches half the total; within a piece
+    // y = y0 + s t, so the area up to t is y0 t + s t^2 / 2
+    float bisector() const
+    {
+        const float half = 0.5f * area;
+        float running = 0.0f;
+        for (size_t i = 0; i < pieces.size(); i++)
+        {
+            const LinearPiece &p = pieces[i];
+            const float dx = p.x1 - p.x0;
+            const float pieceArea = 0.5f * (p.y0 + p.y1) * dx;
+            if (running + pieceArea < half)
+            {
+                running += pieceArea;
+                continue;
+            }
+            const float need = half - running;
+            // Root of (s / 2) t^2 + y0 t - need = 0 in [0, dx], in the form
+            // that stays accurate as s -> 0
+            const float s = (p.y1 - p.y0) / dx;
+            float disc = p.y0 * p.y0 + 2.0f * s * need;
+            disc = disc > 0.0f ? disc : 0.0f;
+            const float denom = p.y0 + std::sqrt(disc);
+            float t = denom > 0.0f ? 2.0f * need / denom : 0.0f;
+            t = t < 0.0f ? 0.0f : (t > dx ? dx : t);
+            return p.x0 + t;
+        }
+        return hi;
+    }
+
+    float peakTolerance() const
+    {
+        return peak * 1e-6f;
+    }
+
+    float maximumEdge(bool smallest) const
+    {
+        const float level = peak - peakTolerance();
+        if (smallest)
+        {
+            for (size_t i = 0; i < pieces.size(); i++)
+            {
+                if (pieces[i].y0 >= level)
+                    return pieces[i].x0;
+                if (pieces[i].y1 >= level)
+                    return pieces[i].x1;
+            }
+        }
+        else
+        {
+            for (size_t i = pieces.size(); i-- > 0;)
+            {
+                if (pieces[i].y1 >= level)
+                    return pieces[i].x1;
+                if (pieces[i].y0 >= level)
+                    return pieces[i].x0;
+            }
+        }
+        return 0.5f * (lo + hi);
+    }
+
+    // Measure-weighted mean of the plateaus at the peak; when the peak is
+    // only reached at isolated points, the midpoint of the first and last
+    float meanOfMaximum() const
+    {
+        const float level = peak - peakTolerance();
+        float width = 0.0f, weighted = 0.0f;
+        for (size_t i = 0; i < pieces.size(); i++)
+        {
+            const LinearPiece &p = pieces[i];
+            if (p.y0 >= level && p.y1 >= level)
+            {
+                width += p.x1 - p.x0;
+                weighted += (p.x1 - p.x0) * 0.5f * (p.x0 + p.x1);
+            }
+        }
+        if (width > 0.0f)
+            return weighted / width;
+        return 0.5f * (maximumEdge(true) + maximumEdge(false));
+    }
+};
+
+// Peak, sum and index-weighted sum of mu[0 .. padded), one accumulator per
+// lane; compiled per ISA
+#define DEFUZZ_DEFINE_REDUCE(NAME, ATTR)                                                           \
+    ATTR inline void reduceSampled##NAME(const float *mu, size_t padded, float &peak, float &area, \
+                                          float &moment)                                           \
+    {                                                                                              \
+        float peaks[CACHE_LINE_FLOATS], areas[CACHE_LINE_FLOATS], moments[CACHE_LINE_FLOATS];      \
+        for (size_t j = 0; j < CACHE_LINE_FLOATS; j++)                                             \
+            peaks[j] = areas[j] = moments[j] = 0.0f;                                               \
+        for (size_t k = 0; k < padded; k += CACHE_LINE_FLOATS)                                     \
+            for (size_t j = 0; j < CACHE_LINE_FLOATS; j++)                                         \
+            {                                                                                      \
+                float m = mu[k + j];                                                               \
+                peaks[j] = m > peaks[j] ? m : peaks[j];                                            \
+                areas[j] += m;                                                                     \
+                moments[j] += m * (float)(int)(k + j);                                             \
+            }                                                                                      \
+        peak = area = moment = 0.0f;                                                               \
+        for (size_t j = 0; j < CACHE_LINE_FLOATS; j++)                                             \
+        {                                                                                          \
+            peak = peaks[j] > peak ? peaks[j] : peak;                                              \
+            area += areas[j];                                                                      \
+            moment += moments[j];                                                                  \
+        }                                                                                          \
+    }
+
+DEFUZZ_DEFINE_REDUCE(Default, )
+#ifdef FUZZY_X86
+DEFUZZ_DEFINE_REDUCE(Avx2, FUZZY_TARGET("avx2,fma"))
+DEFUZZ_DEFINE_REDUCE(Avx512, FUZZY_TARGET("avx512f,avx512dq"))
+#endif
+
+#undef DEFUZZ_DEFINE_REDUCE
+
+inline void reduceSampled(const float *mu, size_t padded, float &peak, float &area, float &moment)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        reduceSampledAvx512(mu, padded, peak, area, moment);
+        return;
+    case SIMD_AVX2:
+        reduceSampledAvx2(mu, padded, peak, area, moment);
+        return;
+    default:
+        break;
+    }
+#endif
+    reduceSampledDefault(mu, padded, peak, area, moment);
+}
+
+// Sampled defuzzification of mu over the grid x_k = lo + k * step; mu holds
+// paddedCount<float>(n) samples, zero past n. `fallback` is returned when
+// the aggregated set is empty.
+inline float defuzzifySampled(DefuzzMethod method, const float *mu, size_t n, float lo, float step, float fallback)
+{
+    float peak, area, moment;
+    reduceSampled(mu, paddedCount<float>(n), peak, area, moment);
+    if (peak <= 0.0f)
+        return fallback;
+
+    switch (method)
+    {
+    case DEFUZZ_CENTROID:
+        return lo + step * (moment / area);
+    case DEFUZZ_BISECTOR:
+    {
+        float half = 0.5f * area, running = 0.0f;
+        for (size_t k = 0; k < n; k++)
+        {
+            running += mu[k];
+            if (running >= half)
+                return lo + step * (float)k;
+        }
+        return lo + step * (float)(n - 1);
+    }
+    default:
+    {
+        size_t first = n, lastPeak = 0, count = 0, sum = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            if (mu[k] == peak)
+            {
+                first = first < k ? first : k;
+                lastPeak = k;
+                count++;
+                sum += k;
+            }
+        }
+        if (method == DEFUZZ_SOM)
+            return lo + step * (float)first;
+        if (method == DEFUZZ_LOM)
+            return lo + step * (float)lastPeak;
+        return lo + step * ((float)sum / (float)count);
+    }
+    }
+}
+
+#endif // DEFUZZIFY_H
@@ -0,0 +1,101 @@
+#ifndef FUZZY_CLOSURE_H
+#define FUZZY_CLOSURE_H
+
+// Max-min transitive closure of a square fuzzy relation, and the crisp
+// equivalence classes of its alpha-cuts.
+//
+// Repeated squaring R <- R u (R o R) doubles the path length covered on each
+// step, so an n x n relation converges after at most ceil(log2 n) squarings.
+// The union step also checks whether anything grew; as soon as R o R adds
+// nothing (R o R <= R, i.e. R is already transitive) the loop stops.
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "fuzzy_composition.h"
+#include "fuzzy_relation.h"
+#include "thread_pool.h"
+
+// R <- max(R, S) over the given rows; returns whether any entry increased
+template <typename T>
+bool unionRowsChanged(FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, size_t rowLo, size_t rowHi)
+{
+    bool changed = false;
+    for (size_t i = rowLo; i < rowHi; i++)
+    {
+        T *r = R.row(i);
+        const T *s = S.row(i);
+        for (size_t j = 0; j < R.cols(); j++)
+        {
+            changed |= s[j] > r[j];
+            r[j] = s[j] > r[j] ? s[j] : r[j];
+        }
+    }
+    return changed;
+}
+
+// Writes the max-min transitive closure of R into `closure`, using `scratch`
+// as the second buffer; both are reshaped once and reused across squarings,
+// so callers that keep them around pay no allocation on later calls.
+// Returns the number of squarings performed.
+template <typename T>
+size_t transitiveClosureInto(const FuzzyRelationT<T> &R, FuzzyRelationT<T> &closure, FuzzyRelationT<T> &scratch,
+                             ThreadPool &pool = defaultThreadPool())
+{
+    const size_t n = R.rows();
+    closure.resize(n, n);
+    scratch.resize(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            closure(i, j) = R(i, j);
+
+    const size_t rowBlock = 64;
+    size_t squarings = 0;
+    for (;;)
+    {
+        composeRelations<IntersectionOp>(closure.view(), closure.view(), scratch.view(), pool);
+        squarings++;
+
+        std::atomic<bool> changed(false);
+        pool.parallelFor(0, n, rowBlock, [&](size_t lo, size_t hi)
+                         {
+            if (unionRowsChanged(closure, scratch, lo, hi))
+                changed = true; });
+        if (!changed)
+            break;
+    }
+    return squarings;
+}
+
+template <typename T>
+FuzzyRelationT<T> transitiveClosure(const FuzzyRelationT<T> &R)
+{
+    FuzzyRelationT<T> closure, scratch;
+    transitiveClosureInto(R, closure, scratch);
+    return closure;
+}
+
+// Labels each element with its class in the alpha-cut of a max-min
+// transitive similarity relation (reflexive, symmetric, transitive), where
+// the cut is a crisp equivalence relation. Returns the number of classes.
+template <typename T>
+size_t equivalenceClasses(const FuzzyRelationT<T> &closure, T alpha, std::vector<int> &labels)
+{
+    const size_t n = closure.rows();
+    labels.assign(n, -1);
+    size_t classes = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (labels[i] != -1)
+            continue;
+        const T *row = closure.row(i);
+        for (size_t j = i; j < n; j++)
+            if (labels[j] == -1 && (j == i || row[j] >= alpha))
+                labels[j] = (int)classes;
+        classes++;
+    }
+    return classes;
+}
+
+#endif // FUZZY_CLOSURE_H
@@ -0,0 +1,309 @@
+#ifndef FUZZY_COMPOSITION_H
+#define FUZZY_COMPOSITION_H
+
+// Sup-T composition of fuzzy relations:
+//
+//   (R o S)(i, j) = max_k  T(R(i, k), S(k, j))
+//
+// with T = min (max-min), T = product (max-product) or any t-norm policy
+// from fuzzy_tnorm.h. The engine is laid out like a GEMM: rows of the
+// result are split into blocks across the thread pool, and within a block
+// the k and j dimensions are tiled so the current S tile stays in L2 while
+// a strip of each result row is kept in SIMD registers and updated with one
+// broadcast R(i, k) per k.
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "fuzzy_kernels.h"
+#include "fuzzy_relation.h"
+#include "fuzzy_tnorm.h"
+#include "thread_pool.h"
+
+// Tile sizes in elements. Defaults keep a kBlock x colBlock float tile of S
+// (128 KB) in L2 and hand out rowBlock rows of the result per task.
+struct CompositionBlocking
+{
+    size_t rowBlock;
+    size_t kBlock;
+    size_t colBlock;
+
+    CompositionBlocking() : rowBlock(16), kBlock(128), colBlock(256) {}
+};
+
+// Micro-kernel: c[j] = max(c[j], max_k T(a[k], b[k * bStride + j])) for
+// j < n, k < kCount.
+template <typename Op, typename T>
+void composeRowScalar(const T *a, size_t kCount, const T *b, size_t bStride, T *c, size_t n)
+{
+    for (size_t k = 0; k < kCount; ++k)
+    {
+        const T ak = a[k];
+        if (ak == T(0)) // T(0, x) = 0 never raises the maximum
+            continue;
+        const T *bk = b + k * bStride;
+        for (size_t j = 0; j < n; ++j)
+            c[j] = UnionOp::scalar(c[j], Op::scalar(ak, bk[j]));
+    }
+}
+
+#ifdef FUZZY_X86
+
+#define FUZZY_DEFINE_COMPOSE_ROW(NAME, ISA, TRAITS)                                      \
+    template <typename Op, typename T>                                                   \
+    FUZZY_TARGET(ISA)                                                                    \
+    void composeRow##NAME(const T *a, size_t kCount, const T *b, size_t bStride, T *c, size_t n) \
+    {                                                                                    \
+        typedef TRAITS<T> I;                                                             \
+        typedef typename I::V V;                                                         \
+        const size_t w = I::width;                                                       \
+        size_t j = 0;                                                                    \
+        for (; j + 4 * w <= n; j += 4 * w)                                               \
+        {                                                                                \
+            V c0 = I::load(c + j), c1 = I::load(c + j + w);                              \
+            V c2 = I::load(c + j + 2 * w), c3 = I::load(c + j + 3 * w);                  \
+            const T *bk = b + j;                                                         \
+            for (size_t k = 0; k < kCount; ++k, bk += bStride)                           \
+            {                                                                            \
+                V ak = I::broadcast(a[k]);                                               \
+                c0 = I::apply(UnionOp(), c0, I::apply(Op(), ak, I::load(bk)));           \
+                c1 = I::apply(UnionOp(), c1, I::apply(Op(), ak, I::load(bk + w)));       \
+                c2 = I::apply(UnionOp(), c2, I::apply(Op(), ak, I::load(bk + 2 * w)));   \
+                c3 = I::apply(UnionOp(), c3, I::apply(Op(), ak, I::load(bk + 3 * w)));   \
+            }                                                                            \
+            I::store(c + j, c0);                                                         \
+            I::store(c + j + w, c1);                                                     \
+            I::store(c + j + 2 * w, c2);                                                 \
+            I::store(c + j + 3 * w, c3);                                                 \
+        }                                                                                \
+        for (; j + w <= n; j += w)                                                       \
+        {                                                                                \
+            V c0 = I::load(c + j);                                                       \
+            const T *bk = b + j;                                                         \
+            for (size_t k = 0; k < kCount; ++k, bk += bStride)                           \
+                c0 = I::apply(UnionOp(), c0, I::apply(Op(), I::broadcast(a[k]), I::load(bk))); \
+            I::store(c + j, c0);                                                         \
+        }                                                                                \
+        if (j < n)                                                                       \
+            composeRowScalar<Op>(a, kCount, b + j, bStride, c + j, n - j);               \
+    }
+
+FUZZY_DEFINE_COMPOSE_ROW(Sse2, "sse2", Sse2Ops)
+FUZZY_DEFINE_COMPOSE_ROW(Avx2, "avx2", Avx2Ops)
+FUZZY_DEFINE_COMPOSE_ROW(Avx512, "avx512f", Avx512Ops)
+
+#undef FUZZY_DEFINE_COMPOSE_ROW
+
+#endif // FUZZY_X86
+
+// Any other t-norm (see fuzzy_tnorm.h) has no hand-written SIMD form. Its
+// scalar expression is inlined into a strip-mined loop instead, which GCC
+// vectorizes for whichever target the loop is compiled for.
+static const size_t COMPOSE_STRIP = 64;
+
+#define FUZZY_DEFINE_GENERIC_COMPOSE_ROW(NAME, ATTR)                                     \
+    template <typename Op, typename T>                                                   \
+    ATTR void composeRowGeneric##NAME(const T *a, size_t kCount, const T *b, size_t bStride, \
+                                      T *__restrict c, size_t n)                         \
+    {                                                                                    \
+        for (size_t k = 0; k < kCount; ++k)                                              \
+        {                                                                                \
+            const T ak = a[k];                                                           \
+            const T *bk = b + k * bStride;                                               \
+            size_t j = 0;                                                                \
+            for (; j + COMPOSE_STRIP <= n; j += COMPOSE_STRIP)                           \
+                for (size_t s = 0; s < COMPOSE_STRIP; ++s)                               \
+                    c[j + s] = UnionOp::scalar(c[j + s], Op::scalar(ak, bk[j + s]));     \
+            for (; j < n; ++j)                                                           \
+                c[j] = UnionOp::scalar(c[j], Op::scalar(ak, bk[j]));                     \
+        }                                                                                \
+    }
+
+FUZZY_DEFINE_GENERIC_COMPOSE_ROW(Default, )
+#ifdef FUZZY_X86
+FUZZY_DEFINE_GENERIC_COMPOSE_ROW(Avx2, FUZZY_TARGET("avx2"))
+FUZZY_DEFINE_GENERIC_COMPOSE_ROW(Avx512, FUZZY_TARGET("avx512f"))
+#endif
+
+#undef FUZZY_DEFINE_GENERIC_COMPOSE_ROW
+
+// Picks the row kernel once per composition rather than once per tile
+template <typename Op, typename T>
+struct ComposeRowKernel
+{
+    typedef void (*Fn)(const T *, size_t, const T *, size_t, T *, size_t);
+
+    static Fn select()
+    {
+#ifdef FUZZY_X86
+        switch (simdLevel())
+        {
+        case SIMD_AVX512:
+            return &composeRowGenericAvx512<Op, T>;
+        case SIMD_AVX2:
+            return &composeRowGenericAvx2<Op, T>;
+        case SIMD_SCALAR:
+            return &composeRowScalar<Op, T>;
+        default:
+            break;
+        }
+#endif
+        return &composeRowGenericDefault<Op, T>;
+    }
+};
+
+// min and product have intrinsic micro-kernels
+template <typename Op, typename T>
+struct IntrinsicComposeRowKernel
+{
+    typedef void (*Fn)(const T *, size_t, const T *, size_t, T *, size_t);
+
+    static Fn select()
+    {
+#ifdef FUZZY_X86
+        switch (simdLevel())
+        {
+        case SIMD_AVX512:
+            return &composeRowAvx512<Op, T>;
+        case SIMD_AVX2:
+            return &composeRowAvx2<Op, T>;
+        case SIMD_SSE2:
+            return &composeRowSse2<Op, T>;
+        default:
+            break;
+        }
+#endif
+        return &composeRowScalar<Op, T>;
+    }
+};
+
+template <typename T>
+struct ComposeRowKernel<IntersectionOp, T> : IntrinsicComposeRowKernel<IntersectionOp, T>
+{
+};
+
+template <typename T>
+struct ComposeRowKernel<ProductOp, T> : IntrinsicComposeRowKernel<ProductOp, T>
+{
+};
+
+template <typename Op, typename T>
+typename ComposeRowKernel<Op, T>::Fn selectComposeRow()
+{
+    return ComposeRowKernel<Op, T>::select();
+}
+
+// C = A o B with T = Op, any tag with a static scalar(a, b). A is m x p,
+// B is p x n, C is m x n and must not overlap A or B. Membership degrees
+// are assumed to lie in [0, 1], so the running maximum starts at 0.
+template <typename Op, typename A, typename B, typename T>
+void composeRelations(FuzzyRelationView<A> R, FuzzyRelationView<B> S, FuzzyRelationView<T> C,
+                      ThreadPool &pool = defaultThreadPool(),
+                      const CompositionBlocking &blocking = CompositionBlocking())
+{
+    typename ComposeRowKernel<Op, T>::Fn composeRow = selectComposeRow<Op, T>();
+    const size_t inner = R.cols;
+
+    pool.parallelFor(0, C.rows, blocking.rowBlock, [&](size_t rowLo, size_t rowHi)
+                     {
+        for (size_t i = rowLo; i < rowHi; i++)
+            for (size_t j = 0; j < C.cols; j++)
+                C(i, j) = T(0);
+
+        for (size_t j0 = 0; j0 < C.cols; j0 += blocking.colBlock)
+        {
+            size_t nCols = std::min(blocking.colBlock, C.cols - j0);
+            for (size_t k0 = 0; k0 < inner; k0 += blocking.kBlock)
+            {
+                size_t nK = std::min(blocking.kBlock, inner - k0);
+                for (size_t i = rowLo; i < rowHi; i++)
+                    composeRow(R.row(i) + k0, nK, S.row(k0) + j0, S.stride, C.row(i) + j0, nCols);
+            }
+        } });
+}
+
+template <typename T>
+void maxMinCompositionInto(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, FuzzyRelationT<T> &out,
+                           ThreadPool &pool = defaultThreadPool())
+{
+    out.resize(R.rows(), S.cols());
+    composeRelations<IntersectionOp>(R.view(), S.view(), out.view(), pool);
+}
+
+template <typename T>
+void maxProductCompositionInto(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, FuzzyRelationT<T> &out,
+                               ThreadPool &pool = defaultThreadPool())
+{
+    out.resize(R.rows(), S.cols());
+    composeRelations<ProductOp>(R.view(), S.view(), out.view(), pool);
+}
+
+template <typename T>
+FuzzyRelationT<T> maxMinComposition(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S)
+{
+    FuzzyRelationT<T> result(R.rows(), S.cols());
+    maxMinCompositionInto(R, S, result);
+    return result;
+}
+
+template <typename T>
+FuzzyRelationT<T> maxProductComposition(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S)
+{
+    FuzzyRelationT<T> result(R.rows(), S.cols());
+    maxProductCompositionInto(R, S, result);
+    return result;
+}
+
+// Fuzzy set (length R.rows) composed with a relation, written to out[0, R.cols).
+// Streams R row by row instead of walking it column-wise.
+template <typename Op, typename A, typename T>
+void composeSet(const T *set, FuzzyRelationView<A> R, T *out)
+{
+    typename ComposeRowKernel<Op, T>::Fn composeRow = selectComposeRow<Op, T>();
+    const CompositionBlocking blocking;
+    for (size_t j = 0; j < R.cols; j++)
+        out[j] = T(0);
+    for (size_t j0 = 0; j0 < R.cols; j0 += blocking.colBlock)
+        composeRow(set, R.rows, R.row(0) + j0, R.stride, out + j0, std::min(blocking.colBlock, R.cols - j0));
+}
+
+// Batched set composition: each row of `sets` (N x m) is one query fuzzy set,
+// and row q of `out` (N x n) receives sets[q] o R. All queries share one tiled
+// pass, so every R tile is loaded once per block of queries rather than once
+// per query; larger batches amortise R further.
+template <typename Op, typename T>
+void composeSetBatch(const FuzzyRelationT<T> &sets, const FuzzyRelationT<T> &R, FuzzyRelationT<T> &out,
+                     ThreadPool &pool = defaultThreadPool())
+{
+    CompositionBlocking blocking;
+    blocking.rowBlock = 64;
+    out.resize(sets.rows(), R.cols());
+    composeRelations<Op>(sets.view(), R.view(), out.view(), pool, blocking);
+}
+
+template <typename T>
+void maxMinCompositionBatch(const FuzzyRelationT<T> &sets, const FuzzyRelationT<T> &R, FuzzyRelationT<T> &out,
+                            ThreadPool &pool = defaultThreadPool())
+{
+    composeSetBatch<IntersectionOp>(sets, R, out, pool);
+}
+
+// Sup-T composition (R o S)(i, j) = max_k T(R(i, k), S(k, j))
+template <typename TN, typename T>
+void tnormCompositionInto(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, FuzzyRelationT<T> &out,
+                          ThreadPool &pool = defaultThreadPool())
+{
+    out.resize(R.rows(), S.cols());
+    composeRelations<typename TN::Op>(R.view(), S.view(), out.view(), pool);
+}
+
+template <typename TN, typename T>
+FuzzyRelationT<T> tnormComposition(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S)
+{
+    FuzzyRelationT<T> result(R.rows(), S.cols());
+    tnormCompositionInto<TN>(R, S, result);
+    return result;
+}
+
+#endif // FUZZY_COMPOSITION_H
@@ -0,0 +1,271 @@
+#ifndef FUZZY_EXPR_H
+#define FUZZY_EXPR_H
+
+// Lazy fuzzy set expressions. Building `~(lazy(A) | (lazy(B) & lazy(C)))`
+// only records the operator tree; evaluate()/assign() then walk all inputs
+// once and write the result in a single pass, with no temporary sets.
+//
+//   |  union (max)            &  intersection (min)       ~  complement (1 - x)
+//   algebraicProduct, probabilisticSum, boundedDifference, boundedSum
+//   tnorm<TN>(l, r), tconorm<TN>(l, r) for any policy from fuzzy_tnorm.h
+//   fuzzyApply<Op>(l, r) for any Op with a static scalar(a, b)
+
+#include <cstddef>
+#include <vector>
+
+#include "fuzzy_kernels.h"
+#include "fuzzy_relation.h"
+#include "fuzzy_tnorm.h"
+
+// Named forms of the common dual operators; any policy from fuzzy_tnorm.h
+// can be used through tnorm<TN>() / tconorm<TN>()
+typedef TConormOp<ProductTNorm> ProbabilisticSumOp;
+typedef TNormOp<LukasiewiczTNorm> BoundedDifferenceOp;
+typedef TConormOp<LukasiewiczTNorm> BoundedSumOp;
+
+template <typename E>
+struct FuzzyExpr
+{
+    const E &self() const { return static_cast<const E &>(*this); }
+};
+
+// Leaf: a non-owning view of an existing membership array
+template <typename T>
+struct FuzzySetRef : FuzzyExpr<FuzzySetRef<T> >
+{
+    typedef T value_type;
+    const T *data;
+    size_t n;
+
+    FuzzySetRef(const T *data, size_t n) : data(data), n(n) {}
+    T operator[](size_t i) const { return data[i]; }
+    size_t size() const { return n; }
+};
+
+// Leaf: the same membership degree everywhere (e.g. clipping at an alpha level)
+template <typename T>
+struct FuzzyConstant : FuzzyExpr<FuzzyConstant<T> >
+{
+    typedef T value_type;
+    T value;
+    size_t n;
+
+    FuzzyConstant(T value, size_t n) : value(value), n(n) {}
+    T operator[](size_t) const { return value; }
+    size_t size() const { return n; }
+};
+
+// Children are held by value: leaves are a pointer and a size, so copying
+// them is cheap and sub-expressions built from temporaries never dangle.
+template <typename Op, typename L, typename R>
+struct BinaryExpr : FuzzyExpr<BinaryExpr<Op, L, R> >
+{
+    typedef typename L::value_type value_type;
+    L l;
+    R r;
+
+    BinaryExpr(const L &l, const R &r) : l(l), r(r) {}
+    value_type operator[](size_t i) const { return Op::scalar(l[i], r[i]); }
+    size_t size() const { return l.size(); }
+};
+
+template <typename Op, typename E>
+struct UnaryExpr : FuzzyExpr<UnaryExpr<Op, E> >
+{
+    typedef typename E::value_type value_type;
+    E e;
+
+    explicit UnaryExpr(const E &e) : e(e) {}
+    value_type operator[](size_t i) const { return Op::scalar(e[i]); }
+    size_t size() const { return e.size(); }
+};
+
+template <typename T>
+FuzzySetRef<T> lazy(const std::vector<T> &A)
+{
+    return FuzzySetRef<T>(A.data(), A.size());
+}
+
+template <typename T>
+FuzzySetRef<T> lazy(const T *data, size_t n)
+{
+    return FuzzySetRef<T>(data, n);
+}
+
+template <typename Op, typename L, typename R>
+BinaryExpr<Op, L, R> fuzzyApply(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return BinaryExpr<Op, L, R>(l.self(), r.self());
+}
+
+template <typename L, typename R>
+BinaryExpr<UnionOp, L, R> operator|(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<UnionOp>(l, r);
+}
+
+template <typename L, typename R>
+BinaryExpr<IntersectionOp, L, R> operator&(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<IntersectionOp>(l, r);
+}
+
+template <typename E>
+UnaryExpr<ComplementOp, E> operator~(const FuzzyExpr<E> &e)
+{
+    return UnaryExpr<ComplementOp, E>(e.self());
+}
+
+template <typename L, typename R>
+BinaryExpr<ProductOp, L, R> algebraicProduct(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<ProductOp>(l, r);
+}
+
+template <typename L, typename R>
+BinaryExpr<ProbabilisticSumOp, L, R> probabilisticSum(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<ProbabilisticSumOp>(l, r);
+}
+
+template <typename L, typename R>
+BinaryExpr<BoundedDifferenceOp, L, R> boundedDifference(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<BoundedDifferenceOp>(l, r);
+}
+
+template <typename L, typename R>
+BinaryExpr<BoundedSumOp, L, R> boundedSum(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<BoundedSumOp>(l, r);
+}
+
+// The fused loop is strip-mined into fixed-size blocks: a constant trip count
+// into a local block buffer, which nothing else can point to, is what lets
+// GCC vectorize the whole inlined operator tree at -O2. The block is copied
+// to `out` afterwards, so `out` may overlap the inputs. The ISA variants only
+// differ in the target the same loop is compiled for.
+static const size_t FUZZY_EXPR_BLOCK = 256;
+
+#define FUZZY_DEFINE_EXPR_LOOP(NAME, ATTR)                                               \
+    template <typename E>                                                                \
+    ATTR void evaluate##NAME(const E &e, typename E::value_type *out, size_t n)          \
+    {                                                                                    \
+        typename E::value_type block[FUZZY_EXPR_BLOCK];                                  \
+        size_t i = 0;                                                                    \
+        for (; i + FUZZY_EXPR_BLOCK <= n; i += FUZZY_EXPR_BLOCK)                         \
+        {                                                                                \
+            for (size_t j = 0; j < FUZZY_EXPR_BLOCK; ++j)                                \
+                block[j] = e[i + j];                                                     \
+            for (size_t j = 0; j < FUZZY_EXPR_BLOCK; ++j)                                \
+                out[i + j] = block[j];                                                   \
+        }                                                                                \
+        for (; i < n; ++i)                                                               \
+            out[i] = e[i];                                                               \
+    }
+
+FUZZY_DEFINE_EXPR_LOOP(Default, )
+#ifdef FUZZY_X86
+FUZZY_DEFINE_EXPR_LOOP(Avx2, FUZZY_TARGET("avx2"))
+FUZZY_DEFINE_EXPR_LOOP(Avx512, FUZZY_TARGET("avx512f"))
+#endif
+
+#undef FUZZY_DEFINE_EXPR_LOOP
+
+// Writes the expression into out[0, e.size()). `out` may be one of the
+// expression's own inputs (every element is read before it is written).
+template <typename E>
+void evaluate(const FuzzyExpr<E> &expr, typename E::value_type *out)
+{
+    const E &e = expr.self();
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        evaluateAvx512(e, out, e.size());
+        return;
+    case SIMD_AVX2:
+        evaluateAvx2(e, out, e.size());
+        return;
+    default:
+        break;
+    }
+#endif
+    evaluateDefault(e, out, e.size());
+}
+
+template <typename E>
+void assign(std::vector<typename E::value_type> &out, const FuzzyExpr<E> &expr)
+{
+    out.resize(expr.self().size());
+    evaluate(expr, out.data());
+}
+
+template <typename E>
+std::vector<typename E::value_type> materialize(const FuzzyExpr<E> &expr)
+{
+    std::vector<typename E::value_type> out;
+    assign(out, expr);
+    return out;
+}
+
+// Elementwise intersection (t-norm) and union (t-conorm); out may alias a or b
+template <typename TN, typename T>
+void tnormIntersection(const T *a, const T *b, T *out, size_t n)
+{
+    evaluate(fuzzyApply<typename TN::Op>(lazy(a, n), lazy(b, n)), out);
+}
+
+template <typename TN, typename T>
+void tnormUnion(const T *a, const T *b, T *out, size_t n)
+{
+    evaluate(fuzzyApply<typename TN::DualOp>(lazy(a, n), lazy(b, n)), out);
+}
+
+template <typename TN, typename T>
+std::vector<T> tnormIntersection(const std::vector<T> &A, const std::vector<T> &B)
+{
+    std::vector<T> result(A.size());
+    tnormIntersection<TN>(A.data(), B.data(), result.data(), A.size());
+    return result;
+}
+
+template <typename TN, typename T>
+std::vector<T> tnormUnion(const std::vector<T> &A, const std::vector<T> &B)
+{
+    std::vector<T> result(A.size());
+    tnormUnion<TN>(A.data(), B.data(), result.data(), A.size());
+    return result;
+}
+
+// Lazy-expression forms, fusable with the |, & and ~ operators above
+template <typename TN, typename L, typename R>
+BinaryExpr<typename TN::Op, L, R> tnorm(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<typename TN::Op>(l, r);
+}
+
+template <typename TN, typename L, typename R>
+BinaryExpr<typename TN::DualOp, L, R> tconorm(const FuzzyExpr<L> &l, const FuzzyExpr<R> &r)
+{
+    return fuzzyApply<typename TN::DualOp>(l, r);
+}
+
+// Elementwise relation intersection / union under a t-norm policy
+template <typename TN, typename T>
+void tnormRelationIntersection(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, FuzzyRelationT<T> &out)
+{
+    out.resize(R.rows(), R.cols());
+    for (size_t i = 0; i < R.rows(); i++)
+        tnormIntersection<TN>(R.row(i), S.row(i), out.row(i), R.cols());
+}
+
+template <typename TN, typename T>
+void tnormRelationUnion(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, FuzzyRelationT<T> &out)
+{
+    out.resize(R.rows(), R.cols());
+    for (size_t i = 0; i < R.rows(); i++)
+        tnormUnion<TN>(R.row(i), S.row(i), out.row(i), R.cols());
+}
+
+#endif // FUZZY_EXPR_H
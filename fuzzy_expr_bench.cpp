@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+
+#include "fuzzy_kernels.h"
+#include "fuzzy_expr.h"
+
+using namespace std;
+
+// Compares complement(union(A, intersection(B, C))) evaluated the
+// Assignment1.cpp way (one temporary set and one memory pass per operator)
+// against the fused expression-template version on 10^7 element sets.
+
+const size_t N = 10000000;
+const int REPEATS = 10;
+
+// Assignment1.cpp style: every operator returns a fresh vector
+vector<float> fuzzyUnion(const vector<float> &A, const vector<float> &B)
+{
+    vector<float> result;
+    fuzzyUnionInto(A, B, result);
+    return result;
+}
+
+vector<float> fuzzyIntersection(const vector<float> &A, const vector<float> &B)
+{
+    vector<float> result;
+    fuzzyIntersectionInto(A, B, result);
+    return result;
+}
+
+vector<float> fuzzyComplement(const vector<float> &A)
+{
+    vector<float> result;
+    fuzzyComplementInto(A, result);
+    return result;
+}
+
+template <typename F>
+double timeIt(F f)
+{
+    f(); // warm up (page faults, caches)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++)
+        f();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / REPEATS;
+}
+
+void report(const string &label, double seconds, double bytes)
+{
+    cout << left << setw(34) << label
+         << right << setw(9) << fixed << setprecision(2) << seconds * 1e3 << " ms"
+         << setw(9) << bytes / 1e6 << " MB moved"
+         << setw(9) << bytes / seconds / 1e9 << " GB/s" << endl;
+}
+
+int main()
+{
+    vector<float> A(N), B(N), C(N);
+    srand(42);
+    for (size_t i = 0; i < N; i++)
+    {
+        A[i] = (float)rand() / RAND_MAX;
+        B[i] = (float)rand() / RAND_MAX;
+        C[i] = (float)rand() / RAND_MAX;
+    }
+
+    cout << "Elements: " << N << ", SIMD: " << simdLevelName(simdLevel()) << endl;
+    cout << "Expression: complement(union(A, intersection(B, C)))" << endl;
+
+    const double setBytes = (double)N * sizeof(float);
+
+    // intersection (2 reads + 1 write) + union (2 + 1) + complement (1 + 1)
+    vector<float> eager;
+    double tEager = timeIt([&]()
+                           { eager = fuzzyComplement(fuzzyUnion(A, fuzzyIntersection(B, C))); });
+    report("eager, temporaries", tEager, 8 * setBytes);
+
+    vector<float> t1(N), t2(N);
+    double tBuffered = timeIt([&]()
+                              {
+        fuzzyIntersection(B.data(), C.data(), t1.data(), N);
+        fuzzyUnion(A.data(), t1.data(), t2.data(), N);
+        fuzzyComplement(t2.data(), t2.data(), N); });
+    report("eager, preallocated buffers", tBuffered, 8 * setBytes);
+
+    // three reads + one write
+    vector<float> fused(N);
+    double tFused = timeIt([&]()
+                           { evaluate(~(lazy(A) | (lazy(B) & lazy(C))), fused.data()); });
+    report("fused expression", tFused, 4 * setBytes);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < N; i++)
+        if (fused[i] != eager[i])
+            mismatches++;
+
+    cout << "Memory traffic saved: " << setprecision(0) << 4 * setBytes / 1e6 << " MB per evaluation ("
+         << setprecision(2) << tBuffered / tFused << "x faster than preallocated eager)" << endl;
+    cout << "Mismatched elements: " << mismatches << endl;
+
+    // t-norm / t-conorm chain: probabilistic sum of (A * B) and bounded difference of (B, C)
+    vector<float> p1(N), p2(N);
+    double tTnormEager = timeIt([&]()
+                                {
+        assign(p1, algebraicProduct(lazy(A), lazy(B)));
+        assign(p2, boundedDifference(lazy(B), lazy(C)));
+        assign(p1, probabilisticSum(lazy(p1), lazy(p2))); });
+    cout << endl
+         << "Expression: probabilisticSum(A * B, boundedDifference(B, C))" << endl;
+    report("one pass per operator", tTnormEager, 8 * setBytes);
+
+    double tTnormFused = timeIt([&]()
+                                { evaluate(probabilisticSum(algebraicProduct(lazy(A), lazy(B)),
+                                                            boundedDifference(lazy(B), lazy(C))),
+                                           fused.data()); });
+    report("fused expression", tTnormFused, 4 * setBytes);
+
+    return 0;
+}
@@ -0,0 +1,880 @@
+#ifndef FUZZY_INFERENCE_H
+#define FUZZY_INFERENCE_H
+
+// Mamdani / Sugeno fuzzy inference over a rule base loaded from text.
+//
+//   # comment
+//   method mamdani              # or sugeno
+//   and min                     # min, product, lukasiewicz, drastic, einstein;
+//                               # "or" uses the dual t-conorm
+//   implication min             # min (clip) or product (scale), Mamdani only
+//   defuzzify centroid          # centroid, bisector, mom, som, lom
+//   resolution 101              # output samples per output variable when a
+//                               # term is not piecewise linear
+//
+//   input temperature 0 45
+//   term cold trapezoidal 0 0 10 20
+//   ...
+//   output fan 0 100
+//   term low triangular 0 0 40        # Mamdani: any membership.h shape
+//   term fast linear 10 0.5 0.2       # Sugeno: constant k or linear k0 k1..kn
+//
+//   rule if temperature is cold and humidity is not high then fan is low
+//   rule if temperature is hot or humidity is high then fan is high weight 0.5
+//
+// Loading compiles the rule base into flat arrays: every input term is one
+// MembershipFunction in a single array, rule antecedents are term indices
+// in CSR form, and each Mamdani output term is pre-sampled on the output
+// grid. One evaluation then fuzzifies every term once, fires the rules,
+// keeps one firing level per output term (max aggregation commutes with min
+// and product implication, so rules sharing a consequent collapse), and
+// defuzzifies the aggregated set. When every output term is triangular,
+// trapezoidal or constant the aggregated set is a polyline and is
+// defuzzified exactly (defuzzify.h); otherwise the pre-sampled terms are
+// aggregated and defuzzified over `resolution` samples. The controller is
+// immutable after loading; evaluate() takes an InferenceScratch so several
+// threads can share one controller.
+
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "defuzzify.h"
+#include "fuzzy_tnorm.h"
+#include "membership.h"
+
+enum InferenceMethod
+{
+    INFERENCE_MAMDANI,
+    INFERENCE_SUGENO
+};
+
+enum TNormKind
+{
+    TNORM_MIN,
+    TNORM_PRODUCT,
+    TNORM_LUKASIEWICZ,
+    TNORM_DRASTIC,
+    TNORM_EINSTEIN
+};
+
+enum ImplicationKind
+{
+    IMPLICATION_MIN,
+    IMPLICATION_PRODUCT
+};
+
+struct FuzzyTerm
+{
+    std::string name;
+    MembershipFunction mf;
+    bool linear;               // Sugeno output given by coeffs instead of mf
+    std::vector<float> coeffs; // Sugeno outputs: k0 + k1 x1 + ... + kn xn
+
+    FuzzyTerm() : linear(false) {}
+};
+
+struct FuzzyVariable
+{
+    std::string name;
+    float lo, hi;
+    std::vector<FuzzyTerm> terms;
+
+    int termIndex(const std::string &term) const
+    {
+        for (size_t t = 0; t < terms.size(); t++)
+            if (terms[t].name == term)
+                return (int)t;
+        return -1;
+    }
+};
+
+// Samples per block in FuzzyController::evaluateBatch
+static const size_t INFERENCE_BLOCK = 256;
+
+// Per-thread working memory for FuzzyController::evaluate / evaluateBatch;
+// sized on first use and reused afterwards
+struct InferenceScratch
+{
+    std::vector<float> degrees; // one per input term
+    std::vector<float> levels;  // firing level per output term (Mamdani)
+    std::vector<float> num, den; // weighted sums per output (Sugeno)
+    AlignedBuffer<float> aggregate;
+    PiecewiseDefuzzifier piecewise; // piecewise-linear output terms
+
+    // Batch mode, one INFERENCE_BLOCK row per input / term / output
+    AlignedBuffer<float> blockInputs, blockDegrees, blockLevels, blockFiring, blockValue, blockNum, blockDen;
+};
+
+// Output sets are stored padded to whole cache lines (paddedCount) with zero
+// samples past the end, so the sample loops below run over full lines of
+// CACHE_LINE_FLOATS.
+
+// agg = max(agg, min(mu, level)) over `padded` samples
+inline void aggregateClipped(float *__restrict agg, const float *mu, float level, size_t padded)
+{
+    for (size_t k = 0; k < padded; k += CACHE_LINE_FLOATS)
+        for (size_t j = 0; j < CACHE_LINE_FLOATS; j++)
+        {
+            float clipped = mu[k + j] < level ? mu[k + j] : level;
+            agg[k + j] = clipped > agg[k + j] ? clipped : agg[k + j];
+        }
+}
+
+// agg = max(agg, mu * level) over `padded` samples
+inline void aggregateScaled(float *__restrict agg, const float *mu, float level, size_t padded)
+{
+    for (size_t k = 0; k < padded; k += CACHE_LINE_FLOATS)
+        for (size_t j = 0; j < CACHE_LINE_FLOATS; j++)
+        {
+            float scaled = mu[k + j] * level;
+            agg[k + j] = scaled > agg[k + j] ? scaled : agg[k + j];
+        }
+}
+
+class FuzzyController
+{
+public:
+    FuzzyController()
+        : method(INFERENCE_MAMDANI), andKind(TNORM_MIN), implication(IMPLICATION_MIN),
+          defuzzMethod(DEFUZZ_CENTROID), resolution(101), currentIsOutput(false), stride(0),
+          piecewise(false) {}
+
+    // Parses and compiles a rule base; on failure returns false with a
+    // message naming the offending line, and leaves the controller empty
+    bool load(std::istream &in, std::string &error)
+    {
+        *this = FuzzyController();
+        std::string line;
+        int lineNo = 0;
+        while (std::getline(in, line))
+        {
+            lineNo++;
+            size_t hash = line.find('#');
+            if (hash != std::string::npos)
+                line.erase(hash);
+            std::istringstream words(line);
+            std::vector<std::string> tokens;
+            std::string word;
+            while (words >> word)
+                tokens.push_back(word);
+            if (tokens.empty())
+                continue;
+            if (!parseLine(tokens, error))
+            {
+                std::ostringstream msg;
+                msg << "line " << lineNo << ": " << error;
+                error = msg.str();
+                *this = FuzzyController();
+                return false;
+            }
+        }
+        if (!compile(error))
+        {
+            *this = FuzzyController();
+            return false;
+        }
+        return true;
+    }
+
+    bool loadString(const std::string &text, std::string &error)
+    {
+        std::istringstream in(text);
+        return load(in, error);
+    }
+
+    bool loadFile(const std::string &path, std::string &error)
+    {
+        std::ifstream in(path.c_str());
+        if (!in)
+        {
+            error = "cannot open " + path;
+            return false;
+        }
+        return load(in, error);
+    }
+
+    size_t inputCount() const { return inputs.size(); }
+    size_t outputCount() const { return outputs.size(); }
+    size_t ruleCount() const { return ruleWeight.size(); }
+    const FuzzyVariable &input(size_t i) const { return inputs[i]; }
+    const FuzzyVariable &output(size_t i) const { return outputs[i]; }
+
+    // outputs[o] for every output variable from inputs[i] for every input
+    void evaluate(const float *in, float *out, InferenceScratch &scratch) const
+    {
+        switch (andKind)
+        {
+        case TNORM_PRODUCT:
+            evaluateWith<ProductTNorm>(in, out, scratch);
+            break;
+        case TNORM_LUKASIEWICZ:
+            evaluateWith<LukasiewiczTNorm>(in, out, scratch);
+            break;
+        case TNORM_DRASTIC:
+            evaluateWith<DrasticTNorm>(in, out, scratch);
+            break;
+        case TNORM_EINSTEIN:
+            evaluateWith<HamacherTNorm<2> >(in, out, scratch);
+            break;
+        default:
+            evaluateWith<MinTNorm>(in, out, scratch);
+            break;
+        }
+    }
+
+    // Single-threaded convenience form using an internal scratch
+    void evaluate(const float *in, float *out)
+    {
+        evaluate(in, out, ownScratch);
+    }
+
+    // Batch form over SoA columns: in[i][k] is input i of sample k, and
+    // out[o][k] receives output o. Samples go through in blocks of
+    // INFERENCE_BLOCK: each term's MF runs over a whole input column, rules
+    // fire across the block, and only aggregation / defuzzification (which
+    // loops over the output grid) is per sample. Matches evaluate() up to
+    // rounding: the SIMD MF loops may contract multiply-adds.
+    void evaluateBatch(const float *const *in, float *const *out, size_t n, InferenceScratch &scratch) const
+    {
+        switch (andKind)
+        {
+        case TNORM_PRODUCT:
+            evaluateBatchWith<ProductTNorm>(in, out, n, scratch);
+            break;
+        case TNORM_LUKASIEWICZ:
+            evaluateBatchWith<LukasiewiczTNorm>(in, out, n, scratch);
+            break;
+        case TNORM_DRASTIC:
+            evaluateBatchWith<DrasticTNorm>(in, out, n, scratch);
+            break;
+        case TNORM_EINSTEIN:
+            evaluateBatchWith<HamacherTNorm<2> >(in, out, n, scratch);
+            break;
+        default:
+            evaluateBatchWith<MinTNorm>(in, out, n, scratch);
+            break;
+        }
+    }
+
+private:
+    struct ParsedRule
+    {
+        std::vector<int> terms; // flat input term indices
+        std::vector<unsigned char> negated;
+        std::vector<int> consequents; // flat output term indices
+        bool isOr;
+        float weight;
+    };
+
+    InferenceMethod method;
+    TNormKind andKind;
+    ImplicationKind implication;
+    DefuzzMethod defuzzMethod;
+    size_t resolution;
+
+    std::vector<FuzzyVariable> inputs, outputs;
+    std::vector<ParsedRule> parsed;
+    bool currentIsOutput;
+
+    // Compiled layout
+    std::vector<MembershipFunction> inputTerms; // all input terms, input by input
+    std::vector<int> termInput;                 // input variable of each term
+    std::vector<int> inputTermStart;            // first flat term of each input
+    std::vector<int> antecedentStart;           // CSR over rules
+    std::vector<int> antecedentTerm;
+    std::vector<unsigned char> antecedentNot;
+    std::vector<int> consequentStart; // CSR over rules
+    std::vector<int> consequentTerm;
+    std::vector<unsigned char> ruleOr;
+    std::vector<float> ruleWeight;
+    std::vector<int> outputTermStart; // first flat term of each output
+    std::vector<int> termOutput;      // output variable of each flat output term
+    size_t stride;                    // padded samples per output term
+    AlignedBuffer<float> outputSamples; // [output term][stride], Mamdani
+    bool piecewise;                     // Mamdani outputs all piecewise linear
+    std::vector<float> sugenoCoeffs;    // [output term][inputs + 1], Sugeno
+
+    InferenceScratch ownScratch;
+
+    static bool parseFloat(const std::string &s, float &v)
+    {
+        std::istringstream in(s);
+        return (in >> v) && in.eof();
+    }
+
+    static int findVariable(const std::vector<FuzzyVariable> &vars, const std::string &name)
+    {
+        for (size_t i = 0; i < vars.size(); i++)
+            if (vars[i].name == name)
+                return (int)i;
+        return -1;
+    }
+
+    // Flat index of `term` of variable `var`
+    static int flatTerm(const std::vector<FuzzyVariable> &vars, int var, int term)
+    {
+        int flat = 0;
+        for (int i = 0; i < var; i++)
+            flat += (int)vars[i].terms.size();
+        return flat + term;
+    }
+
+    bool parseLine(const std::vector<std::string> &tok, std::string &error)
+    {
+        const std::string &key = tok[0];
+        if (key == "method" && tok.size() == 2)
+        {
+            if (tok[1] == "mamdani")
+                method = INFERENCE_MAMDANI;
+            else if (tok[1] == "sugeno")
+                method = INFERENCE_SUGENO;
+            else
+                return fail(error, "unknown method " + tok[1]);
+            return true;
+        }
+        if (key == "and" && tok.size() == 2)
+        {
+            static const char *names[] = {"min", "product", "lukasiewicz", "drastic", "einstein"};
+            for (int k = 0; k <= TNORM_EINSTEIN; k++)
+            {
+                if (tok[1] == names[k])
+                {
+                    andKind = (TNormKind)k;
+                    return true;
+                }
+            }
+            return fail(error, "unknown t-norm " + tok[1]);
+        }
+        if (key == "implication" && tok.size() == 2)
+        {
+            if (tok[1] == "min")
+                implication = IMPLICATION_MIN;
+            else if (tok[1] == "product")
+                implication = IMPLICATION_PRODUCT;
+            else
+                return fail(error, "unknown implication " + tok[1]);
+            return true;
+        }
+        if (key == "defuzzify" && tok.size() == 2)
+        {
+            static const char *names[] = {"centroid", "bisector", "mom", "som", "lom"};
+            for (int k = 0; k <= DEFUZZ_LOM; k++)
+            {
+                if (tok[1] == names[k])
+                {
+                    defuzzMethod = (DefuzzMethod)k;
+                    return true;
+                }
+            }
+            return fail(error, "unknown defuzzification " + tok[1]);
+        }
+        if (key == "resolution" && tok.size() == 2)
+        {
+            float r;
+            if (!parseFloat(tok[1], r) || r < 2.0f)
+                return fail(error, "resolution must be at least 2");
+            resolution = (size_t)r;
+            return true;
+        }
+        if ((key == "input" || key == "output") && tok.size() == 4)
+        {
+            FuzzyVariable var;
+            var.name = tok[1];
+            if (!parseFloat(tok[2], var.lo) || !parseFloat(tok[3], var.hi) || !(var.hi > var.lo))
+                return fail(error, "expected " + key + " <name> <lo> <hi> with lo < hi");
+            if (findVariable(inputs, var.name) >= 0 || findVariable(outputs, var.name) >= 0)
+                return fail(error, "duplicate variable " + var.name);
+            currentIsOutput = key == "output";
+            (currentIsOutput ? outputs : inputs).push_back(var);
+            return true;
+        }
+        if (key == "term" && tok.size() >= 3)
+            return parseTerm(tok, error);
+        if (key == "rule")
+            return parseRule(tok, error);
+        return fail(error, "cannot parse '" + key + "' line");
+    }
+
+    bool parseTerm(const std::vector<std::string> &tok, std::string &error)
+    {
+        std::vector<FuzzyVariable> &vars = currentIsOutput ? outputs : inputs;
+        if (vars.empty())
+            return fail(error, "term before any input/output");
+        FuzzyVariable &var = vars.back();
+        if (var.termIndex(tok[1]) >= 0)
+            return fail(error, "duplicate term " + tok[1]);
+
+        FuzzyTerm term;
+        term.name = tok[1];
+        std::vector<float> params;
+        for (size_t i = 3; i < tok.size(); i++)
+        {
+            float v;
+            if (!parseFloat(tok[i], v))
+                return fail(error, "bad number " + tok[i]);
+            params.push_back(v);
+        }
+        if (tok[2] == "linear")
+        {
+            if (!currentIsOutput || params.empty())
+                return fail(error, "linear terms are Sugeno output terms with k0 k1 .. kn");
+            term.linear = true;
+            term.coeffs = params;
+        }
+        else
+        {
+            MFType type;
+            if (!parseMFType(tok[2], type))
+                return fail(error, "unknown membership function " + tok[2]);
+            if ((int)params.size() != mfParamCount(type))
+                return fail(error, "wrong parameter count for " + tok[2]);
+            params.resize(4, 0.0f);
+            term.mf = MembershipFunction(type, params[0], params[1], params[2], params[3]);
+            if (type == MF_CONSTANT)
+                term.coeffs.push_back(params[0]);
+        }
+        var.terms.push_back(term);
+        return true;
+    }
+
+    // rule if <in> is [not] <term> (and|or ...) then <out> is <term> (and ...) [weight w]
+    bool parseRule(const std::vector<std::string> &tok, std::string &error)
+    {
+        ParsedRule rule;
+        rule.isOr = false;
+        rule.weight = 1.0f;
+        size_t i = 1;
+        if (i < tok.size() && tok[i] == "if")
+            i++;
+
+        bool sawConnective = false;
+        for (;;)
+        {
+            if (i + 2 >= tok.size() || tok[i + 1] != "is")
+                return fail(error, "expected <input> is <term>");
+            int var = findVariable(inputs, tok[i]);
+            if (var < 0)
+                return fail(error, "unknown input " + tok[i]);
+            i += 2;
+            bool negated = tok[i] == "not";
+            if (negated && ++i >= tok.size())
+                return fail(error, "expected term after not");
+            int term = inputs[var].termIndex(tok[i]);
+            if (term < 0)
+                return fail(error, "unknown term " + tok[i] + " of " + inputs[var].name);
+            rule.terms.push_back(flatTerm(inputs, var, term));
+            rule.negated.push_back(negated ? 1 : 0);
+            i++;
+            if (i < tok.size() && (tok[i] == "and" || tok[i] == "or"))
+            {
+                bool isOr = tok[i] == "or";
+                if (sawConnective && isOr != rule.isOr)
+                    return fail(error, "mixing and/or in one rule; split it into several rules");
+                rule.isOr = isOr;
+                sawConnective = true;
+                i++;
+                continue;
+            }
+            break;
+        }
+        if (i >= tok.size() || tok[i] != "then")
+            return fail(error, "expected then");
+        i++;
+        for (;;)
+        {
+            if (i + 2 >= tok.size() || tok[i + 1] != "is")
+                return fail(error, "expected <output> is <term>");
+            int var = findVariable(outputs, tok[i]);
+            if (var < 0)
+                return fail(error, "unknown output " + tok[i]);
+            int term = outputs[var].termIndex(tok[i + 2]);
+            if (term < 0)
+                return fail(error, "unknown term " + tok[i + 2] + " of " + outputs[var].name);
+            rule.consequents.push_back(flatTerm(outputs, var, term));
+            i += 3;
+            if (i < tok.size() && tok[i] == "and")
+            {
+                i++;
+                continue;
+            }
+            break;
+        }
+        if (i + 1 < tok.size() && tok[i] == "weight")
+        {
+            if (!parseFloat(tok[i + 1], rule.weight) || rule.weight < 0.0f || rule.weight > 1.0f)
+                return fail(error, "weight must be in [0, 1]");
+            i += 2;
+        }
+        if (i != tok.size())
+            return fail(error, "unexpected '" + tok[i] + "'");
+        parsed.push_back(rule);
+        return true;
+    }
+
+    static bool fail(std::string &error, const std::string &message)
+    {
+        error = message;
+        return false;
+    }
+
+    bool compile(std::string &error)
+    {
+        if (inputs.empty() || outputs.empty() || parsed.empty())
+            return fail(error, "rule base needs at least one input, output and rule");
+
+        for (size_t v = 0; v < inputs.size(); v++)
+        {
+            inputTermStart.push_back((int)inputTerms.size());
+            for (size_t t = 0; t < inputs[v].terms.size(); t++)
+            {
+                inputTerms.push_back(inputs[v].terms[t].mf);
+                termInput.push_back((int)v);
+            }
+        }
+        inputTermStart.push_back((int)inputTerms.size());
+
+        antecedentStart.push_back(0);
+        consequentStart.push_back(0);
+        for (size_t r = 0; r < parsed.size(); r++)
+        {
+            const ParsedRule &rule = parsed[r];
+            antecedentTerm.insert(antecedentTerm.end(), rule.terms.begin(), rule.terms.end());
+            antecedentNot.insert(antecedentNot.end(), rule.negated.begin(), rule.negated.end());
+            antecedentStart.push_back((int)antecedentTerm.size());
+            consequentTerm.insert(consequentTerm.end(), rule.consequents.begin(), rule.consequents.end());
+            consequentStart.push_back((int)consequentTerm.size());
+            ruleOr.push_back(rule.isOr ? 1 : 0);
+            ruleWeight.push_back(rule.weight);
+        }
+        parsed.clear();
+
+        size_t outputTerms = 0;
+        for (size_t v = 0; v < outputs.size(); v++)
+        {
+            outputTermStart.push_back((int)outputTerms);
+            for (size_t t = 0; t < outputs[v].terms.size(); t++)
+                termOutput.push_back((int)v);
+            outputTerms += outputs[v].terms.size();
+        }
+        outputTermStart.push_back((int)outputTerms);
+
+        if (method == INFERENCE_MAMDANI)
+        {
+            piecewise = true;
+            for (size_t v = 0; v < outputs.size(); v++)
+                for (size_t t = 0; t < outputs[v].terms.size(); t++)
+                {
+                    MFType type = outputs[v].terms[t].mf.type;
+                    if (type != MF_TRIANGULAR && type != MF_TRAPEZOIDAL && type != MF_CONSTANT)
+                        piecewise = false;
+                }
+
+            // Sample every output term once on its variable's grid
+            stride = paddedCount<float>(resolution);
+            outputSamples.resize(outputTerms * stride);
+            std::vector<float> grid(resolution);
+            for (size_t v = 0; v < outputs.size(); v++)
+            {
+                const FuzzyVariable &var = outputs[v];
+                const float step = (var.hi - var.lo) / (float)(resolution - 1);
+                for (size_t k = 0; k < resolution; k++)
+                    grid[k] = var.lo + step * (float)k;
+                for (size_t t = 0; t < var.terms.size(); t++)
+                {
+                    if (var.terms[t].linear)
+                        return fail(error, "linear term " + var.terms[t].name + " needs method sugeno");
+                    size_t flat = outputTermStart[v] + t;
+                    var.terms[t].mf.evaluate(grid.data(), outputSamples.data() + flat * stride, resolution);
+                }
+            }
+        }
+        else
+        {
+            const size_t width = inputs.size() + 1;
+            sugenoCoeffs.assign(outputTerms * width, 0.0f);
+            for (size_t v = 0; v < outputs.size(); v++)
+            {
+                for (size_t t = 0; t < outputs[v].terms.size(); t++)
+                {
+                    const FuzzyTerm &term = outputs[v].terms[t];
+                    if (term.coeffs.empty())
+                        return fail(error, "Sugeno output term " + term.name + " must be constant or linear");
+                    if (term.coeffs.size() != 1 && term.coeffs.size() != width)
+                        return fail(error, "linear term " + term.name + " needs one coefficient per input plus k0");
+                    size_t flat = outputTermStart[v] + t;
+                    for (size_t c = 0; c < term.coeffs.size(); c++)
+                        sugenoCoeffs[flat * width + c] = term.coeffs[c];
+                }
+            }
+        }
+        return true;
+    }
+
+    // Firing strength of rule r from the fuzzified degrees
+    template <typename TN>
+    float fire(size_t r, const float *degrees) const
+    {
+        const int lo = antecedentStart[r], hi = antecedentStart[r + 1];
+        float w = 0.0f;
+        for (int a = lo; a < hi; a++)
+        {
+            float d = degrees[antecedentTerm[a]];
+            d = antecedentNot[a] ? 1.0f - d : d;
+            if (a == lo)
+                w = d;
+            else
+                w = ruleOr[r] ? TN::tconorm(w, d) : TN::tnorm(w, d);
+        }
+        return w * ruleWeight[r];
+    }
+
+    template <typename TN>
+    void evaluateWith(const float *in, float *out, InferenceScratch &s) const
+    {
+        s.degrees.resize(inputTerms.size());
+        for (size_t t = 0; t < inputTerms.size(); t++)
+            s.degrees[t] = inputTerms[t](in[termInput[t]]);
+
+        if (method == INFERENCE_SUGENO)
+        {
+            evaluateSugeno<TN>(in, out, s);
+            return;
+        }
+
+        const size_t outputTerms = termOutput.size();
+        s.levels.assign(outputTerms, 0.0f);
+        for (size_t r = 0; r < ruleWeight.size(); r++)
+        {
+            float w = fire<TN>(r, s.degrees.data());
+            for (int c = consequentStart[r]; c < consequentStart[r + 1]; c++)
+            {
+                float &level = s.levels[consequentTerm[c]];
+                level = w > level ? w : level;
+            }
+        }
+
+        s.aggregate.resize(stride);
+        for (size_t v = 0; v < outputs.size(); v++)
+            out[v] = aggregateOutput(v, s.levels.data(), 1, s);
+    }
+
+    // Aggregates the output sets of variable v, the level of output term t
+    // being levels[t * levelStride], and defuzzifies the result
+    float aggregateOutput(size_t v, const float *levels, size_t levelStride, InferenceScratch &s) const
+    {
+        if (piecewise)
+            return aggregatePiecewise(v, levels, levelStride, s.piecewise);
+        float *agg = s.aggregate.data();
+        s.aggregate.fill(0.0f);
+        for (int t = outputTermStart[v]; t < outputTermStart[v + 1]; t++)
+        {
+            const float level = levels[t * levelStride];
+            if (level <= 0.0f)
+                continue;
+            const float *mu = outputSamples.data() + t * stride;
+            if (implication == IMPLICATION_MIN)
+                aggregateClipped(agg, mu, level, stride);
+            else
+                aggregateScaled(agg, mu, level, stride);
+        }
+        const FuzzyVariable &var = outputs[v];
+        const float step = (var.hi - var.lo) / (float)(resolution - 1);
+        return defuzzifySampled(defuzzMethod, agg, resolution, var.lo, step, 0.5f * (var.lo + var.hi));
+    }
+
+    // Same for piecewise-linear output terms, exactly rather than sampled
+    float aggregatePiecewise(size_t v, const float *levels, size_t levelStride, PiecewiseDefuzzifier &d) const
+    {
+        const FuzzyVariable &var = outputs[v];
+        d.clear(var.lo, var.hi);
+        for (int t = outputTermStart[v]; t < outputTermStart[v + 1]; t++)
+        {
+            const float level = levels[t * levelStride];
+            if (level <= 0.0f)
+                continue;
+            const MembershipFunction &mf = var.terms[t - outputTermStart[v]].mf;
+            const bool clip = implication == IMPLICATION_MIN;
+            if (mf.type == MF_CONSTANT)
+                d.addConstant(clip ? (mf.p[0] < level ? mf.p[0] : level) : mf.p[0] * level);
+            else
+            {
+                // A triangle is a trapezoid with a one-point plateau
+                const float c = mf.type == MF_TRIANGULAR ? mf.p[1] : mf.p[2];
+                const float dEnd = mf.type == MF_TRIANGULAR ? mf.p[2] : mf.p[3];
+                if (clip)
+                    d.addClipped(mf.p[0], mf.p[1], c, dEnd, level);
+                else
+                    d.addScaled(mf.p[0], mf.p[1], c, dEnd, level);
+            }
+        }
+        return d.defuzzify(defuzzMethod, 0.5f * (var.lo + var.hi));
+    }
+
+    template <typename TN>
+    void evaluateBatchWith(const float *const *in, float *const *out, size_t n, InferenceScratch &s) const
+    {
+        const size_t B = INFERENCE_BLOCK;
+        s.blockInputs.resize(inputs.size() * B);
+        s.blockDegrees.resize(inputTerms.size() * B);
+        s.blockLevels.resize(termOutput.size() * B);
+        s.blockFiring.resize(B);
+        s.blockValue.resize(B);
+        s.blockNum.resize(outputs.size() * B);
+        s.blockDen.resize(outputs.size() * B);
+        s.aggregate.resize(stride);
+        for (size_t base = 0; base < n; base += B)
+            evaluateBlock<TN>(in, out, base, n - base < B ? n - base : B, s);
+    }
+
+    // Samples [base, base + m), m <= INFERENCE_BLOCK. The inputs are copied
+    // into zero-padded block rows so every column loop below has the constant
+    // trip count B and vectorizes; lanes past m are computed and ignored.
+    template <typename TN>
+    void evaluateBlock(const float *const *in, float *const *out, size_t base, size_t m, InferenceScratch &s) const
+    {
+        const size_t B = INFERENCE_BLOCK;
+        float *x = s.blockInputs.data();
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            float *row = x + i * B;
+            for (size_t k = 0; k < m; k++)
+                row[k] = in[i][base + k];
+            for (size_t k = m; k < B; k++)
+                row[k] = inputs[i].lo;
+        }
+
+        float *degrees = s.blockDegrees.data();
+        for (size_t t = 0; t < inputTerms.size(); t++)
+            inputTerms[t].evaluate(x + termInput[t] * B, degrees + t * B, B);
+
+        const bool sugeno = method == INFERENCE_SUGENO;
+        if (sugeno)
+        {
+            s.blockNum.fill(0.0f);
+            s.blockDen.fill(0.0f);
+        }
+        else
+            s.blockLevels.fill(0.0f);
+
+        float *__restrict w = s.blockFiring.data();
+        for (size_t r = 0; r < ruleWeight.size(); r++)
+        {
+            fireBlock<TN>(r, degrees, w);
+            for (int c = consequentStart[r]; c < consequentStart[r + 1]; c++)
+            {
+                const int t = consequentTerm[c];
+                if (!sugeno)
+                {
+                    float *__restrict level = s.blockLevels.data() + t * B;
+                    for (size_t k = 0; k < B; k++)
+                        level[k] = w[k] > level[k] ? w[k] : level[k];
+                    continue;
+                }
+                // z = k0 + k1 x1 + ... + kn xn across the block
+                const size_t width = inputs.size() + 1;
+                const float *coeff = &sugenoCoeffs[t * width];
+                float *__restrict z = s.blockValue.data();
+                for (size_t k = 0; k < B; k++)
+                    z[k] = coeff[0];
+                for (size_t i = 0; i < inputs.size(); i++)
+                {
+                    const float ki = coeff[i + 1];
+                    const float *xi = x + i * B;
+                    for (size_t k = 0; k < B; k++)
+                        z[k] += ki * xi[k];
+                }
+                float *__restrict num = s.blockNum.data() + termOutput[t] * B;
+                float *__restrict den = s.blockDen.data() + termOutput[t] * B;
+                for (size_t k = 0; k < B; k++)
+                {
+                    num[k] += w[k] * z[k];
+                    den[k] += w[k];
+                }
+            }
+        }
+
+        for (size_t v = 0; v < outputs.size(); v++)
+        {
+            float *dst = out[v] + base;
+            if (sugeno)
+            {
+                const float *num = s.blockNum.data() + v * B;
+                const float *den = s.blockDen.data() + v * B;
+                const float mid = 0.5f * (outputs[v].lo + outputs[v].hi);
+                for (size_t k = 0; k < m; k++)
+                    dst[k] = den[k] > 0.0f ? num[k] / den[k] : mid;
+            }
+            else
+            {
+                for (size_t k = 0; k < m; k++)
+                    dst[k] = aggregateOutput(v, s.blockLevels.data() + k, B, s);
+            }
+        }
+    }
+
+    // Firing strength of rule r for every lane of the block
+    template <typename TN>
+    void fireBlock(size_t r, const float *degrees, float *__restrict w) const
+    {
+        const size_t B = INFERENCE_BLOCK;
+        const int lo = antecedentStart[r], hi = antecedentStart[r + 1];
+        for (int a = lo; a < hi; a++)
+        {
+            const float *d = degrees + antecedentTerm[a] * B;
+            const float flip = antecedentNot[a] ? 1.0f : 0.0f;
+            const float sign = antecedentNot[a] ? -1.0f : 1.0f;
+            if (a == lo)
+            {
+                for (size_t k = 0; k < B; k++)
+                    w[k] = flip + sign * d[k];
+            }
+            else if (ruleOr[r])
+            {
+                for (size_t k = 0; k < B; k++)
+                    w[k] = TN::tconorm(w[k], flip + sign * d[k]);
+            }
+            else
+            {
+                for (size_t k = 0; k < B; k++)
+                    w[k] = TN::tnorm(w[k], flip + sign * d[k]);
+            }
+        }
+        const float weight = ruleWeight[r];
+        for (size_t k = 0; k < B; k++)
+            w[k] *= weight;
+    }
+
+    // Weighted average of the rule outputs z = k0 + k1 x1 + ... + kn xn
+    template <typename TN>
+    void evaluateSugeno(const float *in, float *out, InferenceScratch &s) const
+    {
+        const size_t width = inputs.size() + 1;
+        s.num.assign(outputs.size(), 0.0f);
+        s.den.assign(outputs.size(), 0.0f);
+        for (size_t r = 0; r < ruleWeight.size(); r++)
+        {
+            float w = fire<TN>(r, s.degrees.data());
+            if (w <= 0.0f)
+                continue;
+            for (int c = consequentStart[r]; c < consequentStart[r + 1]; c++)
+            {
+                const int t = consequentTerm[c];
+                const float *k = &sugenoCoeffs[t * width];
+                float z = k[0];
+                for (size_t i = 0; i < inputs.size(); i++)
+                    z += k[i + 1] * in[i];
+                s.num[termOutput[t]] += w * z;
+                s.den[termOutput[t]] += w;
+            }
+        }
+        for (size_t v = 0; v < outputs.size(); v++)
+            out[v] = s.den[v] > 0.0f ? s.num[v] / s.den[v] : 0.5f * (outputs[v].lo + outputs[v].hi);
+    }
+};
+
+#endif // FUZZY_INFERENCE_H
@@ -0,0 +1,312 @@
+#ifndef FUZZY_KERNELS_H
+#define FUZZY_KERNELS_H
+
+// Elementwise fuzzy set kernels (union, intersection, complement) for float
+// and double membership arrays. The widest SIMD path the CPU supports
+// (AVX-512, AVX2 or SSE2) is picked once at runtime; other targets fall back
+// to the scalar loop. None of the pointer/size entry points allocate.
+
+#include <cstddef>
+#include <vector>
+
+#include "bit_cast.h"
+#include "simd_level.h"
+
+// Operation tags. Each knows its scalar form; the vector forms live in the
+// per-ISA traits below so they can carry the matching target attribute.
+struct UnionOp
+{
+    template <typename T>
+    static T scalar(T a, T b) { return a > b ? a : b; }
+};
+
+struct IntersectionOp
+{
+    template <typename T>
+    static T scalar(T a, T b) { return a < b ? a : b; }
+};
+
+struct ProductOp // algebraic product t-norm, used by max-product composition
+{
+    template <typename T>
+    static T scalar(T a, T b) { return a * b; }
+};
+
+struct ComplementOp
+{
+    template <typename T>
+    static T scalar(T a) { return T(1) - a; }
+};
+
+template <typename Op, typename T>
+void binaryScalar(const T *a, const T *b, T *out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = Op::scalar(a[i], b[i]);
+}
+
+template <typename Op, typename T>
+void unaryScalar(const T *a, T *out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = Op::scalar(a[i]);
+}
+
+#ifdef FUZZY_X86
+
+template <typename T>
+struct Sse2Ops;
+template <typename T>
+struct Avx2Ops;
+template <typename T>
+struct Avx512Ops;
+
+template <>
+struct Sse2Ops<float>
+{
+    typedef __m128 V;
+    static const size_t width = 4;
+    FUZZY_TARGET("sse2") static V load(const float *p) { return _mm_loadu_ps(p); }
+    FUZZY_TARGET("sse2") static void store(float *p, V v) { _mm_storeu_ps(p, v); }
+    FUZZY_TARGET("sse2") static V broadcast(float x) { return _mm_set1_ps(x); }
+    FUZZY_TARGET("sse2") static V apply(UnionOp, V a, V b) { return _mm_max_ps(a, b); }
+    FUZZY_TARGET("sse2") static V apply(IntersectionOp, V a, V b) { return _mm_min_ps(a, b); }
+    FUZZY_TARGET("sse2") static V apply(ProductOp, V a, V b) { return _mm_mul_ps(a, b); }
+    FUZZY_TARGET("sse2") static V apply(ComplementOp, V a) { return _mm_sub_ps(_mm_set1_ps(1.0f), a); }
+};
+
+template <>
+struct Sse2Ops<double>
+{
+    typedef __m128d V;
+    static const size_t width = 2;
+    FUZZY_TARGET("sse2") static V load(const double *p) { return _mm_loadu_pd(p); }
+    FUZZY_TARGET("sse2") static void store(double *p, V v) { _mm_storeu_pd(p, v); }
+    FUZZY_TARGET("sse2") static V broadcast(double x) { return _mm_set1_pd(x); }
+    FUZZY_TARGET("sse2") static V apply(UnionOp, V a, V b) { return _mm_max_pd(a, b); }
+    FUZZY_TARGET("sse2") static V apply(IntersectionOp, V a, V b) { return _mm_min_pd(a, b); }
+    FUZZY_TARGET("sse2") static V apply(ProductOp, V a, V b) { return _mm_mul_pd(a, b); }
+    FUZZY_TARGET("sse2") static V apply(ComplementOp, V a) { return _mm_sub_pd(_mm_set1_pd(1.0), a); }
+};
+
+template <>
+struct Avx2Ops<float>
+{
+    typedef __m256 V;
+    static const size_t width = 8;
+    FUZZY_TARGET("avx2") static V load(const float *p) { return _mm256_loadu_ps(p); }
+    FUZZY_TARGET("avx2") static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+    FUZZY_TARGET("avx2") static V broadcast(float x) { return _mm256_set1_ps(x); }
+    FUZZY_TARGET("avx2") static V apply(UnionOp, V a, V b) { return _mm256_max_ps(a, b); }
+    FUZZY_TARGET("avx2") static V apply(IntersectionOp, V a, V b) { return _mm256_min_ps(a, b); }
+    FUZZY_TARGET("avx2") static V apply(ProductOp, V a, V b) { return _mm256_mul_ps(a, b); }
+    FUZZY_TARGET("avx2") static V apply(ComplementOp, V a) { return _mm256_sub_ps(_mm256_set1_ps(1.0f), a); }
+};
+
+template <>
+struct Avx2Ops<double>
+{
+    typedef __m256d V;
+    static const size_t width = 4;
+    FUZZY_TARGET("avx2") static V load(const double *p) { return _mm256_loadu_pd(p); }
+    FUZZY_TARGET("avx2") static void store(double *p, V v) { _mm256_storeu_pd(p, v); }
+    FUZZY_TARGET("avx2") static V broadcast(double x) { return _mm256_set1_pd(x); }
+    FUZZY_TARGET("avx2") static V apply(UnionOp, V a, V b) { return _mm256_max_pd(a, b); }
+    FUZZY_TARGET("avx2") static V apply(IntersectionOp, V a, V b) { return _mm256_min_pd(a, b); }
+    FUZZY_TARGET("avx2") static V apply(ProductOp, V a, V b) { return _mm256_mul_pd(a, b); }
+    FUZZY_TARGET("avx2") static V apply(ComplementOp, V a) { return _mm256_sub_pd(_mm256_set1_pd(1.0), a); }
+};
+
+template <>
+struct Avx512Ops<float>
+{
+    typedef __m512 V;
+    static const size_t width = 16;
+    FUZZY_TARGET("avx512f") static V load(const float *p) { return _mm512_loadu_ps(p); }
+    FUZZY_TARGET("avx512f") static void store(float *p, V v) { _mm512_storeu_ps(p, v); }
+    FUZZY_TARGET("avx512f") static V broadcast(float x) { return _mm512_set1_ps(x); }
+    FUZZY_TARGET("avx512f") static V apply(UnionOp, V a, V b) { return _mm512_max_ps(a, b); }
+    FUZZY_TARGET("avx512f") static V apply(IntersectionOp, V a, V b) { return _mm512_min_ps(a, b); }
+    FUZZY_TARGET("avx512f") static V apply(ProductOp, V a, V b) { return _mm512_mul_ps(a, b); }
+    FUZZY_TARGET("avx512f") static V apply(ComplementOp, V a) { return _mm512_sub_ps(_mm512_set1_ps(1.0f), a); }
+};
+
+template <>
+struct Avx512Ops<double>
+{
+    typedef __m512d V;
+    static const size_t width = 8;
+    FUZZY_TARGET("avx512f") static V load(const double *p) { return _mm512_loadu_pd(p); }
+    FUZZY_TARGET("avx512f") static void store(double *p, V v) { _mm512_storeu_pd(p, v); }
+    FUZZY_TARGET("avx512f") static V broadcast(double x) { return _mm512_set1_pd(x); }
+    FUZZY_TARGET("avx512f") static V apply(UnionOp, V a, V b) { return _mm512_max_pd(a, b); }
+    FUZZY_TARGET("avx512f") static V apply(IntersectionOp, V a, V b) { return _mm512_min_pd(a, b); }
+    FUZZY_TARGET("avx512f") static V apply(ProductOp, V a, V b) { return _mm512_mul_pd(a, b); }
+    FUZZY_TARGET("avx512f") static V apply(ComplementOp, V a) { return _mm512_sub_pd(_mm512_set1_pd(1.0), a); }
+};
+
+// One loop pair per ISA: the loop itself must carry the target attribute so
+// the traits above can be inlined into it. Unrolled by 4 vectors to keep
+// enough loads in flight to saturate memory bandwidth.
+#define FUZZY_DEFINE_SIMD_LOOPS(NAME, ISA, TRAITS)                                       \
+    template <typename Op, typename T>                                                   \
+    FUZZY_TARGET(ISA)                                                                    \
+    void binary##NAME(const T *a, const T *b, T *out, size_t n)                          \
+    {                                                                                    \
+        typedef TRAITS<T> I;                                                             \
+        const size_t w = I::width;                                                       \
+        size_t i = 0;                                                                    \
+        for (; i + 4 * w <= n; i += 4 * w)                                               \
+        {                                                                                \
+            typename I::V r0 = I::apply(Op(), I::load(a + i), I::load(b + i));           \
+            typename I::V r1 = I::apply(Op(), I::load(a + i + w), I::load(b + i + w));   \
+            typename I::V r2 = I::apply(Op(), I::load(a + i + 2 * w), I::load(b + i + 2 * w)); \
+            typename I::V r3 = I::apply(Op(), I::load(a + i + 3 * w), I::load(b + i + 3 * w)); \
+            I::store(out + i, r0);                                                       \
+            I::store(out + i + w, r1);                                                   \
+            I::store(out + i + 2 * w, r2);                                               \
+            I::store(out + i + 3 * w, r3);                                               \
+        }                                                                                \
+        for (; i + w <= n; i += w)                                                       \
+            I::store(out + i, I::apply(Op(), I::load(a + i), I::load(b + i)));           \
+        for (; i < n; ++i)                                                               \
+            out[i] = Op::scalar(a[i], b[i]);                                             \
+    }                                                                                    \
+    template <typename Op, typename T>                                                   \
+    FUZZY_TARGET(ISA)                                                                    \
+    void unary##NAME(const T *a, T *out, size_t n)                                       \
+    {                                                                                    \
+        typedef TRAITS<T> I;                                                             \
+        const size_t w = I::width;                                                       \
+        size_t i = 0;                                                                    \
+        for (; i + 4 * w <= n; i += 4 * w)                                               \
+        {                                                                                \
+            typename I::V r0 = I::apply(Op(), I::load(a + i));                           \
+            typename I::V r1 = I::apply(Op(), I::load(a + i + w));                       \
+            typename I::V r2 = I::apply(Op(), I::load(a + i + 2 * w));                   \
+            typename I::V r3 = I::apply(Op(), I::load(a + i + 3 * w));                   \
+            I::store(out + i, r0);                                                       \
+            I::store(out + i + w, r1);                                                   \
+            I::store(out + i + 2 * w, r2);                                               \
+            I::store(out + i + 3 * w, r3);                                               \
+        }                                                                                \
+        for (; i + w <= n; i += w)                                                       \
+            I::store(out + i, I::apply(Op(), I::load(a + i)));                           \
+        for (; i < n; ++i)                                                               \
+            out[i] = Op::scalar(a[i]);                                                   \
+    }
+
+FUZZY_DEFINE_SIMD_LOOPS(Sse2, "sse2", Sse2Ops)
+FUZZY_DEFINE_SIMD_LOOPS(Avx2, "avx2", Avx2Ops)
+FUZZY_DEFINE_SIMD_LOOPS(Avx512, "avx512f", Avx512Ops)
+
+#undef FUZZY_DEFINE_SIMD_LOOPS
+
+#endif // FUZZY_X86
+
+template <typename Op, typename T>
+void binaryDispatch(const T *a, const T *b, T *out, size_t n)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        binaryAvx512<Op>(a, b, out, n);
+        return;
+    case SIMD_AVX2:
+        binaryAvx2<Op>(a, b, out, n);
+        return;
+    case SIMD_SSE2:
+        binarySse2<Op>(a, b, out, n);
+        return;
+    default:
+        break;
+    }
+#endif
+    binaryScalar<Op>(a, b, out, n);
+}
+
+template <typename Op, typename T>
+void unaryDispatch(const T *a, T *out, size_t n)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        unaryAvx512<Op>(a, out, n);
+        return;
+    case SIMD_AVX2:
+        unaryAvx2<Op>(a, out, n);
+        return;
+    case SIMD_SSE2:
+        unarySse2<Op>(a, out, n);
+        return;
+    default:
+        break;
+    }
+#endif
+    unaryScalar<Op>(a, out, n);
+}
+
+// Caller-provided output. `out` may alias `a` or `b`.
+template <typename T>
+void fuzzyUnion(const T *a, const T *b, T *out, size_t n)
+{
+    binaryDispatch<UnionOp>(a, b, out, n);
+}
+
+template <typename T>
+void fuzzyIntersection(const T *a, const T *b, T *out, size_t n)
+{
+    binaryDispatch<IntersectionOp>(a, b, out, n);
+}
+
+template <typename T>
+void fuzzyComplement(const T *a, T *out, size_t n)
+{
+    unaryDispatch<ComplementOp>(a, out, n);
+}
+
+// In place: a = a op b
+template <typename T>
+void fuzzyUnionInPlace(T *a, const T *b, size_t n)
+{
+    binaryDispatch<UnionOp>(a, b, a, n);
+}
+
+template <typename T>
+void fuzzyIntersectionInPlace(T *a, const T *b, size_t n)
+{
+    binaryDispatch<IntersectionOp>(a, b, a, n);
+}
+
+template <typename T>
+void fuzzyComplementInPlace(T *a, size_t n)
+{
+    unaryDispatch<ComplementOp>(a, a, n);
+}
+
+// vector overloads writing into `out`; it is only resized when its size differs,
+// so reusing the same output vector across calls never reallocates.
+template <typename T>
+void fuzzyUnionInto(const std::vector<T> &A, const std::vector<T> &B, std::vector<T> &out)
+{
+    out.resize(A.size());
+    fuzzyUnion(A.data(), B.data(), out.data(), A.size());
+}
+
+template <typename T>
+void fuzzyIntersectionInto(const std::vector<T> &A, const std::vector<T> &B, std::vector<T> &out)
+{
+    out.resize(A.size());
+    fuzzyIntersection(A.data(), B.data(), out.data(), A.size());
+}
+
+template <typename T>
+void fuzzyComplementInto(const std::vector<T> &A, std::vector<T> &out)
+{
+    out.resize(A.size());
+    fuzzyComplement(A.data(), out.data(), A.size());
+}
+
+#endif // FUZZY_KERNELS_H
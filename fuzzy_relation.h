@@ -0,0 +1,205 @@
+#ifndef FUZZY_RELATION_H
+#define FUZZY_RELATION_H
+
+// Fuzzy relation stored as one cache-aligned row-major buffer. Each row is
+// padded to a whole number of cache lines (the stride), so every row starts
+// aligned and the padding stays zero. Relations are move-only; use clone()
+// for an explicit deep copy. Views describe a rectangular window (a block of
+// rows/columns, or a whole relation) without owning the memory.
+
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "fuzzy_kernels.h"
+
+template <typename T>
+struct FuzzyRelationView
+{
+    T *data;
+    size_t rows;
+    size_t cols;
+    size_t stride; // elements between the starts of consecutive rows
+
+    FuzzyRelationView(T *data, size_t rows, size_t cols, size_t stride)
+        : data(data), rows(rows), cols(cols), stride(stride) {}
+
+    T &operator()(size_t i, size_t j) const { return data[i * stride + j]; }
+    T *row(size_t i) const { return data + i * stride; }
+
+    FuzzyRelationView block(size_t row0, size_t col0, size_t nRows, size_t nCols) const
+    {
+        return FuzzyRelationView(data + row0 * stride + col0, nRows, nCols, stride);
+    }
+};
+
+template <typename T>
+class FuzzyRelationT
+{
+public:
+    typedef T value_type;
+    typedef FuzzyRelationView<T> View;
+    typedef FuzzyRelationView<const T> ConstView;
+
+    FuzzyRelationT() : nRows(0), nCols(0), rowStride(0) {}
+
+    // rows x cols relation with every membership degree set to zero
+    FuzzyRelationT(size_t rows, size_t cols)
+        : nRows(rows), nCols(cols), rowStride(paddedCount<T>(cols)), buffer(rows * rowStride) {}
+
+    FuzzyRelationT(std::initializer_list<std::initializer_list<T> > values)
+        : nRows(values.size()), nCols(values.size() ? values.begin()->size() : 0),
+          rowStride(paddedCount<T>(nCols)), buffer(nRows * rowStride)
+    {
+        size_t i = 0;
+        for (const std::initializer_list<T> &r : values)
+        {
+            size_t j = 0;
+            for (T v : r)
+                (*this)(i, j++) = v;
+            i++;
+        }
+    }
+
+    static FuzzyRelationT fromRows(const std::vector<std::vector<T> > &values)
+    {
+        FuzzyRelationT R(values.size(), values.empty() ? 0 : values[0].size());
+        for (size_t i = 0; i < R.rows(); i++)
+            for (size_t j = 0; j < R.cols(); j++)
+                R(i, j) = values[i][j];
+        return R;
+    }
+
+    FuzzyRelationT(FuzzyRelationT &&other)
+        : nRows(other.nRows), nCols(other.nCols), rowStride(other.rowStride), buffer(std::move(other.buffer))
+    {
+        other.nRows = other.nCols = other.rowStride = 0;
+    }
+
+    FuzzyRelationT &operator=(FuzzyRelationT &&other)
+    {
+        if (this == &other)
+            return *this;
+        nRows = other.nRows;
+        nCols = other.nCols;
+        rowStride = other.rowStride;
+        buffer = std::move(other.buffer);
+        other.nRows = other.nCols = other.rowStride = 0;
+        return *this;
+    }
+
+    FuzzyRelationT(const FuzzyRelationT &) = delete;
+    FuzzyRelationT &operator=(const FuzzyRelationT &) = delete;
+
+    FuzzyRelationT clone() const
+    {
+        FuzzyRelationT copy(nRows, nCols);
+        for (size_t i = 0; i < buffer.size(); i++)
+            copy.buffer[i] = buffer[i];
+        return copy;
+    }
+
+    // No-op when the shape already matches (so output relations can be
+    // reused across calls); otherwise reshapes to an all-zero relation,
+    // keeping the allocation when the padded size is unchanged.
+    void resize(size_t rows, size_t cols)
+    {
+        if (rows == nRows && cols == nCols)
+            return;
+        nRows = rows;
+        nCols = cols;
+        rowStride = paddedCount<T>(cols);
+        size_t before = buffer.size();
+        buffer.resize(rows * rowStride);
+        if (buffer.size() == before)
+            buffer.fill(T(0));
+    }
+
+    void fill(T value)
+    {
+        for (size_t i = 0; i < nRows; i++)
+            for (size_t j = 0; j < nCols; j++)
+                (*this)(i, j) = value;
+    }
+
+    size_t rows() const { return nRows; }
+    size_t cols() const { return nCols; }
+    size_t stride() const { return rowStride; }
+
+    T &operator()(size_t i, size_t j) { return buffer[i * rowStride + j]; }
+    const T &operator()(size_t i, size_t j) const { return buffer[i * rowStride + j]; }
+    T *row(size_t i) { return buffer.data() + i * rowStride; }
+    const T *row(size_t i) const { return buffer.data() + i * rowStride; }
+    T *data() { return buffer.data(); }
+    const T *data() const { return buffer.data(); }
+
+    View view() { return View(buffer.data(), nRows, nCols, rowStride); }
+    ConstView view() const { return ConstView(buffer.data(), nRows, nCols, rowStride); }
+
+    bool operator==(const FuzzyRelationT &other) const
+    {
+        if (nRows != other.nRows || nCols != other.nCols)
+            return false;
+        for (size_t i = 0; i < nRows; i++)
+            for (size_t j = 0; j < nCols; j++)
+                if ((*this)(i, j) != other(i, j))
+                    return false;
+        return true;
+    }
+
+private:
+    size_t nRows, nCols, rowStride;
+    AlignedBuffer<T> buffer;
+};
+
+typedef FuzzyRelationT<float> FuzzyRelation;
+typedef FuzzyRelationT<double> FuzzyRelationD;
+
+// Elementwise relation operators on views of equal shape. Each row is one
+// contiguous run, so they go through the SIMD kernels row by row; `out`
+// may be the same view as an input.
+template <typename A, typename B, typename T>
+void relationUnion(FuzzyRelationView<A> R, FuzzyRelationView<B> S, FuzzyRelationView<T> out)
+{
+    for (size_t i = 0; i < out.rows; i++)
+        fuzzyUnion<T>(R.row(i), S.row(i), out.row(i), out.cols);
+}
+
+template <typename A, typename B, typename T>
+void relationIntersection(FuzzyRelationView<A> R, FuzzyRelationView<B> S, FuzzyRelationView<T> out)
+{
+    for (size_t i = 0; i < out.rows; i++)
+        fuzzyIntersection<T>(R.row(i), S.row(i), out.row(i), out.cols);
+}
+
+template <typename A, typename T>
+void relationComplement(FuzzyRelationView<A> R, FuzzyRelationView<T> out)
+{
+    for (size_t i = 0; i < out.rows; i++)
+        fuzzyComplement<T>(R.row(i), out.row(i), out.cols);
+}
+
+// Whole-relation forms; `out` is reshaped to match and may be R or S
+template <typename T>
+void relationUnion(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, FuzzyRelationT<T> &out)
+{
+    out.resize(R.rows(), R.cols());
+    relationUnion(R.view(), S.view(), out.view());
+}
+
+template <typename T>
+void relationIntersection(const FuzzyRelationT<T> &R, const FuzzyRelationT<T> &S, FuzzyRelationT<T> &out)
+{
+    out.resize(R.rows(), R.cols());
+    relationIntersection(R.view(), S.view(), out.view());
+}
+
+template <typename T>
+void relationComplement(const FuzzyRelationT<T> &R, FuzzyRelationT<T> &out)
+{
+    out.resize(R.rows(), R.cols());
+    relationComplement(R.view(), out.view());
+}
+
+#endif // FUZZY_RELATION_H
@@ -0,0 +1,216 @@
+#ifndef FUZZY_TNORM_H
+#define FUZZY_TNORM_H
+
+// T-norm / t-conorm policies. Each policy is a stateless struct with static
+// tnorm(a, b) and tconorm(a, b) (its dual, S(a, b) = 1 - T(1 - a, 1 - b)),
+// so union, intersection and composition take it as a template parameter
+// and the operator is inlined into the loop body: tnormIntersection,
+// tnormUnion, tnorm<TN>() and tconorm<TN>() in fuzzy_expr.h, and
+// tnormComposition in fuzzy_composition.h. Parameters are fixed at
+// compile time as a ratio Num / Den (C++11 has no floating point template
+// arguments), e.g. YagerTNorm<3, 2> is Yager with p = 1.5.
+//
+//   MinTNorm              min(a, b)                 /  max(a, b)       (Zadeh)
+//   ProductTNorm          a * b                     /  a + b - a * b
+//   LukasiewiczTNorm      max(0, a + b - 1)         /  min(1, a + b)
+//   DrasticTNorm          b if a = 1, a if b = 1, else 0  /  dual
+//   HamacherTNorm<g>      ab / (g + (1 - g)(a + b - ab))  /  dual, g >= 0
+//   YagerTNorm<p>         max(0, 1 - ((1 - a)^p + (1 - b)^p)^(1/p))  /  min(1, (a^p + b^p)^(1/p))
+//
+// Every formula is written with selects instead of branches, so the loops
+// vectorize. Yager with p other than 1 or 2 needs pow() for the root, which
+// GCC only vectorizes when a vector math library is available.
+
+#include <cmath>
+#include <limits>
+
+#include "fuzzy_kernels.h"
+
+// Operation tags for the expression / composition engines
+template <typename TN>
+struct TNormOp
+{
+    template <typename T>
+    static T scalar(T a, T b) { return TN::tnorm(a, b); }
+};
+
+template <typename TN>
+struct TConormOp
+{
+    template <typename T>
+    static T scalar(T a, T b) { return TN::tconorm(a, b); }
+};
+
+struct MinTNorm
+{
+    // min/max already have intrinsic kernels
+    typedef IntersectionOp Op;
+    typedef UnionOp DualOp;
+
+    template <typename T>
+    static T tnorm(T a, T b) { return a < b ? a : b; }
+    template <typename T>
+    static T tconorm(T a, T b) { return a > b ? a : b; }
+};
+
+typedef MinTNorm ZadehTNorm;
+
+struct ProductTNorm
+{
+    typedef ProductOp Op;
+    typedef TConormOp<ProductTNorm> DualOp;
+
+    template <typename T>
+    static T tnorm(T a, T b) { return a * b; }
+    template <typename T>
+    static T tconorm(T a, T b) { return a + b - a * b; }
+};
+
+struct LukasiewiczTNorm
+{
+    typedef TNormOp<LukasiewiczTNorm> Op;
+    typedef TConormOp<LukasiewiczTNorm> DualOp;
+
+    template <typename T>
+    static T tnorm(T a, T b)
+    {
+        T s = a + b - T(1);
+        return s > T(0) ? s : T(0);
+    }
+    template <typename T>
+    static T tconorm(T a, T b)
+    {
+        T s = a + b;
+        return s < T(1) ? s : T(1);
+    }
+};
+
+struct DrasticTNorm
+{
+    typedef TNormOp<DrasticTNorm> Op;
+    typedef TConormOp<DrasticTNorm> DualOp;
+
+    template <typename T>
+    static T tnorm(T a, T b)
+    {
+        T other = b == T(1) ? a : T(0);
+        return a == T(1) ? b : other;
+    }
+    template <typename T>
+    static T tconorm(T a, T b)
+    {
+        T other = b == T(0) ? a : T(1);
+        return a == T(0) ? b : other;
+    }
+};
+
+// gamma = Num / Den; 0 gives the Hamacher product, 1 the algebraic product,
+// 2 the Einstein product
+template <int Num, int Den = 1>
+struct HamacherTNorm
+{
+    typedef TNormOp<HamacherTNorm> Op;
+    typedef TConormOp<HamacherTNorm> DualOp;
+
+    template <typename T>
+    static T gamma() { return T(Num) / T(Den); }
+
+    template <typename T>
+    static T tnorm(T a, T b)
+    {
+        const T g = gamma<T>();
+        T ab = a * b;
+        T denom = g + (T(1) - g) * (a + b - ab);
+        // denom is only 0 for g = 0 at a = b = 0, where ab is 0 too
+        T safe = denom > std::numeric_limits<T>::min() ? denom : std::numeric_limits<T>::min();
+        return ab / safe;
+    }
+    template <typename T>
+    static T tconorm(T a, T b)
+    {
+        const T g = gamma<T>();
+        T ab = a * b;
+        T num = a + b + (g - T(2)) * ab;
+        T denom = T(1) + (g - T(1)) * ab;
+        // denom is only 0 for g = 0 at a = b = 1, where the limit is 1
+        T safe = denom > std::numeric_limits<T>::min() ? denom : T(1);
+        return denom > std::numeric_limits<T>::min() ? num / safe : T(1);
+    }
+};
+
+// x^P for a compile-time integer P >= 1 as a chain of multiplies
+template <int P>
+struct IntPow
+{
+    template <typename T>
+    static T of(T x) { return x * IntPow<P - 1>::of(x); }
+};
+
+template <>
+struct IntPow<1>
+{
+    template <typename T>
+    static T of(T x) { return x; }
+};
+
+// s^(Den / Num), the root that undoes raising to p = Num / Den
+template <int Num, int Den>
+struct YagerRoot
+{
+    template <typename T>
+    static T of(T s) { return std::pow(s, T(Den) / T(Num)); }
+};
+
+template <>
+struct YagerRoot<1, 1>
+{
+    template <typename T>
+    static T of(T s) { return s; }
+};
+
+template <>
+struct YagerRoot<2, 1>
+{
+    template <typename T>
+    static T of(T s) { return std::sqrt(s); }
+};
+
+// x^(Num / Den); integer exponents stay multiplies
+template <int Num, int Den>
+struct YagerPow
+{
+    template <typename T>
+    static T of(T x) { return std::pow(x, T(Num) / T(Den)); }
+};
+
+template <int Num>
+struct YagerPow<Num, 1>
+{
+    template <typename T>
+    static T of(T x) { return IntPow<Num>::of(x); }
+};
+
+// p = Num / Den > 0; p = 1 is Lukasiewicz, p -> infinity approaches min/max
+template <int Num, int Den = 1>
+struct YagerTNorm
+{
+    typedef TNormOp<YagerTNorm> Op;
+    typedef TConormOp<YagerTNorm> DualOp;
+
+    template <typename T>
+    static T tnorm(T a, T b)
+    {
+        T s = YagerPow<Num, Den>::template of<T>(T(1) - a) + YagerPow<Num, Den>::template of<T>(T(1) - b);
+        T r = T(1) - YagerRoot<Num, Den>::template of<T>(s);
+        return r > T(0) ? r : T(0);
+    }
+    template <typename T>
+    static T tconorm(T a, T b)
+    {
+        T s = YagerPow<Num, Den>::template of<T>(a) + YagerPow<Num, Den>::template of<T>(b);
+        T r = YagerRoot<Num, Den>::template of<T>(s);
+        return r < T(1) ? r : T(1);
+    }
+};
+
+#endif // FUZZY_TNORM_H
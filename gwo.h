@@ -0,0 +1,392 @@
+#ifndef GWO_H
+#define GWO_H
+
+// Grey Wolf Optimizer over D-dimensional real vectors.
+//
+// The population is one AlignedBuffer: a row per wolf, each row padded to
+// whole cache lines, so the position update is a flat loop over a row that
+// vectorizes across dimensions. Padding columns have bounds [0, 0] and stay
+// zero. The objective is a template parameter, called as
+//
+//   double f(const double *x, size_t dims)
+//
+// from several threads at once (it must not modify shared state), and is
+// inlined into the per-wolf loop. Each step moves every wolf toward the
+// alpha, beta and delta leaders (the best three positions found so far) and
+// re-evaluates it; wolves are split across the thread pool.
+//
+// The random coefficients come from the counter generator in rng.h, keyed
+// by (seed, iteration, wolf) and indexed by dimension, rather than from a
+// sequential generator, so the update vectorizes, threads
+// need no generator state, and a run is reproducible from its seed whatever
+// the thread count.
+
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "rng.h"
+#include "simd_level.h"
+#include "thread_pool.h"
+
+static const size_t GWO_LANES = CACHE_LINE / sizeof(double);
+
+// Population elements per parallelFor chunk at most; smaller populations
+// are split evenly over the pool's threads
+static const size_t GWO_GRAIN_ELEMENTS = 1 << 15;
+
+// One wolf: x = mean of the three leader-guided moves, clamped to [lo, hi];
+// keys[0..2] seed the (r1, r2) pairs of the alpha, beta and delta moves.
+// Compiled per ISA.
+#define GWO_DEFINE_UPDATE(NAME, ATTR)                                                                   \
+    ATTR inline void gwoUpdate##NAME(double *__restrict x, const double *alpha, const double *beta,     \
+                                     const double *delta, const double *lo, const double *hi,           \
+                                     size_t padded, double a, const uint64_t *keys)                     \
+    {                                                                                                   \
+        const uint64_t k0 = keys[0], k1 = keys[1], k2 = keys[2];                                        \
+        for (size_t k = 0; k < padded; k += GWO_LANES)                                                  \
+            for (size_t j = 0; j < GWO_LANES; j++)                                                      \
+            {                                                                                           \
+                const uint64_t i = k + j;                                                               \
+                const double xi = x[k + j];                                                             \
+                float r1, r2, r3, r4, r5, r6;                                                           \
+                counterUnitPair(k0, i, r1, r2);                                                         \
+                counterUnitPair(k1, i, r3, r4);                                                         \
+                counterUnitPair(k2, i, r5, r6);                                                         \
+                const double a1 = a * (2.0 * r1 - 1.0), c1 = 2.0 * r2;                                  \
+                const double a2 = a * (2.0 * r3 - 1.0), c2 = 2.0 * r4;                                  \
+                const double a3 = a * (2.0 * r5 - 1.0), c3 = 2.0 * r6;                                  \
+                const double x1 = alpha[k + j] - a1 * std::fabs(c1 * alpha[k + j] - xi);                \
+                const double x2 = beta[k + j] - a2 * std::fabs(c2 * beta[k + j] - xi);                  \
+                const double x3 = delta[k + j] - a3 * std::fabs(c3 * delta[k + j] - xi);                \
+                double v = (x1 + x2 + x3) * (1.0 / 3.0);                                                \
+                v = v < lo[k + j] ? lo[k + j] : v;                                                      \
+                v = v > hi[k + j] ? hi[k + j] : v;                                                      \
+                x[k + j] = v;                                                                           \
+            }                                                                                           \
+    }
+
+GWO_DEFINE_UPDATE(Default, )
+#ifdef FUZZY_X86
+GWO_DEFINE_UPDATE(Avx2, FUZZY_TARGET("avx2,fma"))
+GWO_DEFINE_UPDATE(Avx512, FUZZY_TARGET("avx512f,avx512dq"))
+#endif
+
+#undef GWO_DEFINE_UPDATE
+
+inline void gwoUpdate(double *x, const double *alpha, const double *beta, const double *delta, const double *lo,
+                      const double *hi, size_t padded, double a, const uint64_t *keys)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        gwoUpdateAvx512(x, alpha, beta, delta, lo, hi, padded, a, keys);
+        return;
+    case SIMD_AVX2:
+        gwoUpdateAvx2(x, alpha, beta, delta, lo, hi, padded, a, keys);
+        return;
+    default:
+        break;
+    }
+#endif
+    gwoUpdateDefault(x, alpha, beta, delta, lo, hi, padded, a, keys);
+}
+
+class GreyWolfOptimizer
+{
+public:
+    // Same bounds [lower, upper] in every dimension
+    GreyWolfOptimizer(size_t wolves, size_t dims, double lower, double upper, uint64_t seed = 1,
+                      ThreadPool &pool = defaultThreadPool())
+        : pool(pool)
+    {
+        std::vector<double> lo(dims, lower), hi(dims, upper);
+        setup(wolves, dims, lo.data(), hi.data(), seed);
+    }
+
+    // Per-dimension bounds lower[d] <= x[d] <= upper[d]
+    GreyWolfOptimizer(size_t wolves, size_t dims, const double *lower, const double *upper, uint64_t seed = 1,
+                      ThreadPool &pool = defaultThreadPool())
+        : pool(pool)
+    {
+        setup(wolves, dims, lower, upper, seed);
+    }
+
+    // Scatters the wolves uniformly over the bounds, evaluates them and
+    // picks the first leaders; also restarts the iteration count
+    template <typename Objective>
+    void initialize(const Objective &f)
+    {
+        iter = 0;
+        for (int l = 0; l < 3; l++)
+            leaderFit[l] = HUGE_VAL;
+        forEachChunk([&](size_t w0, size_t w1)
+                     {
+            for (size_t w = w0; w < w1; w++)
+            {
+                scatter(w);
+                fit[w] = f(positions.data() + w * stride, dims);
+            } });
+        updateLeaders();
+        started = true;
+    }
+
+    // One iteration with exploration parameter a (2 -> 0 over a run)
+    template <typename Objective>
+    void step(const Objective &f, double a)
+    {
+        if (!started)
+            initialize(f);
+        iter++;
+        const double *alpha = leaders.data(), *beta = alpha + stride, *delta = beta + stride;
+        forEachChunk([&](size_t w0, size_t w1)
+                     {
+            uint64_t keys[3];
+            for (size_t w = w0; w < w1; w++)
+            {
+                wolfKeys(w, iter, keys);
+                double *x = positions.data() + w * stride;
+                gwoUpdate(x, alpha, beta, delta, lower.data(), upper.data(), stride, a, keys);
+                fit[w] = f(x, dims);
+            } });
+        updateLeaders();
+    }
+
+    // Initializes and runs `iterations` steps with a falling linearly from
+    // 2 to 0; returns the best fitness found
+    template <typename Objective>
+    double run(const Objective &f, size_t iterations)
+    {
+        initialize(f);
+        for (size_t t = 0; t < iterations; t++)
+            step(f, 2.0 - 2.0 * (double)t / (double)iterations);
+        return leaderFit[0];
+    }
+
+    // Asynchronous use (async_evaluator.h): wolves are placed, moved and
+    // given their fitness one at a time, in any order, instead of through
+    // initialize() and step()
+
+    // Forgets the leaders and the iteration count
+    void restart()
+    {
+        iter = 0;
+        for (int l = 0; l < 3; l++)
+            leaderFit[l] = HUGE_VAL;
+        fit.fill(HUGE_VAL);
+        started = false;
+    }
+
+    // Puts wolf w at its initial random point
+    void scatter(size_t w)
+    {
+        double *x = positions.data() + w * stride;
+        const uint64_t key = mix64(seed ^ mix64(w));
+        for (size_t d = 0; d < stride; d++)
+            x[d] = lower[d] + (upper[d] - lower[d]) * counterUnit(key, d);
+    }
+
+    // Moves wolf w toward the current leaders with exploration parameter a.
+    // `tick` keys the random numbers (step() uses the iteration) and must
+    // change between moves of one wolf. While fewer than three wolves have
+    // a fitness, the alpha stands in for the missing leaders.
+    void move(size_t w, double a, uint64_t tick)
+    {
+        const double *alpha = leaders.data();
+        const double *beta = leaderFit[1] < HUGE_VAL ? alpha + stride : alpha;
+        const double *delta = leaderFit[2] < HUGE_VAL ? alpha + 2 * stride : beta;
+        uint64_t keys[3];
+        wolfKeys(w, tick, keys);
+        gwoUpdate(positions.data() + w * stride, alpha, beta, delta, lower.data(), upper.data(), stride, a, keys);
+    }
+
+    // Records the fitness of wolf w at its current position
+    void setFitness(size_t w, double fx)
+    {
+        fit[w] = fx;
+        offerLeader(positions.data() + w * stride, fx);
+    }
+
+    // Puts wolf w at x (dims values) with known fitness fx, e.g. a migrant
+    // from another population; it joins the leaders if it beats them
+    void replace(size_t w, const double *x, double fx)
+    {
+        double *row = positions.data() + w * stride;
+        for (size_t d = 0; d < stride; d++)
+            row[d] = d < dims ? x[d] : 0.0;
+        fit[w] = fx;
+        offerLeader(row, fx);
+    }
+
+    size_t wolfCount() const { return wolves; }
+    size_t dimensions() const { return dims; }
+    size_t iteration() const { return iter; }
+
+    const double *position(size_t w) const { return positions.data() + w * stride; }
+    double fitness(size_t w) const { return fit[w]; }
+
+    // Leaders 0, 1, 2 = alpha, beta, delta
+    const double *leaderPosition(int l) const { return leaders.data() + l * stride; }
+    double leaderFitness(int l) const { return leaderFit[l]; }
+    const double *alphaPosition() const { return leaderPosition(0); }
+    double alphaFitness() const { return leaderFit[0]; }
+
+private:
+    ThreadPool &pool;
+    size_t wolves, dims, stride, iter;
+    uint64_t seed;
+    bool started;
+    AlignedBuffer<double> positions; // [wolf][stride]
+    AlignedBuffer<double> fit;
+    AlignedBuffer<double> lower, upper; // [stride], zero in the padding
+    AlignedBuffer<double> leaders;      // [3][stride]
+    double leaderFit[3];
+
+    void setup(size_t wolfCount, size_t dimCount, const double *lo, const double *hi, uint64_t seedValue)
+    {
+        wolves = wolfCount;
+        dims = dimCount;
+        stride = paddedCount<double>(dims);
+        iter = 0;
+        seed = mix64(seedValue);
+        started = false;
+        positions.resize(wolves * stride);
+        fit.resize(wolves);
+        lower.resize(stride);
+        upper.resize(stride);
+        leaders.resize(3 * stride);
+        for (size_t d = 0; d < dims; d++)
+        {
+            lower[d] = lo[d];
+            upper[d] = hi[d];
+        }
+        for (int l = 0; l < 3; l++)
+            leaderFit[l] = HUGE_VAL;
+    }
+
+    template <typename F>
+    void forEachChunk(F fn)
+    {
+        pool.parallelFor(0, wolves, pool.spreadGrain(wolves, GWO_GRAIN_ELEMENTS / stride), fn);
+    }
+
+    // Three 64-bit stream keys for wolf w at iteration `tick`
+    void wolfKeys(size_t w, uint64_t tick, uint64_t *keys) const
+    {
+        const uint64_t h = mix64(seed ^ mix64((tick << 32) ^ w));
+        keys[0] = h;
+        keys[1] = mix64(h);
+        keys[2] = mix64(h ^ RNG_COUNTER_STEP);
+    }
+
+    // Merges the three best wolves of this iteration into the best-so-far
+    // leaders (leaders only improve, as in the original loop)
+    void updateLeaders()
+    {
+        size_t best[3] = {wolves, wolves, wolves};
+        double bestFit[3] = {HUGE_VAL, HUGE_VAL, HUGE_VAL};
+        for (size_t w = 0; w < wolves; w++)
+        {
+            const double f = fit[w];
+            if (!(f < bestFit[2]))
+                continue;
+            int slot = 2;
+            while (slot > 0 && f < bestFit[slot - 1])
+            {
+                best[slot] = best[slot - 1];
+                bestFit[slot] = bestFit[slot - 1];
+                slot--;
+            }
+            best[slot] = w;
+            bestFit[slot] = f;
+        }
+        for (int b = 0; b < 3 && best[b] < wolves; b++)
+        {
+            if (!offerLeader(positions.data() + best[b] * stride, bestFit[b]))
+                break;
+        }
+    }
+
+    // Inserts x into the leaders if it beats the delta; false if it does not
+    bool offerLeader(const double *x, double f)
+    {
+        if (!(f < leaderFit[2]))
+            return false;
+        int slot = 2;
+        while (slot > 0 && f < leaderFit[slot - 1])
+        {
+            copyRow(leaders.data() + slot * stride, leaders.data() + (slot - 1) * stride);
+            leaderFit[slot] = leaderFit[slot - 1];
+            slot--;
+        }
+        copyRow(leaders.data() + slot * stride, x);
+        leaderFit[slot] = f;
+        return true;
+    }
+
+    void copyRow(double *dst, const double *src) const
+    {
+        for (size_t d = 0; d < stride; d++)
+            dst[d] = src[d];
+    }
+};
+
+// runSearch() adapter (metaheuristic.h); a falls from 2 to 0 over the
+// budget instead of over a fixed iteration count
+template <typename Objective>
+class GwoSearch
+{
+public:
+    GwoSearch(GreyWolfOptimizer &gwo, const Objective &f) : gwo(gwo), f(f) {}
+
+    size_t start()
+    {
+        gwo.initialize(f);
+        return gwo.wolfCount();
+    }
+
+    size_t step(double progress)
+    {
+        gwo.step(f, 2.0 - 2.0 * progress);
+        return gwo.wolfCount();
+    }
+
+    double bestFitness() const { return gwo.alphaFitness(); }
+
+    // Asynchronous hooks (async_evaluator.h): the first proposal for a
+    // member is its initial point, later ones move it (a = 2 - 2 progress)
+    void restart()
+    {
+        gwo.restart();
+        ticks.assign(populationSize(), 0);
+    }
+
+    const double *propose(size_t i, double progress)
+    {
+        if (ticks[i]++ == 0)
+            gwo.scatter(i);
+        else
+            gwo.move(i, 2.0 - 2.0 * progress, ticks[i] - 1);
+        return gwo.position(i);
+    }
+
+    void accept(size_t i, double fx) { gwo.setFitness(i, fx); }
+
+    // Migration hooks (island_model.h)
+    size_t dimensions() const { return gwo.dimensions(); }
+    size_t populationSize() const { return gwo.wolfCount(); }
+    const double *member(size_t i) const { return gwo.position(i); }
+    double memberFitness(size_t i) const { return gwo.fitness(i); }
+    void replaceMember(size_t i, const double *x, double fx) { gwo.replace(i, x, fx); }
+    const double *bestPosition() const { return gwo.alphaPosition(); }
+
+private:
+    GreyWolfOptimizer &gwo;
+    Objective f;
+    std::vector<uint64_t> ticks; // proposals per member
+};
+
+#endif // GWO_H
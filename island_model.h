@@ -0,0 +1,566 @@
+#ifndef ISLAND_MODEL_H
+#define ISLAND_MODEL_H
+
+// Island model: K independent populations (GWO or PSO) that run at the same
+// time and every M steps swap their best individuals, so a multimodal
+// objective is searched from several places at once and an island stuck in
+// a local minimum gets pulled out by better migrants.
+//
+// Each island is a runSearch() search (GwoSearch, PsoSearch) with the
+// migration hooks dimensions(), populationSize(), member(i),
+// memberFitness(i), replaceMember(i, x, f) and bestPosition(), and runs on a
+// thread of its own (pinned to a core on Linux), so the optimizer inside
+// should use serialThreadPool(). Every M steps an island:
+//   - takes the migrants waiting for it, each replacing its worst member if
+//     it is better;
+//   - sends copies of its `migrants` best members to one neighbour: the next
+//     island on a ring, or a random other island.
+// Migrants travel through single-producer single-consumer queues, one per
+// link (K on a ring, K (K - 1) for the random topology). The queues are
+// lock-free and never block: a full queue drops the migrant and an empty
+// one is skipped, so islands never wait for each other and the model scales
+// with the cores. Because of that, a run is not exactly repeatable.
+//
+// With ISLANDS_AS_PROCESSES (unix only) every island is a forked process
+// instead of a thread. The queues, the stop flag and the results live in a
+// shared anonymous mapping set up before the fork, so they work the same
+// way; the Search objects of the calling process are left as they were, and
+// the results and best position come back through the shared block.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "metaheuristic.h"
+#include "rng.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define ISLAND_HAVE_PROCESSES 1
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+enum MigrationTopology
+{
+    MIGRATE_RING,  // island k sends to k + 1
+    MIGRATE_RANDOM // to a random other island each time
+};
+
+enum IslandExecution
+{
+    ISLANDS_AS_THREADS,
+    ISLANDS_AS_PROCESSES // threads where fork() is not available
+};
+
+struct IslandParams
+{
+    size_t migrationInterval; // M, steps between migrations
+    size_t migrants;          // best members sent each time
+    MigrationTopology topology;
+    IslandExecution execution;
+    bool pinThreads;
+    size_t queueCapacity; // migrants a link holds, rounded up to a power of two
+    uint64_t seed;        // random topology
+
+    IslandParams()
+        : migrationInterval(10), migrants(2), topology(MIGRATE_RING), execution(ISLANDS_AS_THREADS),
+          pinThreads(true), queueCapacity(8), seed(1) {}
+};
+
+// Single-producer single-consumer ring of migrants (a fitness and a row of
+// `width` values) laid out in memory it does not own, so it can sit in a
+// block shared between processes. head and tail only grow, each is written
+// by one side only, and they are on separate cache lines.
+class MigrantQueue
+{
+public:
+    MigrantQueue() : head(0), tail(0), slots(0), capacity(0), width(0), slotSize(0) {}
+
+    static size_t slotDoubles(size_t width) { return paddedCount<double>(width + 1); }
+
+    static size_t bytes(size_t capacity, size_t width)
+    {
+        return 2 * CACHE_LINE + capacity * slotDoubles(width) * sizeof(double);
+    }
+
+    // memory: bytes(capacity, width), cache-line aligned; capacity must be
+    // a power of two
+    void attach(void *memory, size_t queueCapacity, size_t rowWidth)
+    {
+        char *p = static_cast<char *>(memory);
+        head = new (p) std::atomic<uint64_t>(0);
+        tail = new (p + CACHE_LINE) std::atomic<uint64_t>(0);
+        slots = reinterpret_cast<double *>(p + 2 * CACHE_LINE);
+        capacity = queueCapacity;
+        width = rowWidth;
+        slotSize = slotDoubles(width);
+    }
+
+    // Producer side; false if the queue is full
+    bool push(const double *row, double fitness)
+    {
+        const uint64_t t = tail->load(std::memory_order_relaxed);
+        if (t - head->load(std::memory_order_acquire) >= capacity)
+            return false;
+        double *slot = slots + (t & (capacity - 1)) * slotSize;
+        slot[0] = fitness;
+        for (size_t d = 0; d < width; d++)
+            slot[d + 1] = row[d];
+        tail->store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false if the queue is empty
+    bool pop(double *row, double &fitness)
+    {
+        const uint64_t h = head->load(std::memory_order_relaxed);
+        if (h == tail->load(std::memory_order_acquire))
+            return false;
+        const double *slot = slots + (h & (capacity - 1)) * slotSize;
+        fitness = slot[0];
+        for (size_t d = 0; d < width; d++)
+            row[d] = slot[d + 1];
+        head->store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::atomic<uint64_t> *head, *tail;
+    double *slots;
+    size_t capacity, width, slotSize;
+};
+
+// Zero-filled, cache-line aligned block: private memory, or an anonymous
+// mapping that forked children share with the parent
+class IslandBlock
+{
+public:
+    IslandBlock() : ptr(0), size(0), mapped(false) {}
+    ~IslandBlock() { release(); }
+
+    IslandBlock(const IslandBlock &) = delete;
+    IslandBlock &operator=(const IslandBlock &) = delete;
+
+    bool allocate(size_t bytes, bool shared)
+    {
+        release();
+        size = bytes;
+#ifdef ISLAND_HAVE_PROCESSES
+        if (shared)
+        {
+            void *p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED)
+                return false;
+            ptr = static_cast<char *>(p);
+            mapped = true;
+            return true;
+        }
+#else
+        (void)shared;
+#endif
+        local = AlignedBuffer<char>(bytes);
+        ptr = local.data();
+        return true;
+    }
+
+    char *data() { return ptr; }
+
+private:
+    char *ptr;
+    size_t size;
+    bool mapped;
+    AlignedBuffer<char> local;
+
+    void release()
+    {
+#ifdef ISLAND_HAVE_PROCESSES
+        if (mapped)
+            munmap(ptr, size);
+#endif
+        local = AlignedBuffer<char>();
+        ptr = 0;
+        mapped = false;
+    }
+};
+
+// Binds the calling thread to the index-th core (modulo the count) of those
+// the process may run on. Linux only; elsewhere a no-op.
+inline void pinCurrentThread(size_t index)
+{
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+        return;
+    size_t skip = index % (size_t)CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (!CPU_ISSET(cpu, &allowed) || skip-- > 0)
+            continue;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        return;
+    }
+#else
+    (void)index;
+#endif
+}
+
+template <typename Search>
+class IslandModel
+{
+public:
+    // The islands must outlive the model and should have different seeds
+    explicit IslandModel(const std::vector<Search *> &islands, const IslandParams &params = IslandParams())
+        : islands(islands), params(params), K(islands.size()), dims(islands.empty() ? 0 : islands[0]->dimensions()),
+          bestIsland_(0), sent(0), accepted(0), outerCancel(0), cancel(0)
+    {
+        capacity = 1;
+        while (capacity < params.queueCapacity)
+            capacity *= 2;
+        rowDoubles = paddedCount<double>(dims);
+        results.resize(K);
+        failed.assign(K, 0);
+        bestRow.resize(rowDoubles);
+    }
+
+    // Runs every island under `limits` and merges their results:
+    //   - maxEvaluations is the budget of the whole model, split evenly;
+    //   - the other limits apply to each island, and with stopAtTarget the
+    //     first island to reach the target stops them all. The islands stop
+    //     on the model's own flag, which limits.cancel is forwarded to;
+    //   - the merged result has the best fitness, the total evaluations, the
+    //     largest iteration count and the wall time; evaluationsToTarget is
+    //     estimated as K times that of the first island to reach it;
+    //   - an island process that crashes or is killed leaves no result: it is
+    //     left out of the merge and counted by failedIslands(). If every
+    //     island failed the merged result has no best fitness (HUGE_VAL).
+    RunResult run(const RunLimits &limits)
+    {
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point begin = Clock::now();
+        RunResult merged;
+        if (K == 0)
+            return merged;
+
+        bool processes = false;
+#ifdef ISLAND_HAVE_PROCESSES
+        processes = params.execution == ISLANDS_AS_PROCESSES;
+#endif
+        if (!setupShared(processes))
+        {
+            // No shared mapping: fall back to threads
+            processes = false;
+            setupShared(false);
+        }
+
+        RunLimits islandLimits = limits;
+        if (limits.maxEvaluations)
+            islandLimits.maxEvaluations = std::max<size_t>(limits.maxEvaluations / K, 1);
+        islandLimits.cancel = cancel;
+        outerCancel = limits.cancel;
+        if (outerCancel && outerCancel->load())
+            cancel->store(true);
+        failed.assign(K, 0);
+
+        if (processes)
+            runProcesses(islandLimits);
+        else
+            runThreads(islandLimits);
+
+        // Merge, leaving out the islands that failed
+        size_t best = K;
+        size_t firstToTarget = K;
+        for (size_t k = 0; k < K; k++)
+        {
+            results[k] = failed[k] ? RunResult() : slot(k)->result;
+            if (failed[k])
+                continue;
+            const RunResult &r = results[k];
+            if (best == K || r.bestFitness < results[best].bestFitness)
+                best = k;
+            merged.evaluations += r.evaluations;
+            merged.iterations = std::max(merged.iterations, r.iterations);
+            if (r.reachedTarget && (firstToTarget == K || r.secondsToTarget < results[firstToTarget].secondsToTarget))
+                firstToTarget = k;
+        }
+        sent = accepted = 0;
+        for (size_t k = 0; k < K; k++)
+        {
+            sent += slot(k)->sent;
+            accepted += slot(k)->accepted;
+        }
+        merged.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        if (best == K)
+        {
+            bestIsland_ = 0;
+            return merged;
+        }
+        bestIsland_ = best;
+        const double *row = slotRow(best);
+        for (size_t d = 0; d < rowDoubles; d++)
+            bestRow[d] = row[d];
+
+        merged.bestFitness = results[best].bestFitness;
+        merged.reason = results[best].reason;
+        if (firstToTarget < K)
+        {
+            merged.reachedTarget = true;
+            merged.secondsToTarget = results[firstToTarget].secondsToTarget;
+            merged.evaluationsToTarget = K * results[firstToTarget].evaluationsToTarget;
+            if (limits.stopAtTarget)
+                merged.reason = STOP_TARGET;
+        }
+        return merged;
+    }
+
+    size_t islandCount() const { return K; }
+    const RunResult &islandResult(size_t k) const { return results[k]; }
+    size_t bestIsland() const { return bestIsland_; }
+    const double *bestPosition() const { return bestRow.data(); }
+    size_t migrantsSent() const { return sent; }
+    size_t migrantsAccepted() const { return accepted; }
+
+    // Islands of the last run whose process crashed, was killed or exited
+    // with an error; their islandResult() is empty
+    bool islandFailed(size_t k) const { return failed[k] != 0; }
+    size_t failedIslands() const { return (size_t)std::count(failed.begin(), failed.end(), 1); }
+
+private:
+    // What each island leaves in the shared block
+    struct IslandSlot
+    {
+        RunResult result;
+        size_t sent, accepted;
+    };
+
+    // runSearch() view of one island that migrates every M steps
+    class Runner
+    {
+    public:
+        Runner(IslandModel &model, size_t k)
+            : model(model), search(*model.islands[k]), k(k), steps(0), rng(model.params.seed, k),
+              row(model.dims ? model.dims : 1) {}
+
+        size_t start() { return search.start(); }
+
+        size_t step(double progress)
+        {
+            const size_t evaluations = search.step(progress);
+            if (model.params.migrationInterval && ++steps % model.params.migrationInterval == 0)
+                migrate();
+            if (model.outerCancel && model.outerCancel->load(std::memory_order_relaxed))
+                model.cancel->store(true);
+            return evaluations;
+        }
+
+        double bestFitness() const { return search.bestFitness(); }
+
+    private:
+        IslandModel &model;
+        Search &search;
+        size_t k, steps;
+        Xoshiro256 rng;
+        std::vector<double> row;
+        std::vector<size_t> order;
+
+        void migrate()
+        {
+            IslandSlot &s = *model.slot(k);
+            const size_t K = model.K, n = search.populationSize();
+            if (K < 2 || n == 0)
+                return;
+
+            // Take what arrived: each migrant replaces the worst member it beats
+            for (size_t from = 0; from < K; from++)
+            {
+                if (from == k || !model.linked(from, k))
+                    continue;
+                MigrantQueue &q = model.queue(from, k);
+                double fitness;
+                while (q.pop(row.data(), fitness))
+                {
+                    size_t worst = 0;
+                    for (size_t i = 1; i < n; i++)
+                        if (search.memberFitness(i) > search.memberFitness(worst))
+                            worst = i;
+                    if (fitness < search.memberFitness(worst))
+                    {
+                        search.replaceMember(worst, row.data(), fitness);
+                        s.accepted++;
+                    }
+                }
+            }
+
+            // Send copies of the best members
+            size_t to = (k + 1) % K;
+            if (model.params.topology == MIGRATE_RANDOM)
+            {
+                to = (size_t)rng.below(K - 1);
+                to += to >= k ? 1 : 0;
+            }
+            const size_t m = std::min(model.params.migrants, n);
+            order.resize(n);
+            for (size_t i = 0; i < n; i++)
+                order[i] = i;
+            const Search &ranked = search;
+            std::partial_sort(order.begin(), order.begin() + m, order.end(), [&ranked](size_t a, size_t b)
+                              { return ranked.memberFitness(a) < ranked.memberFitness(b); });
+            MigrantQueue &q = model.queue(k, to);
+            for (size_t i = 0; i < m; i++)
+                if (q.push(search.member(order[i]), search.memberFitness(order[i])))
+                    s.sent++;
+        }
+    };
+
+    std::vector<Search *> islands;
+    IslandParams params;
+    size_t K, dims, capacity, rowDoubles;
+    std::vector<RunResult> results;
+    AlignedBuffer<double> bestRow;
+    size_t bestIsland_, sent, accepted;
+    std::vector<char> failed;
+    const std::atomic<bool> *outerCancel; // the caller's limits.cancel
+
+    // Shared block: stop flag, K slots, K best rows, then the queues
+    IslandBlock block;
+    std::atomic<bool> *cancel;
+    size_t slotBytes, queueBytes, slotsOffset, rowsOffset, queuesOffset;
+    std::vector<MigrantQueue> queues;
+
+    bool linked(size_t from, size_t to) const
+    {
+        return params.topology == MIGRATE_RANDOM || to == (from + 1) % K;
+    }
+
+    // Ring: one queue per receiver; random: one per ordered pair
+    MigrantQueue &queue(size_t from, size_t to)
+    {
+        return params.topology == MIGRATE_RANDOM ? queues[from * K + to] : queues[to];
+    }
+
+    IslandSlot *slot(size_t k) { return reinterpret_cast<IslandSlot *>(block.data() + slotsOffset + k * slotBytes); }
+
+    double *slotRow(size_t k)
+    {
+        return reinterpret_cast<double *>(block.data() + rowsOffset) + k * rowDoubles;
+    }
+
+    bool setupShared(bool shared)
+    {
+        const size_t queueCount = params.topology == MIGRATE_RANDOM ? K * K : K;
+        slotBytes = (sizeof(IslandSlot) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+        queueBytes = MigrantQueue::bytes(capacity, dims);
+        slotsOffset = CACHE_LINE;
+        rowsOffset = slotsOffset + K * slotBytes;
+        queuesOffset = rowsOffset + K * rowDoubles * sizeof(double);
+        if (!block.allocate(queuesOffset + queueCount * queueBytes, shared))
+            return false;
+        cancel = new (block.data()) std::atomic<bool>(false);
+        for (size_t k = 0; k < K; k++)
+            new (slot(k)) IslandSlot();
+        queues.assign(queueCount, MigrantQueue());
+        for (size_t q = 0; q < queueCount; q++)
+            queues[q].attach(block.data() + queuesOffset + q * queueBytes, capacity, dims);
+        return true;
+    }
+
+    void runIsland(size_t k, const RunLimits &limits)
+    {
+        Runner runner(*this, k);
+        RunResult r = runSearch(runner, limits);
+        if (r.reachedTarget && limits.stopAtTarget)
+            cancel->store(true);
+        slot(k)->result = r;
+        const double *x = islands[k]->bestPosition();
+        double *row = slotRow(k);
+        for (size_t d = 0; d < dims; d++)
+            row[d] = x[d];
+    }
+
+    void runThreads(const RunLimits &limits)
+    {
+        std::vector<std::thread> threads;
+        for (size_t k = 0; k < K; k++)
+            threads.push_back(std::thread([this, k, &limits]()
+                                          {
+                if (params.pinThreads)
+                    pinCurrentThread(k);
+                runIsland(k, limits); }));
+        for (size_t k = 0; k < K; k++)
+            threads[k].join();
+    }
+
+    // One forked child per island; an island whose fork fails runs in this
+    // process once the others have started. A child only sees its own copy
+    // of the caller's cancel flag, so while the children run this process
+    // polls it and passes it on through the shared one.
+    void runProcesses(const RunLimits &limits)
+    {
+#ifdef ISLAND_HAVE_PROCESSES
+        std::vector<pid_t> children(K, 0); // by island; 0 once reaped
+        std::vector<size_t> local;
+        for (size_t k = 0; k < K; k++)
+        {
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                if (params.pinThreads)
+                    pinCurrentThread(k);
+                runIsland(k, limits);
+                _exit(0); // skip the parent's atexit handlers and stream buffers
+            }
+            if (pid > 0)
+                children[k] = pid;
+            else
+                local.push_back(k);
+        }
+        for (size_t i = 0; i < local.size(); i++)
+            runIsland(local[i], limits);
+
+        size_t running = K - local.size();
+        while (running)
+        {
+            for (size_t k = 0; k < K; k++)
+            {
+                if (!children[k])
+                    continue;
+                int status = 0;
+                const pid_t done = waitpid(children[k], &status, outerCancel ? WNOHANG : 0);
+                if (done == 0 || (done < 0 && errno == EINTR))
+                    continue;
+                // A crash, a signal or an error exit leaves the slot unwritten
+                failed[k] = done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+                children[k] = 0;
+                running--;
+            }
+            if (running && outerCancel)
+            {
+                if (outerCancel->load())
+                    cancel->store(true);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+#else
+        runThreads(limits);
+#endif
+    }
+};
+
+#endif // ISLAND_MODEL_H
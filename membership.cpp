@@ -0,0 +1,103 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+
+#include "membership.h"
+#include "membership_cache.h"
+
+using namespace std;
+
+// C++ counterpart of MembershipFUNCCHARTS.ipynb: the same seven membership
+// functions with the notebook's parameters, sampled over the notebook's
+// x range [0, 12], plus the throughput of each batch kernel and of the
+// lookup-table cache for the exp-based shapes.
+
+const size_t SAMPLES = 7;
+const size_t BENCH_POINTS = 4096;
+const int BENCH_REPEATS = 20000;
+
+// Batch evaluations per second of evaluate(x, y, n) on an L1-resident batch
+template <typename Eval>
+double throughput(Eval evaluate)
+{
+    vector<float> bx(BENCH_POINTS), by(BENCH_POINTS);
+    for (size_t i = 0; i < BENCH_POINTS; i++)
+        bx[i] = 12.0f * i / BENCH_POINTS;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int r = 0; r < BENCH_REPEATS; r++)
+        evaluate(bx.data(), by.data(), BENCH_POINTS);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return (double)BENCH_POINTS * BENCH_REPEATS / elapsed.count();
+}
+
+template <typename MF>
+struct BatchEval
+{
+    const MF &mf;
+    void operator()(const float *x, float *y, size_t n) const { evaluateMF(mf, x, y, n); }
+};
+
+template <typename MF>
+void showMF(const string &name, const MF &mf)
+{
+    // Sample the curve at x = 0, 2, ..., 12 through the batch kernel
+    float x[SAMPLES], y[SAMPLES];
+    for (size_t i = 0; i < SAMPLES; i++)
+        x[i] = 2.0f * i;
+    evaluateMF(mf, x, y, SAMPLES);
+    cout << left << setw(14) << name << right;
+    for (size_t i = 0; i < SAMPLES; i++)
+        cout << setw(7) << fixed << setprecision(3) << y[i];
+
+    BatchEval<MF> exact = {mf};
+    cout << setw(10) << setprecision(2) << throughput(exact) / 1e9 << " G evals/s" << endl;
+}
+
+template <typename MF>
+void showCache(const string &name, const MF &mf, float maxError, size_t maxEntries = CACHE_MAX_ENTRIES)
+{
+    CachedMF<MF> cache(mf, maxError, maxEntries);
+    BatchEval<CachedMF<MF> > cached = {cache};
+    cout << left << setw(14) << name << right;
+    if (cache.tabulated())
+        cout << setw(8) << cache.entries() << setw(8) << cache.memoryBytes();
+    else
+        cout << setw(16) << "exact";
+    cout << setw(12) << scientific << setprecision(2) << cache.error()
+         << setw(10) << fixed << setprecision(2) << throughput(cached) / 1e9 << " G evals/s" << endl;
+}
+
+int main()
+{
+    cout << "SIMD: " << simdLevelName(simdLevel()) << endl;
+    cout << left << setw(14) << "x" << right;
+    for (int v = 0; v <= 12; v += 2)
+        cout << setw(7) << v;
+    cout << endl;
+
+    showMF("Triangular", TriangularMF<float>(2, 5, 8));
+    showMF("Trapezoidal", TrapezoidalMF<float>(2, 4, 8, 10));
+    showMF("Gaussian", GaussianMF<float>(6, 1.5));
+    showMF("Bell", BellMF<float>(2, 4, 6));
+    // A non-integer b takes the general 2^(b log2 u^2) path
+    showMF("Bell (b=2.5)", BellMF<float>(2, 2.5f, 6));
+    showMF("Sigmoidal", SigmoidMF<float>(2, 6));
+    showMF("S-function", SFunctionMF<float>(2, 6, 10));
+    showMF("Constant", ConstantMF<float>(0.7f));
+
+    const float maxError = 1e-3f;
+    cout << endl
+         << "Lookup-table cache, max error " << scientific << setprecision(0) << maxError << endl;
+    cout << left << setw(14) << "MF" << right << setw(8) << "entries" << setw(8) << "bytes" << setw(12) << "error" << endl;
+    showCache("Gaussian", GaussianMF<float>(6, 1.5), maxError);
+    showCache("Bell", BellMF<float>(2, 4, 6), maxError);
+    showCache("Bell (b=2.5)", BellMF<float>(2, 2.5f, 6), maxError);
+    showCache("Sigmoidal", SigmoidMF<float>(2, 6), maxError);
+    // Capped at the AVX2 register size the bound is out of reach: exact
+    showCache("Gaussian", GaussianMF<float>(6, 1.5), maxError, CACHE_REGISTER_ENTRIES_AVX2);
+    showCache("Bell", BellMF<float>(2, 4, 6), maxError, CACHE_REGISTER_ENTRIES_AVX2);
+    showCache("Sigmoidal", SigmoidMF<float>(2, 6), maxError, CACHE_REGISTER_ENTRIES_AVX2);
+
+    return 0;
+}
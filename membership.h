@@ -0,0 +1,489 @@
+#ifndef MEMBERSHIP_H
+#define MEMBERSHIP_H
+
+// Membership functions from MembershipFUNCCHARTS.ipynb, ported to C++ with
+// batch evaluation over contiguous arrays:
+//
+//   TriangularMF(a, b, c)       TrapezoidalMF(a, b, c, d)   GaussianMF(c, sigma)
+//   BellMF(a, b, c)             SigmoidMF(a, c)             SFunctionMF(a, b, c)
+//   ConstantMF(k)
+//
+// Every shape is written branch-free (min/max and selects instead of the
+// notebook's per-element if/else), and exp/log use the polynomial fastExp /
+// fastLog below instead of libm calls, so evaluate() compiles to straight
+// SIMD code. As with fuzzy_expr.h, the batch loop is strip-mined, compiled
+// for each ISA and picked at runtime.
+//
+// MembershipFunction is the same set of shapes as one tagged struct, for
+// code that reads MF definitions from data (e.g. an inference rule base).
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+
+#include "bit_cast.h"
+#include "fuzzy_kernels.h"
+
+// e^x with relative error below 2e-7 (float) / 1e-15 (double). The exponent
+// is rounded with the 1.5 * 2^mantissa-bits trick and 2^n is built directly
+// in the exponent field, so there is no float->int conversion to serialize
+// the vector loop. Inputs are clamped to the finite range.
+inline float fastExp(float x)
+{
+    const float magic = 12582912.0f; // 1.5 * 2^23
+    x = x < -87.0f ? -87.0f : x;
+    x = x > 88.0f ? 88.0f : x;
+    float r = x * 1.44269504088896341f + magic;
+    int32_t n = bitCast<int32_t>(r) - bitCast<int32_t>(magic);
+    float fn = r - magic;
+    float f = x - fn * 0.693145751953125f - fn * 1.42860682030941723e-6f;
+    float p = 1.0f + f * (1.0f + f * (0.5f + f * (1.66666672e-1f + f * (4.16666679e-2f + f * (8.33333377e-3f + f * 1.38888892e-3f)))));
+    return p * bitCast<float>((n + 127) << 23);
+}
+
+inline double fastExp(double x)
+{
+    const double magic = 6755399441055744.0; // 1.5 * 2^52
+    x = x < -708.0 ? -708.0 : x;
+    x = x > 709.0 ? 709.0 : x;
+    double r = x * 1.4426950408889634 + magic;
+    int64_t n = bitCast<int64_t>(r) - bitCast<int64_t>(magic);
+    double fn = r - magic;
+    double f = x - fn * 0.6931471803691238 - fn * 1.9082149292705877e-10;
+    double p = 1.0 / 39916800.0;
+    p = p * f + 1.0 / 3628800.0;
+    p = p * f + 1.0 / 362880.0;
+    p = p * f + 1.0 / 40320.0;
+    p = p * f + 1.0 / 5040.0;
+    p = p * f + 1.0 / 720.0;
+    p = p * f + 1.0 / 120.0;
+    p = p * f + 1.0 / 24.0;
+    p = p * f + 1.0 / 6.0;
+    p = p * f + 0.5;
+    p = p * f + 1.0;
+    p = p * f + 1.0;
+    return p * bitCast<double>((n + 1023) << 52);
+}
+
+// Natural log for x > 0 (x = 0 gives a large negative number, not -inf).
+// Splits x into 2^e * m with m in [sqrt(1/2), sqrt(2)) using integer
+// arithmetic on the bits (offsetting by the bits of sqrt(1/2) makes the
+// exponent field carry over exactly at the right point), then evaluates
+// log(m) = 2 atanh((m - 1) / (m + 1)) as an odd series.
+inline float fastLog(float x)
+{
+    int32_t bits = bitCast<int32_t>(x);
+    int32_t e = (bits - 0x3f3504f3) >> 23;
+    float m = bitCast<float>(bits - (e << 23));
+    float fe = (float)e;
+    float s = (m - 1.0f) / (m + 1.0f);
+    float s2 = s * s;
+    float p = s * (2.0f + s2 * (0.666666667f + s2 * (0.4f + s2 * (0.285714286f + s2 * 0.222222222f))));
+    return p + fe * 0.693147180559945f;
+}
+
+inline double fastLog(double x)
+{
+    int64_t bits = bitCast<int64_t>(x);
+    int64_t e = (bits - 0x3fe6a09e667f3bcdLL) >> 52;
+    double m = bitCast<double>(bits - (e << 52));
+    double fe = (double)e;
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double p = 2.0 / 21.0;
+    p = p * s2 + 2.0 / 19.0;
+    p = p * s2 + 2.0 / 17.0;
+    p = p * s2 + 2.0 / 15.0;
+    p = p * s2 + 2.0 / 13.0;
+    p = p * s2 + 2.0 / 11.0;
+    p = p * s2 + 2.0 / 9.0;
+    p = p * s2 + 2.0 / 7.0;
+    p = p * s2 + 2.0 / 5.0;
+    p = p * s2 + 2.0 / 3.0;
+    p = p * s2 + 2.0;
+    return p * s + fe * 0.6931471805599453;
+}
+
+// 2^x and log2(x) for code that only needs a power: x^y = 2^(y log2 x)
+// without the ln 2 scalings of fastExp(y * fastLog(x)). The float versions
+// are polynomial fits: 2^f on [-1/2, 1/2] (relative error 2e-7) and
+// log2(1 + f) / f on fastLog's mantissa range (error 1e-7), so unlike
+// fastLog there is no division.
+inline float fastExp2(float x)
+{
+    const float magic = 12582912.0f; // 1.5 * 2^23
+    x = x < -126.0f ? -126.0f : x;
+    x = x > 127.0f ? 127.0f : x;
+    float r = x + magic;
+    int32_t n = bitCast<int32_t>(r) - bitCast<int32_t>(magic);
+    float f = x - (r - magic);
+    float p = 1.33908634e-3f;
+    p = p * f + 9.67603192e-3f;
+    p = p * f + 5.55035711e-2f;
+    p = p * f + 2.40221075e-1f;
+    p = p * f + 6.93147188e-1f;
+    p = p * f + 1.00000008f;
+    return p * bitCast<float>((n + 127) << 23);
+}
+
+inline double fastExp2(double x)
+{
+    return fastExp(x * 0.6931471805599453);
+}
+
+inline float fastLog2(float x)
+{
+    int32_t bits = bitCast<int32_t>(x);
+    int32_t e = (bits - 0x3f3504f3) >> 23;
+    float f = bitCast<float>(bits - (e << 23)) - 1.0f;
+    float p = -0.142759734f;
+    p = p * f + 0.232652579f;
+    p = p * f - 0.249271822f;
+    p = p * f + 0.287288882f;
+    p = p * f - 0.360225182f;
+    p = p * f + 0.480916708f;
+    p = p * f - 0.721352931f;
+    p = p * f + 1.44269499f;
+    return p * f + (float)e;
+}
+
+inline double fastLog2(double x)
+{
+    return fastLog(x) * 1.4426950408889634;
+}
+
+template <typename T>
+T clamp01(T v)
+{
+    v = v > T(0) ? v : T(0);
+    return v < T(1) ? v : T(1);
+}
+
+// Slopes are stored as reciprocals; a vertical edge (a == b) gets a huge
+// slope instead of a division by zero, plus a bias of 1 so that the edge
+// point itself is in the set (shoulder terms like trapezoidal(0, 0, 10, 20)).
+template <typename T>
+T inverseWidth(T lo, T hi)
+{
+    return hi > lo ? T(1) / (hi - lo) : T(1e30);
+}
+
+template <typename T>
+T edgeBias(T lo, T hi)
+{
+    return hi > lo ? T(0) : T(1);
+}
+
+template <typename T = float>
+struct TriangularMF
+{
+    typedef T value_type;
+    T a, b, c, invLeft, invRight, biasLeft, biasRight;
+
+    TriangularMF(T a, T b, T c)
+        : a(a), b(b), c(c), invLeft(inverseWidth(a, b)), invRight(inverseWidth(b, c)),
+          biasLeft(edgeBias(a, b)), biasRight(edgeBias(b, c)) {}
+
+    T operator()(T x) const
+    {
+        T up = (x - a) * invLeft + biasLeft;
+        T down = (c - x) * invRight + biasRight;
+        T v = up < down ? up : down;
+        return v > T(0) ? v : T(0);
+    }
+};
+
+template <typename T = float>
+struct TrapezoidalMF
+{
+    typedef T value_type;
+    T a, b, c, d, invLeft, invRight, biasLeft, biasRight;
+
+    TrapezoidalMF(T a, T b, T c, T d)
+        : a(a), b(b), c(c), d(d), invLeft(inverseWidth(a, b)), invRight(inverseWidth(c, d)),
+          biasLeft(edgeBias(a, b)), biasRight(edgeBias(c, d)) {}
+
+    T operator()(T x) const
+    {
+        T up = (x - a) * invLeft + biasLeft;
+        T down = (d - x) * invRight + biasRight;
+        T v = up < down ? up : down;
+        return clamp01(v);
+    }
+};
+
+template <typename T = float>
+struct GaussianMF
+{
+    typedef T value_type;
+    T c, sigma, k; // k = -1 / (2 sigma^2)
+
+    GaussianMF(T c, T sigma) : c(c), sigma(sigma), k(T(-1) / (T(2) * sigma * sigma)) {}
+
+    T operator()(T x) const
+    {
+        T u = x - c;
+        return fastExp(k * u * u);
+    }
+};
+
+// 1 / (1 + |(x - c) / a|^(2b)), with the power done as 2^(b * log2(u^2))
+template <typename T = float>
+struct BellMF
+{
+    typedef T value_type;
+    T a, b, c, invA;
+
+    BellMF(T a, T b, T c) : a(a), b(b), c(c), invA(T(1) / a) {}
+
+    T operator()(T x) const
+    {
+        T u = (x - c) * invA;
+        T u2 = u * u + T(1e-30); // keeps log finite at the centre
+        return T(1) / (T(1) + fastExp2(b * fastLog2(u2)));
+    }
+};
+
+// BellMF with an integer b in [1, 15] (the usual case): u^(2b) by repeated
+// squaring of u^2, picking the squares from b's bits. Those selects are loop
+// invariant, so this is four multiplies instead of a log and an exp.
+// evaluateMF() switches to it automatically.
+template <typename T = float>
+struct BellPowerMF
+{
+    typedef T value_type;
+    T c, invA;
+    int b;
+
+    explicit BellPowerMF(const BellMF<T> &mf) : c(mf.c), invA(mf.invA), b((int)mf.b) {}
+
+    static bool fits(const BellMF<T> &mf) { return mf.b >= T(1) && mf.b <= T(15) && mf.b == T((int)mf.b); }
+
+    T operator()(T x) const
+    {
+        T u = (x - c) * invA;
+        T p = u * u;
+        T r = (b & 1) ? p : T(1);
+        p = p * p;
+        r = r * ((b & 2) ? p : T(1));
+        p = p * p;
+        r = r * ((b & 4) ? p : T(1));
+        p = p * p;
+        r = r * ((b & 8) ? p : T(1));
+        return T(1) / (T(1) + r);
+    }
+};
+
+template <typename T = float>
+struct SigmoidMF
+{
+    typedef T value_type;
+    T a, c;
+
+    SigmoidMF(T a, T c) : a(a), c(c) {}
+
+    T operator()(T x) const
+    {
+        return T(1) / (T(1) + fastExp(-a * (x - c)));
+    }
+};
+
+// Zadeh's S-function exactly as the notebook defines it: 0 up to a, then
+// 2((x - a)/(c - a))^2 up to b, 1 - 2((c - x)/(c - a))^2 up to c, then 1
+template <typename T = float>
+struct SFunctionMF
+{
+    typedef T value_type;
+    T a, b, c, invWidth;
+
+    SFunctionMF(T a, T b, T c) : a(a), b(b), c(c), invWidth(inverseWidth(a, c)) {}
+
+    T operator()(T x) const
+    {
+        T lo = (x - a) * invWidth;
+        T hi = (c - x) * invWidth;
+        T rising = T(2) * lo * lo;
+        T falling = T(1) - T(2) * hi * hi;
+        T v = x <= b ? rising : falling;
+        v = x <= a ? T(0) : v;
+        return x >= c ? T(1) : v;
+    }
+};
+
+template <typename T = float>
+struct ConstantMF
+{
+    typedef T value_type;
+    T k;
+
+    explicit ConstantMF(T k) : k(k) {}
+
+    T operator()(T) const { return k; }
+};
+
+// Batch loop: y[i] = mf(x[i]). Strip-mined with a restrict output so GCC
+// vectorizes the inlined shape at -O2; compiled once per ISA.
+static const size_t MF_STRIP = 64;
+
+#define MEMBERSHIP_DEFINE_BATCH_LOOP(NAME, ATTR)                                          \
+    template <typename MF, typename T>                                                   \
+    ATTR void evaluateMF##NAME(const MF &mf, const T *x, T *__restrict y, size_t n)     \
+    {                                                                                    \
+        const size_t blocked = n - n % MF_STRIP;                                         \
+        size_t i = 0;                                                                    \
+        for (; i < blocked; i += MF_STRIP)                                               \
+            for (size_t j = 0; j < MF_STRIP; ++j)                                        \
+                y[i + j] = mf(x[i + j]);                                                 \
+        for (; i < n; ++i)                                                               \
+            y[i] = mf(x[i]);                                                             \
+    }
+
+MEMBERSHIP_DEFINE_BATCH_LOOP(Default, )
+#ifdef FUZZY_X86
+MEMBERSHIP_DEFINE_BATCH_LOOP(Avx2, FUZZY_TARGET("avx2,fma"))
+MEMBERSHIP_DEFINE_BATCH_LOOP(Avx512, FUZZY_TARGET("avx512f,avx512dq"))
+#endif
+
+#undef MEMBERSHIP_DEFINE_BATCH_LOOP
+
+// y[i] = mf(x[i]) for i < n; y must not overlap x
+template <typename MF, typename T>
+void evaluateMF(const MF &mf, const T *x, T *y, size_t n)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        evaluateMFAvx512(mf, x, y, n);
+        return;
+    case SIMD_AVX2:
+        evaluateMFAvx2(mf, x, y, n);
+        return;
+    default:
+        break;
+    }
+#endif
+    evaluateMFDefault(mf, x, y, n);
+}
+
+template <typename T>
+void evaluateMF(const BellMF<T> &mf, const T *x, T *y, size_t n)
+{
+    if (BellPowerMF<T>::fits(mf))
+        evaluateMF(BellPowerMF<T>(mf), x, y, n);
+    else
+        evaluateMF<BellMF<T>, T>(mf, x, y, n);
+}
+
+enum MFType
+{
+    MF_TRIANGULAR,
+    MF_TRAPEZOIDAL,
+    MF_GAUSSIAN,
+    MF_BELL,
+    MF_SIGMOID,
+    MF_SFUNCTION,
+    MF_CONSTANT
+};
+
+// Number of parameters each MFType takes, in notebook order
+inline int mfParamCount(MFType type)
+{
+    static const int counts[] = {3, 4, 2, 3, 2, 3, 1};
+    return counts[type];
+}
+
+// Parses "triangular", "trapezoidal", "gaussian", "bell", "sigmoid",
+// "sfunction" or "constant"; returns false for anything else
+inline bool parseMFType(const std::string &name, MFType &type)
+{
+    static const char *names[] = {"triangular", "trapezoidal", "gaussian", "bell", "sigmoid", "sfunction", "constant"};
+    for (int t = 0; t <= MF_CONSTANT; t++)
+    {
+        if (name == names[t])
+        {
+            type = (MFType)t;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Any of the shapes above as one flat value type (type tag + parameters)
+struct MembershipFunction
+{
+    MFType type;
+    float p[4];
+
+    MembershipFunction() : type(MF_CONSTANT)
+    {
+        p[0] = p[1] = p[2] = p[3] = 0.0f;
+    }
+
+    MembershipFunction(MFType type, float p0, float p1 = 0.0f, float p2 = 0.0f, float p3 = 0.0f) : type(type)
+    {
+        p[0] = p0;
+        p[1] = p1;
+        p[2] = p2;
+        p[3] = p3;
+    }
+
+    float operator()(float x) const
+    {
+        switch (type)
+        {
+        case MF_TRIANGULAR:
+            return TriangularMF<float>(p[0], p[1], p[2])(x);
+        case MF_TRAPEZOIDAL:
+            return TrapezoidalMF<float>(p[0], p[1], p[2], p[3])(x);
+        case MF_GAUSSIAN:
+            return GaussianMF<float>(p[0], p[1])(x);
+        case MF_BELL:
+            return BellMF<float>(p[0], p[1], p[2])(x);
+        case MF_SIGMOID:
+            return SigmoidMF<float>(p[0], p[1])(x);
+        case MF_SFUNCTION:
+            return SFunctionMF<float>(p[0], p[1], p[2])(x);
+        default:
+            return p[0];
+        }
+    }
+
+    // Switches on the type once per batch, then runs the typed SIMD loop
+    void evaluate(const float *x, float *y, size_t n) const
+    {
+        switch (type)
+        {
+        case MF_TRIANGULAR:
+            evaluateMF(TriangularMF<float>(p[0], p[1], p[2]), x, y, n);
+            break;
+        case MF_TRAPEZOIDAL:
+            evaluateMF(TrapezoidalMF<float>(p[0], p[1], p[2], p[3]), x, y, n);
+            break;
+        case MF_GAUSSIAN:
+            evaluateMF(GaussianMF<float>(p[0], p[1]), x, y, n);
+            break;
+        case MF_BELL:
+            evaluateMF(BellMF<float>(p[0], p[1], p[2]), x, y, n);
+            break;
+        case MF_SIGMOID:
+            evaluateMF(SigmoidMF<float>(p[0], p[1]), x, y, n);
+            break;
+        case MF_SFUNCTION:
+            evaluateMF(SFunctionMF<float>(p[0], p[1], p[2]), x, y, n);
+            break;
+        default:
+            evaluateMF(ConstantMF<float>(p[0]), x, y, n);
+            break;
+        }
+    }
+};
+
+inline void evaluateMF(const MembershipFunction &mf, const float *x, float *y, size_t n)
+{
+    mf.evaluate(x, y, n);
+}
+
+#endif // MEMBERSHIP_H
@@ -0,0 +1,497 @@
+#ifndef MEMBERSHIP_CACHE_H
+#define MEMBERSHIP_CACHE_H
+
+// Lookup-table cache for the membership functions in membership.h. The MF
+// is sampled once on a uniform grid and evaluated afterwards by linear
+// interpolation between the two neighbouring samples, so gaussian, bell and
+// sigmoid cost a multiply-add and two table loads instead of exp/log.
+//
+// The grid is sized from a maximum absolute error: starting from a small
+// table it doubles the number of samples until the interpolation error,
+// measured against the MF itself at CACHE_CHECK_POINTS points inside every
+// interval, is within the bound. Outside the tabulated range the cache
+// returns the end samples; the range is chosen (mfCacheRange) so that the
+// MF is within the bound of its asymptote there. Shapes symmetric about a
+// centre (gaussian, bell; mfCacheCenter) are tabulated on one side only and
+// looked up at |x - c|, which halves the table. The piecewise shapes
+// (triangular, trapezoidal) are cheaper to evaluate exactly; their kinks
+// rarely fall on the grid and need much larger tables.
+//
+// A cache is a drop-in for exact evaluation: it never returns values
+// further than the bound from the MF, and it is never slower than the exact
+// kernels of membership.h. A lookup only beats them while the table sits in
+// registers: up to 32 float samples on AVX2 and 128 on AVX-512 (on AVX-512
+// about 3.5 G evals/s at 64 samples and 2 at 128, vs 2-3 for exact gaussian
+// and sigmoid, 1 for bell and 3.5 for bell with an integer b). A larger
+// table would need gathers, which are slower than the MF, so on AVX2 /
+// AVX-512 it is kept for operator() only and batches go to the exact
+// kernel; the scalar and SSE2 paths still use it. Integer-b bell batches
+// always go to the exact kernel (mfCacheBatchExact). If the bound cannot be met within maxEntries samples there is no
+// table at all and every call is exact; tabulated() tells which.
+//
+//   CachedMF<GaussianMF<float> > g(GaussianMF<float>(6, 1.5), 1e-3f); // 64 samples
+//   g.evaluate(x, y, n);        // same interface as evaluateMF(mf, x, y, n)
+//   g.memoryBytes();            // table footprint
+
+#include <cmath>
+#include <cstddef>
+
+#include "aligned_buffer.h"
+#include "membership.h"
+
+static const size_t CACHE_CHECK_POINTS = 32;
+static const size_t CACHE_MIN_ENTRIES = 16;
+static const size_t CACHE_MAX_ENTRIES = size_t(1) << 20;
+
+// [lo, hi] outside of which mf stays within tol of its value at the nearer
+// end. Piecewise shapes are exact at their support; smooth shapes are cut
+// where their tail is below tol.
+template <typename T>
+void mfCacheRange(const TriangularMF<T> &mf, T, T &lo, T &hi)
+{
+    lo = mf.a;
+    hi = mf.c;
+}
+
+template <typename T>
+void mfCacheRange(const TrapezoidalMF<T> &mf, T, T &lo, T &hi)
+{
+    lo = mf.a;
+    hi = mf.d;
+}
+
+template <typename T>
+void mfCacheRange(const GaussianMF<T> &mf, T tol, T &lo, T &hi)
+{
+    // exp(-u^2 / (2 sigma^2)) <= tol  for  |u| >= sigma sqrt(-2 ln tol)
+    T r = std::fabs(mf.sigma) * std::sqrt(T(-2) * std::log(tol));
+    lo = mf.c - r;
+    hi = mf.c + r;
+}
+
+template <typename T>
+void mfCacheRange(const BellMF<T> &mf, T tol, T &lo, T &hi)
+{
+    // 1 / (1 + |u / a|^(2b)) <= tol  for  |u| >= |a| (1 / tol)^(1 / 2b)
+    T r = std::fabs(mf.a) * std::pow(T(1) / tol, T(1) / (T(2) * std::fabs(mf.b)));
+    lo = mf.c - r;
+    hi = mf.c + r;
+}
+
+template <typename T>
+void mfCacheRange(const SigmoidMF<T> &mf, T tol, T &lo, T &hi)
+{
+    // within tol of 0 or 1 once |a (x - c)| >= ln(1 / tol)
+    T r = mf.a != T(0) ? std::log(T(1) / tol) / std::fabs(mf.a) : T(1);
+    lo = mf.c - r;
+    hi = mf.c + r;
+}
+
+template <typename T>
+void mfCacheRange(const SFunctionMF<T> &mf, T, T &lo, T &hi)
+{
+    lo = mf.a;
+    hi = mf.c;
+}
+
+template <typename T>
+void mfCacheRange(const ConstantMF<T> &, T, T &lo, T &hi)
+{
+    lo = T(0);
+    hi = T(1);
+}
+
+inline void mfCacheRange(const MembershipFunction &mf, float tol, float &lo, float &hi)
+{
+    const float *p = mf.p;
+    switch (mf.type)
+    {
+    case MF_TRIANGULAR:
+        mfCacheRange(TriangularMF<float>(p[0], p[1], p[2]), tol, lo, hi);
+        break;
+    case MF_TRAPEZOIDAL:
+        mfCacheRange(TrapezoidalMF<float>(p[0], p[1], p[2], p[3]), tol, lo, hi);
+        break;
+    case MF_GAUSSIAN:
+        mfCacheRange(GaussianMF<float>(p[0], p[1]), tol, lo, hi);
+        break;
+    case MF_BELL:
+        mfCacheRange(BellMF<float>(p[0], p[1], p[2]), tol, lo, hi);
+        break;
+    case MF_SIGMOID:
+        mfCacheRange(SigmoidMF<float>(p[0], p[1]), tol, lo, hi);
+        break;
+    case MF_SFUNCTION:
+        mfCacheRange(SFunctionMF<float>(p[0], p[1], p[2]), tol, lo, hi);
+        break;
+    default:
+        mfCacheRange(ConstantMF<float>(p[0]), tol, lo, hi);
+        break;
+    }
+}
+
+// Centre c of shapes with mf(c - u) == mf(c + u); false for the others
+template <typename MF, typename T>
+bool mfCacheCenter(const MF &, T &)
+{
+    return false;
+}
+
+template <typename T>
+bool mfCacheCenter(const GaussianMF<T> &mf, T &center)
+{
+    center = mf.c;
+    return true;
+}
+
+template <typename T>
+bool mfCacheCenter(const BellMF<T> &mf, T &center)
+{
+    center = mf.c;
+    return true;
+}
+
+inline bool mfCacheCenter(const MembershipFunction &mf, float &center)
+{
+    switch (mf.type)
+    {
+    case MF_GAUSSIAN:
+        center = mf.p[0];
+        return true;
+    case MF_BELL:
+        center = mf.p[2];
+        return true;
+    default:
+        return false;
+    }
+}
+
+// True when the exact batch kernel of mf beats any table lookup, so batches
+// skip the table: bell with an integer b runs as BellPowerMF, a few
+// multiplies per point (operator() still interpolates)
+template <typename MF>
+bool mfCacheBatchExact(const MF &)
+{
+    return false;
+}
+
+template <typename T>
+bool mfCacheBatchExact(const BellMF<T> &mf)
+{
+    return BellPowerMF<T>::fits(mf);
+}
+
+inline bool mfCacheBatchExact(const MembershipFunction &mf)
+{
+    return mf.type == MF_BELL && BellPowerMF<float>::fits(BellMF<float>(mf.p[0], mf.p[1], mf.p[2]));
+}
+
+// Float MFs report float as their value type; MembershipFunction has none
+template <typename MF>
+struct MFValueType
+{
+    typedef typename MF::value_type type;
+};
+
+template <>
+struct MFValueType<MembershipFunction>
+{
+    typedef float type;
+};
+
+// Branch-free table lookup: clamp to the grid, split into index and
+// fraction, lerp. The last sample has a zero delta, so u == last needs no
+// clamp on the index, and a NaN x lands on sample 0 rather than out of range.
+// FOLD looks a symmetric shape up at lo + |x - lo|.
+template <bool FOLD, typename T>
+T interpolateTable(const T *values, const T *deltas, T lo, T invStep, T last, T x)
+{
+    T d = x - lo;
+    d = FOLD ? std::fabs(d) : d;
+    T u = d * invStep;
+    u = u > T(0) ? u : T(0);
+    u = u < last ? u : last;
+    int i = (int)u;
+    T frac = u - (T)i;
+    return values[i] + frac * deltas[i];
+}
+
+// Batch lookup for the scalar and SSE2 paths (no gathers there; on AVX2 /
+// AVX-512 a table too large for registers loses to the exact kernel)
+template <bool FOLD, typename T>
+void interpolateTableLoop(const T *values, const T *deltas, T lo, T invStep, T last, const T *x, T *y, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        y[i] = interpolateTable<FOLD>(values, deltas, lo, invStep, last, x[i]);
+}
+
+// Small float tables skip the gathers: a table of up to 32 samples (AVX2)
+// or 128 (AVX-512) sits in registers, in chunks of 8 or 32 entries. Every
+// chunk is permuted by the low index bits and the right one is blended in,
+// which is what makes a cache faster than the exact exp-based kernels.
+static const size_t CACHE_REGISTER_ENTRIES_AVX2 = 32;
+static const size_t CACHE_REGISTER_ENTRIES_AVX512 = 128;
+
+#ifdef FUZZY_X86
+template <bool FOLD, int CHUNKS>
+FUZZY_TARGET("avx2,fma")
+void interpolateRegistersAvx2(const float *table, const float *tableDeltas, size_t entries, float lo, float invStep,
+                              float last, const float *x, float *y, size_t n)
+{
+    float v[8 * CHUNKS] = {0}, d[8 * CHUNKS] = {0};
+    for (size_t e = 0; e < entries; e++)
+    {
+        v[e] = table[e];
+        d[e] = tableDeltas[e];
+    }
+    __m256 vr[CHUNKS], dr[CHUNKS];
+    for (int c = 0; c < CHUNKS; c++)
+    {
+        vr[c] = _mm256_loadu_ps(v + 8 * c);
+        dr[c] = _mm256_loadu_ps(d + 8 * c);
+    }
+    const __m256 vlo = _mm256_set1_ps(lo), vinv = _mm256_set1_ps(invStep), vlast = _mm256_set1_ps(last);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        // max(u, 0) with u first returns 0 for a NaN u, as interpolateTable
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(x + i), vlo);
+        d = FOLD ? _mm256_andnot_ps(_mm256_set1_ps(-0.0f), d) : d;
+        __m256 u = _mm256_mul_ps(d, vinv);
+        u = _mm256_min_ps(_mm256_max_ps(u, _mm256_setzero_ps()), vlast);
+        const __m256i idx = _mm256_cvttps_epi32(u);
+        const __m256 frac = _mm256_sub_ps(u, _mm256_cvtepi32_ps(idx));
+        __m256 value = _mm256_permutevar8x32_ps(vr[0], idx), delta = _mm256_permutevar8x32_ps(dr[0], idx);
+        for (int c = 1; c < CHUNKS; c++)
+        {
+            const __m256 in = _mm256_castsi256_ps(_mm256_cmpgt_epi32(idx, _mm256_set1_epi32(8 * c - 1)));
+            value = _mm256_blendv_ps(value, _mm256_permutevar8x32_ps(vr[c], idx), in);
+            delta = _mm256_blendv_ps(delta, _mm256_permutevar8x32_ps(dr[c], idx), in);
+        }
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(frac, delta, value));
+    }
+    for (; i < n; ++i)
+        y[i] = interpolateTable<FOLD>(v, d, lo, invStep, last, x[i]);
+}
+
+template <bool FOLD, int CHUNKS>
+FUZZY_TARGET("avx512f")
+void interpolateRegistersAvx512(const float *table, const float *tableDeltas, size_t entries, float lo,
+                                float invStep, float last, const float *x, float *y, size_t n)
+{
+    float v[32 * CHUNKS] = {0}, d[32 * CHUNKS] = {0};
+    for (size_t e = 0; e < entries; e++)
+    {
+        v[e] = table[e];
+        d[e] = tableDeltas[e];
+    }
+    __m512 vr[2 * CHUNKS], dr[2 * CHUNKS];
+    for (int c = 0; c < 2 * CHUNKS; c++)
+    {
+        vr[c] = _mm512_loadu_ps(v + 16 * c);
+        dr[c] = _mm512_loadu_ps(d + 16 * c);
+    }
+    const __m512 vlo = _mm512_set1_ps(lo), vinv = _mm512_set1_ps(invStep), vlast = _mm512_set1_ps(last);
+    for (size_t i = 0; i < n; i += 16)
+    {
+        const __mmask16 m = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, x + i), vlo);
+        d = FOLD ? _mm512_abs_ps(d) : d;
+        __m512 u = _mm512_mul_ps(d, vinv);
+        u = _mm512_min_ps(_mm512_max_ps(u, _mm512_setzero_ps()), vlast);
+        const __m512i idx = _mm512_cvttps_epi32(u);
+        const __m512 frac = _mm512_sub_ps(u, _mm512_cvtepi32_ps(idx));
+        __m512 value = _mm512_permutex2var_ps(vr[0], idx, vr[1]);
+        __m512 delta = _mm512_permutex2var_ps(dr[0], idx, dr[1]);
+        for (int c = 1; c < CHUNKS; c++)
+        {
+            const __mmask16 in = _mm512_cmpge_epi32_mask(idx, _mm512_set1_epi32(32 * c));
+            value = _mm512_mask_blend_ps(in, value, _mm512_permutex2var_ps(vr[2 * c], idx, vr[2 * c + 1]));
+            delta = _mm512_mask_blend_ps(in, delta, _mm512_permutex2var_ps(dr[2 * c], idx, dr[2 * c + 1]));
+        }
+        _mm512_mask_storeu_ps(y + i, m, _mm512_fmadd_ps(frac, delta, value));
+    }
+}
+#endif
+
+// The register path when the ISA and table size allow; false otherwise
+template <bool FOLD>
+bool interpolateInRegisters(const float *values, const float *deltas, size_t entries, float lo, float invStep,
+                            float last, const float *x, float *y, size_t n)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        if (entries <= 32)
+            interpolateRegistersAvx512<FOLD, 1>(values, deltas, entries, lo, invStep, last, x, y, n);
+        else if (entries <= 64)
+            interpolateRegistersAvx512<FOLD, 2>(values, deltas, entries, lo, invStep, last, x, y, n);
+        else if (entries <= CACHE_REGISTER_ENTRIES_AVX512)
+            interpolateRegistersAvx512<FOLD, 4>(values, deltas, entries, lo, invStep, last, x, y, n);
+        else
+            return false;
+        return true;
+    case SIMD_AVX2:
+        if (entries <= 16)
+            interpolateRegistersAvx2<FOLD, 2>(values, deltas, entries, lo, invStep, last, x, y, n);
+        else if (entries <= CACHE_REGISTER_ENTRIES_AVX2)
+            interpolateRegistersAvx2<FOLD, 4>(values, deltas, entries, lo, invStep, last, x, y, n);
+        else
+            return false;
+        return true;
+    default:
+        break;
+    }
+#endif
+    (void)values, (void)deltas, (void)entries, (void)lo, (void)invStep, (void)last, (void)x, (void)y, (void)n;
+    return false;
+}
+
+template <bool FOLD, typename T>
+bool interpolateInRegisters(const T *, const T *, size_t, T, T, T, const T *, T *, size_t)
+{
+    return false;
+}
+
+template <typename MF>
+class CachedMF
+{
+public:
+    typedef typename MFValueType<MF>::type value_type;
+    typedef value_type T;
+
+    // Tabulates mf so that |cached(x) - mf(x)| <= maxError everywhere; if
+    // that takes more than maxEntries samples, evaluates mf exactly instead
+    CachedMF(const MF &mf, T maxError, size_t maxEntries = CACHE_MAX_ENTRIES)
+        : mf(mf), batchExact(mfCacheBatchExact(mf))
+    {
+        T lo, hi;
+        // Half the budget for the tails; both end samples and the true tail
+        // lie within tol of the asymptote
+        mfCacheRange(mf, maxError / T(2), lo, hi);
+        T center;
+        fold = mfCacheCenter(mf, center) && center > lo && center < hi;
+        build(fold ? center : lo, hi, maxError, maxEntries);
+    }
+
+    // Explicit range; outside [lo, hi] the end samples are returned
+    CachedMF(const MF &mf, T lo, T hi, T maxError, size_t maxEntries = CACHE_MAX_ENTRIES)
+        : mf(mf), fold(false), batchExact(mfCacheBatchExact(mf))
+    {
+        build(lo, hi, maxError, maxEntries);
+    }
+
+    T operator()(T x) const
+    {
+        if (!tabulated())
+            return mf(x);
+        return fold ? interpolateTable<true>(values.data(), deltas.data(), lo, invStep, last, x)
+                    : interpolateTable<false>(values.data(), deltas.data(), lo, invStep, last, x);
+    }
+
+    // y[i] = cached(x[i]); same contract as evaluateMF
+    void evaluate(const T *x, T *y, size_t n) const
+    {
+        if (tabulated() && !batchExact)
+        {
+            const T *v = values.data(), *d = deltas.data();
+            if (fold ? interpolateInRegisters<true>(v, d, values.size(), lo, invStep, last, x, y, n)
+                     : interpolateInRegisters<false>(v, d, values.size(), lo, invStep, last, x, y, n))
+                return;
+            if (simdLevel() < SIMD_AVX2)
+            {
+                if (fold)
+                    interpolateTableLoop<true>(v, d, lo, invStep, last, x, y, n);
+                else
+                    interpolateTableLoop<false>(v, d, lo, invStep, last, x, y, n);
+                return;
+            }
+        }
+        evaluateMF(mf, x, y, n);
+    }
+
+    // False when the bound needed more than maxEntries samples and every
+    // call is exact
+    bool tabulated() const { return values.size() != 0; }
+    size_t entries() const { return values.size(); }
+    size_t memoryBytes() const { return (values.size() + deltas.size()) * sizeof(T); }
+    T rangeLo() const { return lo; }
+    T rangeHi() const { return hi; }
+    // Largest deviation from the exact MF measured while building (0 when
+    // not tabulated); never above maxError
+    T error() const { return measuredError; }
+
+private:
+    MF mf;
+    bool fold, batchExact;
+    AlignedBuffer<T> values, deltas;
+    T lo, hi, invStep, last, measuredError;
+
+    void build(T rangeLo, T rangeHi, T bound, size_t maxEntries)
+    {
+        lo = rangeLo;
+        hi = rangeHi > rangeLo ? rangeHi : rangeLo + T(1);
+        size_t n = CACHE_MIN_ENTRIES < maxEntries ? CACHE_MIN_ENTRIES : maxEntries;
+        n = n > 2 ? n : 2;
+        for (;;)
+        {
+            tabulate(n);
+            measuredError = measure();
+            if (measuredError <= bound)
+                return;
+            if (n >= maxEntries)
+                break;
+            n = 2 * n < maxEntries ? 2 * n : maxEntries;
+        }
+        values.resize(0);
+        deltas.resize(0);
+        measuredError = T(0);
+    }
+
+    void tabulate(size_t n)
+    {
+        values.resize(n);
+        deltas.resize(n);
+        const T step = (hi - lo) / T(n - 1);
+        for (size_t i = 0; i < n; i++)
+            values[i] = mf(lo + step * T(i));
+        for (size_t i = 0; i + 1 < n; i++)
+            deltas[i] = values[i + 1] - values[i];
+        deltas[n - 1] = T(0);
+        invStep = T(1) / step;
+        last = T(n - 1);
+    }
+
+    // Max |cached - mf| over CACHE_CHECK_POINTS points per interval
+    T measure() const
+    {
+        const size_t intervals = values.size() - 1;
+        const size_t points = intervals * CACHE_CHECK_POINTS + 1;
+        const T step = (hi - lo) / T(points - 1);
+        T worst = T(0);
+        for (size_t i = 0; i < points; i++)
+        {
+            T x = lo + step * T(i);
+            T err = std::fabs((*this)(x) - mf(x));
+            worst = err > worst ? err : worst;
+        }
+        return worst;
+    }
+};
+
+// Lets a cache stand in wherever an MF goes through evaluateMF
+template <typename MF, typename T>
+void evaluateMF(const CachedMF<MF> &mf, const T *x, T *y, size_t n)
+{
+    mf.evaluate(x, y, n);
+}
+
+// Deduces the MF type: auto g = cacheMF(GaussianMF<float>(6, 1.5), 1e-4f);
+template <typename MF>
+CachedMF<MF> cacheMF(const MF &mf, typename CachedMF<MF>::value_type maxError)
+{
+    return CachedMF<MF>(mf, maxError);
+}
+
+#endif // MEMBERSHIP_CACHE_H
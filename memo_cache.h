@@ -0,0 +1,323 @@
+#ifndef MEMO_CACHE_H
+#define MEMO_CACHE_H
+
+// Memo cache for fitness values, so a candidate that comes up again (ants
+// building the same tour on a small graph, wolves clamped onto the same
+// corner of the box) is not evaluated twice.
+//
+//   - keys are two independent 64-bit hashes of a canonical form of the
+//     candidate: tourKey() hashes a closed tour from its smallest city in
+//     the direction of its smaller neighbour, so every rotation and the
+//     reverse of a tour share a key; positionKey() hashes the coordinates
+//     rounded to a grid of `quantum` (0 = exact values). Nothing else is
+//     stored, so two candidates are only mixed up when both hashes collide,
+//     about once in 2^128;
+//   - the capacity is fixed and each shard evicts its least recently used
+//     entry, with the entries, the LRU list and the hash index sized up
+//     front;
+//   - keys are spread over independently locked shards, so the threads of
+//     evaluatePopulation() or of the ants rarely wait for each other. Two
+//     threads missing on the same key at once both compute it;
+//   - hits, misses and evictions are counted per shard; stats() adds them
+//     up.
+//
+// A cache only pays when an evaluation costs much more than hashing the
+// candidate: O(dims) for a position, O(n) for a tour.
+//
+//   MemoCache<> cache(1 << 16);
+//   MemoizedObjective<SphereFn> f(SphereFn(), cache, 1e-9);
+//   gwo.run(f, iterations);
+//   cache.stats().hitRate();
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "bit_cast.h"
+#include "rng.h"
+#include "thread_pool.h"
+
+// Shards per thread of the default pool, when the caller does not choose
+static const size_t MEMO_SHARDS_PER_THREAD = 4;
+
+struct MemoKey
+{
+    uint64_t hash, check;
+
+    MemoKey() : hash(0), check(0) {}
+    MemoKey(uint64_t hash, uint64_t check) : hash(hash), check(check) {}
+
+    bool operator==(const MemoKey &o) const { return hash == o.hash && check == o.check; }
+};
+
+// Feeds values one at a time to both hashes of a MemoKey
+class MemoHasher
+{
+public:
+    MemoHasher() : h1(0x243F6A8885A308D3ull), h2(0xCBF29CE484222325ull) {}
+
+    void add(uint64_t v)
+    {
+        h1 = (h1 + v) * 0x9E3779B97F4A7C15ull;
+        h2 = (h2 ^ v) * 0x100000001B3ull;
+    }
+
+    MemoKey key() const { return MemoKey(mix64(h1), mix64(h2 ^ 0x5851F42D4C957F2Dull)); }
+
+private:
+    uint64_t h1, h2;
+};
+
+// Key of the closed tour tour[0..n) that does not depend on where the tour
+// starts or which way round it goes
+inline MemoKey tourKey(const int *tour, size_t n)
+{
+    MemoHasher h;
+    if (n == 0)
+        return h.key();
+    const size_t start = std::min_element(tour, tour + n) - tour;
+    const size_t next = start + 1 < n ? start + 1 : 0, prev = start ? start - 1 : n - 1;
+    const size_t step = tour[next] <= tour[prev] ? 1 : n - 1; // +1 or -1 mod n
+    for (size_t i = 0, p = start; i < n; i++, p = p + step < n ? p + step : p + step - n)
+        h.add((uint32_t)tour[p]);
+    return h.key();
+}
+
+inline MemoKey tourKey(const std::vector<int> &tour) { return tourKey(tour.data(), tour.size()); }
+
+// Key of x[0..dims) rounded to multiples of `quantum`, or of the exact
+// values when quantum is 0 (-0 and +0 are the same point)
+inline MemoKey positionKey(const double *x, size_t dims, double quantum = 0.0)
+{
+    MemoHasher h;
+    for (size_t d = 0; d < dims; d++)
+    {
+        if (quantum > 0.0)
+            h.add((uint64_t)(int64_t)std::floor(x[d] / quantum + 0.5));
+        else
+            h.add(bitCast<uint64_t>(x[d] + 0.0));
+    }
+    return h.key();
+}
+
+struct MemoStats
+{
+    size_t hits, misses, evictions;
+
+    MemoStats() : hits(0), misses(0), evictions(0) {}
+
+    double hitRate() const { return hits + misses ? (double)hits / (hits + misses) : 0.0; }
+};
+
+template <typename Value = double>
+class MemoCache
+{
+public:
+    // At most `capacity` entries over `shards` shards (0 = a few per thread
+    // of the default pool); the shard count is rounded up to a power of two
+    explicit MemoCache(size_t capacity, size_t shards = 0)
+    {
+        if (shards == 0)
+            shards = MEMO_SHARDS_PER_THREAD * defaultThreadPool().concurrency();
+        shards = std::max<size_t>(1, std::min(shards, capacity));
+        size_t count = 1;
+        while (count < shards)
+            count *= 2;
+        perShard = std::max<size_t>(1, (capacity + count - 1) / count);
+        for (size_t s = 0; s < count; s++)
+            shardList.push_back(std::unique_ptr<Shard>(new Shard(perShard)));
+    }
+
+    MemoCache(const MemoCache &) = delete;
+    MemoCache &operator=(const MemoCache &) = delete;
+
+    size_t capacity() const { return perShard * shardList.size(); }
+    size_t shardCount() const { return shardList.size(); }
+
+    // Copies the value stored under key to `value` and marks it as recently
+    // used; false (a miss) if there is none
+    bool find(const MemoKey &key, Value &value)
+    {
+        Shard &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        typename std::unordered_map<uint64_t, uint32_t>::const_iterator it = s.index.find(key.hash);
+        if (it == s.index.end() || !(s.entries[it->second].key == key))
+        {
+            s.stats.misses++;
+            return false;
+        }
+        s.moveToFront(it->second);
+        value = s.entries[it->second].value;
+        s.stats.hits++;
+        return true;
+    }
+
+    // Stores value under key, evicting the shard's least recently used
+    // entry when it is full
+    void insert(const MemoKey &key, const Value &value)
+    {
+        Shard &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        typename std::unordered_map<uint64_t, uint32_t>::iterator it = s.index.find(key.hash);
+        uint32_t e;
+        if (it != s.index.end())
+        {
+            e = it->second; // same key, or a first-hash collision it replaces
+            s.moveToFront(e);
+        }
+        else
+        {
+            if (s.used < perShard)
+                e = (uint32_t)s.used++;
+            else
+            {
+                e = s.tail;
+                s.unlink(e);
+                s.index.erase(s.entries[e].key.hash);
+                s.stats.evictions++;
+            }
+            s.index[key.hash] = e;
+            s.pushFront(e);
+        }
+        s.entries[e].key = key;
+        s.entries[e].value = value;
+    }
+
+    // The cached value for key, or compute() stored and returned; compute
+    // runs without a lock held
+    template <typename Compute>
+    Value getOrCompute(const MemoKey &key, Compute compute)
+    {
+        Value value;
+        if (find(key, value))
+            return value;
+        value = compute();
+        insert(key, value);
+        return value;
+    }
+
+    // Entries in use
+    size_t size() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < shardList.size(); i++)
+        {
+            std::lock_guard<std::mutex> lock(shardList[i]->mutex);
+            total += shardList[i]->used;
+        }
+        return total;
+    }
+
+    MemoStats stats() const
+    {
+        MemoStats total;
+        for (size_t i = 0; i < shardList.size(); i++)
+        {
+            std::lock_guard<std::mutex> lock(shardList[i]->mutex);
+            total.hits += shardList[i]->stats.hits;
+            total.misses += shardList[i]->stats.misses;
+            total.evictions += shardList[i]->stats.evictions;
+        }
+        return total;
+    }
+
+    // Drops every entry and zeroes the counters
+    void clear()
+    {
+        for (size_t i = 0; i < shardList.size(); i++)
+        {
+            Shard &s = *shardList[i];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.index.clear();
+            s.used = 0;
+            s.head = s.tail = NONE;
+            s.stats = MemoStats();
+        }
+    }
+
+private:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Entry
+    {
+        MemoKey key;
+        Value value;
+        uint32_t prev, next; // LRU list, most recent first
+    };
+
+    // Entries are handed out in order until `used` reaches the capacity,
+    // then recycled from the tail of the list
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> index; // key.hash -> entry
+        std::vector<Entry> entries;
+        size_t used;
+        uint32_t head, tail;
+        MemoStats stats;
+
+        explicit Shard(size_t capacity) : entries(capacity), used(0), head(NONE), tail(NONE)
+        {
+            index.reserve(capacity);
+        }
+
+        void unlink(uint32_t e)
+        {
+            Entry &x = entries[e];
+            (x.prev != NONE ? entries[x.prev].next : head) = x.next;
+            (x.next != NONE ? entries[x.next].prev : tail) = x.prev;
+        }
+
+        void pushFront(uint32_t e)
+        {
+            entries[e].prev = NONE;
+            entries[e].next = head;
+            (head != NONE ? entries[head].prev : tail) = e;
+            head = e;
+        }
+
+        void moveToFront(uint32_t e)
+        {
+            if (e == head)
+                return;
+            unlink(e);
+            pushFront(e);
+        }
+    };
+
+    size_t perShard;
+    std::vector<std::unique_ptr<Shard> > shardList;
+
+    // The shard comes from the second hash, so it is independent of the
+    // index buckets within the shard
+    Shard &shard(const MemoKey &key) const { return *shardList[key.check & (shardList.size() - 1)]; }
+};
+
+// f with its values cached by position; with quantum > 0 every point of a
+// grid cell gets the value of the first one evaluated. Safe to call from
+// several threads if f is.
+template <typename Objective>
+class MemoizedObjective
+{
+public:
+    MemoizedObjective(const Objective &f, MemoCache<double> &cache, double quantum = 0.0)
+        : f(f), cache(&cache), quantum(quantum) {}
+
+    double operator()(const double *x, size_t dims) const
+    {
+        return cache->getOrCompute(positionKey(x, dims, quantum), [&]()
+                                   { return f(x, dims); });
+    }
+
+private:
+    Objective f;
+    MemoCache<double> *cache;
+    double quantum;
+};
+
+#endif // MEMO_CACHE_H
@@ -0,0 +1,205 @@
+#ifndef METAHEURISTIC_H
+#define METAHEURISTIC_H
+
+// Run loop shared by the optimizers: evaluation budget, iteration and time
+// limits, a fitness target and stagnation stopping, so GWO, PSO and ACO are
+// driven and measured the same way.
+//
+// The objective is a template parameter everywhere, as in gwo.h and pso.h:
+// any callable
+//
+//   double f(const double *x, size_t dims)
+//
+// that is safe to call from several threads at once. benchmark_functions.h
+// has the standard test functions in this form.
+//
+// runSearch() drives a search through three calls:
+//
+//   size_t start()                // (re)starts; returns evaluations spent
+//   size_t step(double progress)  // one iteration; returns evaluations spent
+//   double bestFitness() const    // best so far, lower is better
+//
+// `progress` is the fraction of the budget used before the step (the largest
+// of the evaluation, iteration and time fractions that are limited), for
+// schedules such as GWO's a = 2 -> 0. GwoSearch (gwo.h), PsoSearch (pso.h),
+// AcoTspSearch (aco_tsp.h) and AcoPathSearch (aco_graph.h) wrap the solvers
+// this way.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+#include "thread_pool.h"
+
+enum StopReason
+{
+    STOP_NONE,
+    STOP_TARGET,      // best fitness <= target
+    STOP_EVALUATIONS, // another step would exceed maxEvaluations
+    STOP_ITERATIONS,
+    STOP_TIME,
+    STOP_STAGNATION, // no improvement for stagnationSteps steps
+    STOP_CANCELLED   // *cancel was set
+};
+
+inline const char *stopReasonName(StopReason reason)
+{
+    switch (reason)
+    {
+    case STOP_TARGET:
+        return "target";
+    case STOP_EVALUATIONS:
+        return "evaluations";
+    case STOP_ITERATIONS:
+        return "iterations";
+    case STOP_TIME:
+        return "time";
+    case STOP_STAGNATION:
+        return "stagnation";
+    case STOP_CANCELLED:
+        return "cancelled";
+    default:
+        return "none";
+    }
+}
+
+// 0 turns a limit off; at least one of them should be on
+struct RunLimits
+{
+    size_t maxEvaluations;
+    size_t maxIterations;
+    double maxSeconds;
+    double target;          // -HUGE_VAL = none
+    bool stopAtTarget;      // else keep going and only record when it was hit
+    size_t stagnationSteps; // steps without an improvement larger than
+    double tolerance;       //   tolerance * max(1, |best|)
+
+    // Checked between steps; another thread sets it to stop the run
+    const std::atomic<bool> *cancel;
+
+    RunLimits()
+        : maxEvaluations(0), maxIterations(1000), maxSeconds(0.0), target(-HUGE_VAL), stopAtTarget(true),
+          stagnationSteps(0), tolerance(1e-12), cancel(0) {}
+};
+
+struct RunResult
+{
+    double bestFitness;
+    size_t evaluations, iterations;
+    double seconds;
+    StopReason reason;
+    bool reachedTarget;
+    double secondsToTarget; // first time best <= target
+    size_t evaluationsToTarget;
+
+    RunResult()
+        : bestFitness(HUGE_VAL), evaluations(0), iterations(0), seconds(0.0), reason(STOP_NONE),
+          reachedTarget(false), secondsToTarget(0.0), evaluationsToTarget(0) {}
+
+    double evaluationsPerSecond() const { return seconds > 0.0 ? evaluations / seconds : 0.0; }
+};
+
+// First time r.bestFitness is at or below the target
+inline void recordTarget(const RunLimits &limits, RunResult &r)
+{
+    if (!r.reachedTarget && r.bestFitness <= limits.target)
+    {
+        r.reachedTarget = true;
+        r.secondsToTarget = r.seconds;
+        r.evaluationsToTarget = r.evaluations;
+    }
+}
+
+// The limit that stops a run in state r, if any: `stale` steps have passed
+// without an improvement and the next step would cost `nextCost`
+// evaluations
+inline StopReason limitReached(const RunLimits &limits, const RunResult &r, size_t stale, size_t nextCost)
+{
+    if (r.reachedTarget && limits.stopAtTarget)
+        return STOP_TARGET;
+    if (limits.maxEvaluations && r.evaluations + nextCost > limits.maxEvaluations)
+        return STOP_EVALUATIONS;
+    if (limits.maxIterations && r.iterations >= limits.maxIterations)
+        return STOP_ITERATIONS;
+    if (limits.maxSeconds > 0.0 && r.seconds >= limits.maxSeconds)
+        return STOP_TIME;
+    if (limits.stagnationSteps && stale >= limits.stagnationSteps)
+        return STOP_STAGNATION;
+    if (limits.cancel && limits.cancel->load(std::memory_order_relaxed))
+        return STOP_CANCELLED;
+    return STOP_NONE;
+}
+
+// Used fraction of the budget: the largest of the limited ones, at most 1
+inline double budgetProgress(const RunLimits &limits, const RunResult &r)
+{
+    double progress = 0.0;
+    if (limits.maxEvaluations)
+        progress = std::max(progress, (double)r.evaluations / limits.maxEvaluations);
+    if (limits.maxIterations)
+        progress = std::max(progress, (double)r.iterations / limits.maxIterations);
+    if (limits.maxSeconds > 0.0)
+        progress = std::max(progress, r.seconds / limits.maxSeconds);
+    return std::min(progress, 1.0);
+}
+
+// Whether `best` improves on `reference` by more than the tolerance; if so
+// it becomes the new reference
+inline bool improved(const RunLimits &limits, double best, double &reference)
+{
+    if (best < reference && reference - best > limits.tolerance * std::max(1.0, std::fabs(best)))
+    {
+        reference = best;
+        return true;
+    }
+    return false;
+}
+
+// Starts `search` and steps it until a limit in `limits` stops it. The
+// evaluation budget is checked before each step against the cost of the
+// previous one, so a run does not overshoot it while steps cost the same.
+template <typename Search>
+RunResult runSearch(Search &search, const RunLimits &limits)
+{
+    typedef std::chrono::steady_clock Clock;
+    RunResult r;
+    const Clock::time_point begin = Clock::now();
+    size_t lastStep = r.evaluations = search.start();
+    double reference = search.bestFitness();
+    size_t stale = 0;
+
+    for (;;)
+    {
+        r.bestFitness = search.bestFitness();
+        r.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        recordTarget(limits, r);
+        r.reason = limitReached(limits, r, stale, lastStep);
+        if (r.reason != STOP_NONE)
+            return r;
+
+        lastStep = search.step(budgetProgress(limits, r));
+        r.evaluations += lastStep;
+        r.iterations++;
+        stale = improved(limits, search.bestFitness(), reference) ? 0 : stale + 1;
+    }
+}
+
+// Population elements per parallelFor chunk at most; smaller populations
+// are split evenly over the pool's threads
+static const size_t EVALUATE_GRAIN_ELEMENTS = 1 << 15;
+
+// out[r] = f(rows + r * stride, dims) for r < count, on the thread pool
+template <typename Objective>
+void evaluatePopulation(const Objective &f, const double *rows, size_t stride, size_t count, size_t dims,
+                        double *out, ThreadPool &pool = defaultThreadPool())
+{
+    const size_t grain = pool.spreadGrain(count, EVALUATE_GRAIN_ELEMENTS / (stride ? stride : 1));
+    pool.parallelFor(0, count, grain, [&](size_t lo, size_t hi)
+                     {
+        for (size_t r = lo; r < hi; r++)
+            out[r] = f(rows + r * stride, dims); });
+}
+
+#endif // METAHEURISTIC_H
@@ -0,0 +1,341 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "benchmark_functions.h"
+#include "metaheuristic.h"
+#include "gwo.h"
+#include "pso.h"
+#include "island_model.h"
+#include "async_evaluator.h"
+#include "aco_tsp.h"
+#include "aco_graph.h"
+#include "tsp_local_search.h"
+#include "rng.h"
+
+using namespace std;
+
+// Runs every optimizer on the same problems through runSearch() and reports
+// evaluations per second and the time each one takes to reach a target:
+//   - objective throughput of the benchmark functions over a population;
+//   - GWO and PSO on Sphere, Rastrigin, Rosenbrock, Ackley, Griewank and
+//     Schwefel with the same population and evaluation budget;
+//   - GWO as one pack against an island model with one pack per core, on the
+//     same total budget;
+//   - GWO on an expensive objective (Rastrigin plus a 1-10 ms delay) through
+//     step(), batched generations and steady state on async_evaluator.h;
+//   - ACO (with 2-opt / Or-opt) on a random uniform TSP instance, where an
+//     evaluation is one tour;
+//   - ACO corner-to-corner paths on a grid graph with random weights, where
+//     an evaluation is one ant's walk.
+//
+//   metaheuristic_bench [dims [population evaluations]]
+
+const size_t DIMS = 30;
+const size_t POPULATION = 50;
+const size_t EVALUATIONS = 200000;
+const size_t THROUGHPUT_ROWS = 10000;
+const int REPEATS = 10;
+const uint64_t SEED = 1;
+
+const size_t SLOW_EVALUATIONS = 400;
+const size_t SLOW_WORKERS = 8;
+const double SLOW_MIN_MS = 1.0, SLOW_MAX_MS = 10.0;
+
+const size_t TSP_CITIES = 1000;
+const size_t TSP_ANTS = 10;
+const size_t TSP_TOURS = 2000;
+const double TSP_TARGET = 0.85; // of the nearest-neighbour tour
+
+const size_t GRID_SIDE = 100;
+const size_t GRID_ANTS = 10;
+const size_t GRID_WALKS = 2000;
+
+void reportRun(const string &problem, const string &algorithm, const RunResult &r)
+{
+    cout << left << setw(12) << problem << setw(7) << algorithm
+         << right << setw(14) << scientific << setprecision(4) << r.bestFitness
+         << setw(10) << r.evaluations
+         << setw(12) << fixed << setprecision(0) << r.evaluationsPerSecond()
+         << setw(12) << setprecision(2);
+    if (r.reachedTarget)
+        cout << r.secondsToTarget * 1e3;
+    else
+        cout << "-";
+    cout << "  " << stopReasonName(r.reason) << endl;
+}
+
+// Evaluations per second of f over a population of random rows
+template <typename Objective>
+void throughput(const Objective &f, size_t dims)
+{
+    const size_t stride = paddedCount<double>(dims);
+    AlignedBuffer<double> rows(THROUGHPUT_ROWS * stride), out(THROUGHPUT_ROWS);
+    fillUniform(rows.data(), rows.size(), SEED, 0);
+    for (size_t i = 0; i < rows.size(); i++)
+        rows[i] = Objective::lower() + (Objective::upper() - Objective::lower()) * rows[i];
+
+    evaluatePopulation(f, rows.data(), stride, THROUGHPUT_ROWS, dims, out.data()); // warm up
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++)
+        evaluatePopulation(f, rows.data(), stride, THROUGHPUT_ROWS, dims, out.data());
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    const double seconds = elapsed.count() / REPEATS;
+    cout << left << setw(12) << Objective::name()
+         << right << setw(12) << fixed << setprecision(1) << THROUGHPUT_ROWS / seconds / 1e6 << " M evals/s"
+         << setw(10) << seconds / THROUGHPUT_ROWS * 1e9 << " ns/eval" << endl;
+}
+
+// GWO and PSO on f with the same budget and target
+template <typename Objective>
+void compare(const Objective &f, size_t dims, size_t population, double target, const RunLimits &base)
+{
+    RunLimits limits = base;
+    limits.target = target;
+
+    GreyWolfOptimizer gwo(population, dims, Objective::lower(), Objective::upper(), SEED);
+    GwoSearch<Objective> gwoSearch(gwo, f);
+    reportRun(Objective::name(), "GWO", runSearch(gwoSearch, limits));
+
+    PsoParams params;
+    params.seed = SEED;
+    ParticleSwarmOptimizer pso(population, dims, Objective::lower(), Objective::upper(), params);
+    PsoSearch<Objective> psoSearch(pso, f);
+    reportRun(Objective::name(), "PSO", runSearch(psoSearch, limits));
+}
+
+// One GWO pack against `islands` packs of the same size on their own
+// threads, sharing the budget
+template <typename Objective>
+void compareIslands(const Objective &f, size_t dims, size_t population, size_t islands, double target,
+                    const RunLimits &base)
+{
+    RunLimits limits = base;
+    limits.target = target;
+    limits.stopAtTarget = false;
+
+    GreyWolfOptimizer single(population, dims, Objective::lower(), Objective::upper(), SEED, serialThreadPool());
+    GwoSearch<Objective> singleSearch(single, f);
+    reportRun(Objective::name(), "GWO", runSearch(singleSearch, limits));
+
+    vector<unique_ptr<GreyWolfOptimizer> > packs;
+    vector<unique_ptr<GwoSearch<Objective> > > searches;
+    vector<GwoSearch<Objective> *> islandSearches;
+    for (size_t k = 0; k < islands; k++)
+    {
+        packs.push_back(unique_ptr<GreyWolfOptimizer>(new GreyWolfOptimizer(
+            population, dims, Objective::lower(), Objective::upper(), SEED + k, serialThreadPool())));
+        searches.push_back(unique_ptr<GwoSearch<Objective> >(new GwoSearch<Objective>(*packs[k], f)));
+        islandSearches.push_back(searches[k].get());
+    }
+    IslandModel<GwoSearch<Objective> > model(islandSearches);
+    reportRun(Objective::name(), "GWOx" + to_string(islands), model.run(limits));
+}
+
+// Stand-in for a simulation: f plus a delay between SLOW_MIN_MS and
+// SLOW_MAX_MS that depends on the point
+template <typename Objective>
+struct SlowObjective
+{
+    Objective f;
+
+    static const char *name() { return Objective::name(); }
+    static double lower() { return Objective::lower(); }
+    static double upper() { return Objective::upper(); }
+
+    double operator()(const double *x, size_t dims) const
+    {
+        const double u = (mix64(bitCast<uint64_t>(x[0])) >> 11) / 9007199254740992.0; // [0, 1)
+        this_thread::sleep_for(chrono::duration<double, milli>(SLOW_MIN_MS + (SLOW_MAX_MS - SLOW_MIN_MS) * u));
+        return f(x, dims);
+    }
+};
+
+// GWO on a slow objective with SLOW_WORKERS evaluations at a time: whole
+// steps, batches that accept results as they finish, and steady state.
+// step() spreads each population over the caller and SLOW_WORKERS - 1
+// workers, the async runs over SLOW_WORKERS workers while the caller
+// waits, so all three evaluate on the same number of threads and differ
+// only in how they wait for slow points.
+template <typename Objective>
+void compareAsync(const Objective &f, size_t dims, size_t population, const RunLimits &limits)
+{
+    ThreadPool stepPool(SLOW_WORKERS - 1);
+    GreyWolfOptimizer stepGwo(population, dims, Objective::lower(), Objective::upper(), SEED, stepPool);
+    GwoSearch<Objective> stepSearch(stepGwo, f);
+    reportRun(Objective::name(), "step", runSearch(stepSearch, limits));
+
+    ThreadPool pool(SLOW_WORKERS);
+    GreyWolfOptimizer gwo(population, dims, Objective::lower(), Objective::upper(), SEED, pool);
+    GwoSearch<Objective> search(gwo, f);
+    AsyncEvaluator<Objective> evaluator(f, dims, pool);
+    reportRun(Objective::name(), "batch", runAsync(search, evaluator, limits, ASYNC_GENERATIONAL));
+    reportRun(Objective::name(), "steady", runAsync(search, evaluator, limits, ASYNC_STEADY_STATE));
+}
+
+// Greedy nearest-neighbour tour length from city 0
+double nearestNeighbourLength(const TspInstance &tsp)
+{
+    vector<int> tour(1, 0);
+    vector<char> used(tsp.n, 0);
+    used[0] = 1;
+    for (size_t step = 1; step < tsp.n; step++)
+    {
+        const int from = tour.back();
+        int next = -1;
+        double bestDist = 0.0;
+        for (size_t c = 0; c < tsp.n; c++)
+        {
+            if (used[c])
+                continue;
+            const double d = tsp.distance(from, c);
+            if (next < 0 || d < bestDist)
+            {
+                next = (int)c;
+                bestDist = d;
+            }
+        }
+        used[next] = 1;
+        tour.push_back(next);
+    }
+    return tourLength(tsp, tour);
+}
+
+int main(int argc, char **argv)
+{
+    size_t dims = DIMS, population = POPULATION, evaluations = EVALUATIONS;
+    if (argc > 1)
+        dims = strtoul(argv[1], 0, 10);
+    if (argc > 3)
+    {
+        population = strtoul(argv[2], 0, 10);
+        evaluations = strtoul(argv[3], 0, 10);
+    }
+    if (dims < 1 || population < 4)
+    {
+        cout << "Invalid parameters." << endl;
+        return 1;
+    }
+
+    cout << "SIMD: " << simdLevelName(simdLevel()) << ", threads: " << defaultThreadPool().concurrency()
+         << ", dimensions: " << dims << endl;
+
+    cout << endl
+         << "Objective throughput, " << THROUGHPUT_ROWS << " points" << endl;
+    throughput(SphereFunction(), dims);
+    throughput(RastriginFunction(), dims);
+    throughput(RosenbrockFunction(), dims);
+    throughput(AckleyFunction(), dims);
+    throughput(GriewankFunction(), dims);
+    throughput(SchwefelFunction(), dims);
+
+    // Targets are "good" values for D = 30, scaled for the functions that
+    // grow with D
+    RunLimits limits;
+    limits.maxEvaluations = evaluations;
+    limits.maxIterations = 0;
+    const double scale = (double)dims / 30.0;
+
+    cout << endl
+         << "Population " << population << ", budget " << evaluations << " evaluations, seed " << SEED << endl;
+    cout << left << setw(12) << "function" << setw(7) << "alg"
+         << right << setw(14) << "best" << setw(10) << "evals" << setw(12) << "evals/s"
+         << setw(12) << "target ms" << "  stop" << endl;
+    compare(SphereFunction(), dims, population, 1e-8, limits);
+    compare(RastriginFunction(), dims, population, 50.0 * scale, limits);
+    compare(RosenbrockFunction(), dims, population, 100.0 * scale, limits);
+    compare(AckleyFunction(), dims, population, 1e-4, limits);
+    compare(GriewankFunction(), dims, population, 1e-2, limits);
+    compare(SchwefelFunction(), dims, population, 3000.0 * scale, limits);
+
+    // Islands run to the full budget so the times compare like for like
+    const size_t islands = max<size_t>(defaultThreadPool().concurrency(), 2);
+    cout << endl
+         << "Island model, " << islands << " islands of " << population << ", ring migration every "
+         << IslandParams().migrationInterval << " steps" << endl;
+    compareIslands(RastriginFunction(), dims, population, islands, 50.0 * scale, limits);
+    compareIslands(SchwefelFunction(), dims, population, islands, 3000.0 * scale, limits);
+
+    // The budget is small because every evaluation sleeps
+    RunLimits slowLimits = limits;
+    slowLimits.maxEvaluations = SLOW_EVALUATIONS;
+    cout << endl
+         << "Slow objective (" << SLOW_MIN_MS << "-" << SLOW_MAX_MS << " ms per evaluation), " << SLOW_WORKERS
+         << " workers, budget " << SLOW_EVALUATIONS << " evaluations" << endl;
+    compareAsync(SlowObjective<RastriginFunction>(), dims, population, slowLimits);
+
+    // ACO on a random instance; the target is a fixed fraction of the
+    // nearest-neighbour tour, about 5% above the optimum for uniform points
+    TspInstance tsp;
+    tsp.name = "random";
+    tsp.n = TSP_CITIES;
+    Xoshiro256 rng(SEED);
+    for (size_t i = 0; i < tsp.n; i++)
+    {
+        tsp.x.push_back(rng.uniform(0.0, 10000.0));
+        tsp.y.push_back(rng.uniform(0.0, 10000.0));
+    }
+    AcoParams params;
+    params.ants = TSP_ANTS;
+    params.seed = SEED;
+    AcoTspSolver solver(tsp, params);
+    TspLocalSearch localSearch(tsp);
+    attachLocalSearch(solver, localSearch);
+    AcoTspSearch acoSearch(solver);
+
+    RunLimits tspLimits;
+    tspLimits.maxEvaluations = TSP_TOURS;
+    tspLimits.maxIterations = 0;
+    tspLimits.target = TSP_TARGET * nearestNeighbourLength(tsp);
+    cout << endl
+         << "TSP, " << TSP_CITIES << " uniform cities, " << TSP_ANTS << " ants, budget " << TSP_TOURS
+         << " tours, target length " << fixed << setprecision(0) << tspLimits.target << endl;
+    reportRun("TSP", "ACO", runSearch(acoSearch, tspLimits));
+
+    // ACO paths across a grid with weights in [1, 2): no path is shorter
+    // than the 2 (side - 1) steps of a monotone one
+    vector<GraphArc> arcs;
+    for (size_t r = 0; r < GRID_SIDE; r++)
+        for (size_t c = 0; c < GRID_SIDE; c++)
+        {
+            const int u = (int)(r * GRID_SIDE + c);
+            if (c + 1 < GRID_SIDE)
+            {
+                GraphArc right = {u, u + 1, rng.uniform(1.0, 2.0)};
+                arcs.push_back(right);
+            }
+            if (r + 1 < GRID_SIDE)
+            {
+                GraphArc down = {u, u + (int)GRID_SIDE, rng.uniform(1.0, 2.0)};
+                arcs.push_back(down);
+            }
+        }
+    CsrGraph grid;
+    buildCsrGraph(GRID_SIDE * GRID_SIDE, arcs, false, grid);
+    AcoPathParams pathParams;
+    pathParams.ants = GRID_ANTS;
+    pathParams.seed = SEED;
+    AcoPathSolver pathSolver(grid, 0, (int)(GRID_SIDE * GRID_SIDE - 1), pathParams);
+    AcoPathSearch pathSearch(pathSolver);
+
+    RunLimits pathLimits;
+    pathLimits.maxEvaluations = GRID_WALKS;
+    pathLimits.maxIterations = 0;
+    cout << endl
+         << "Shortest path, " << GRID_SIDE << " x " << GRID_SIDE << " grid, " << GRID_ANTS << " ants, budget "
+         << GRID_WALKS << " walks, lower bound " << 2 * (GRID_SIDE - 1) << endl;
+    reportRun("grid path", "ACO", runSearch(pathSearch, pathLimits));
+
+    // alpha = 0: moves follow the distances alone, drawn from alias tables
+    pathParams.alpha = 0.0;
+    AcoPathSolver greedySolver(grid, 0, (int)(GRID_SIDE * GRID_SIDE - 1), pathParams);
+    AcoPathSearch greedySearch(greedySolver);
+    reportRun("grid path", "ACO a=0", runSearch(greedySearch, pathLimits));
+
+    return 0;
+}
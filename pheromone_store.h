@@ -0,0 +1,146 @@
+#ifndef PHEROMONE_STORE_H
+#define PHEROMONE_STORE_H
+
+// Pheromone trails over a fixed set of edge slots (candidate slots, CSR
+// edges or a flat N x N matrix), with lazy evaporation and concurrent
+// deposits.
+//
+// Each slot stores tau / scale. Evaporation only multiplies the shared
+// scale by (1 - rho), O(1) instead of a sweep over every edge; a deposit
+// adds amount / scale. When the scale gets small the stored values are
+// folded back in (one O(slots) pass every few hundred iterations) so they
+// cannot overflow. Within one row all slots share the scale, so a roulette
+// over a row can use the stored values directly.
+//
+// Ants deposit into their own DepositBuffer while they run in parallel.
+// A buffer sorts deposits by the block of slots they fall in, and merge()
+// gives each block to one worker, which applies every buffer's deposits for
+// that block in buffer order. No atomics or locks are needed, the update
+// costs O(edges touched), and the result is the same for any thread count.
+
+#include <cstddef>
+#include <vector>
+
+#include "thread_pool.h"
+
+// Fold the scale back into the stored values once it drops below this
+static const double PHEROMONE_RENORMALIZE = 1e-30;
+
+// Slot blocks merge() distributes over the workers
+static const size_t PHEROMONE_BLOCKS = 64;
+
+class PheromoneStore;
+
+class DepositBuffer
+{
+public:
+    struct Deposit
+    {
+        size_t slot;
+        double amount;
+    };
+
+    // Empties the buffer, keeping its memory
+    void clear()
+    {
+        for (size_t b = 0; b < blocks.size(); b++)
+            blocks[b].clear();
+    }
+
+    void add(size_t slot, double amount)
+    {
+        Deposit d = {slot, amount};
+        blocks[slot / blockSize].push_back(d);
+    }
+
+private:
+    friend class PheromoneStore;
+    size_t blockSize;
+    std::vector<std::vector<Deposit> > blocks;
+};
+
+class PheromoneStore
+{
+public:
+    PheromoneStore() : scale(1.0), blockSize(1) {}
+
+    // `slots` trails, all at tau0
+    void init(size_t slots, double tau0)
+    {
+        stored.assign(slots, tau0);
+        scale = 1.0;
+        blockSize = (slots + PHEROMONE_BLOCKS - 1) / PHEROMONE_BLOCKS;
+        blockSize = blockSize ? blockSize : 1;
+    }
+
+    size_t size() const { return stored.size(); }
+
+    // Pheromone on a slot
+    double value(size_t slot) const { return stored[slot] * scale; }
+
+    // Stored values (tau / scaleFactor()); proportional to tau, which is all
+    // a roulette needs
+    const double *storedValues() const { return stored.data(); }
+    double storedValue(size_t slot) const { return stored[slot]; }
+    double scaleFactor() const { return scale; }
+
+    // tau *= 1 - rho on every slot. Returns true when the stored values were
+    // rescaled, so anything cached from them has to be recomputed.
+    bool evaporate(double rho)
+    {
+        scale *= 1.0 - rho;
+        if (scale >= PHEROMONE_RENORMALIZE)
+            return false;
+        for (size_t s = 0; s < stored.size(); s++)
+            stored[s] *= scale;
+        scale = 1.0;
+        return true;
+    }
+
+    // tau += amount on one slot (single-threaded use)
+    void deposit(size_t slot, double amount)
+    {
+        stored[slot] += amount / scale;
+    }
+
+    // A buffer laid out for this store's blocks
+    void prepare(DepositBuffer &buffer) const
+    {
+        buffer.blockSize = blockSize;
+        buffer.blocks.resize((stored.size() + blockSize - 1) / blockSize);
+        buffer.clear();
+    }
+
+    // Applies every buffer's deposits, one slot block per task; touched(slot)
+    // runs after each deposit, from the worker that owns the slot
+    template <typename Touched>
+    void merge(const std::vector<DepositBuffer> &buffers, Touched touched, ThreadPool &pool = defaultThreadPool())
+    {
+        const size_t blockCount = (stored.size() + blockSize - 1) / blockSize;
+        const double inverse = 1.0 / scale;
+        pool.parallelFor(0, blockCount, 1, [&](size_t lo, size_t hi)
+                         {
+            for (size_t b = lo; b < hi; b++)
+                for (size_t a = 0; a < buffers.size(); a++)
+                {
+                    const std::vector<DepositBuffer::Deposit> &block = buffers[a].blocks[b];
+                    for (size_t i = 0; i < block.size(); i++)
+                    {
+                        stored[block[i].slot] += block[i].amount * inverse;
+                        touched(block[i].slot);
+                    }
+                } });
+    }
+
+    void merge(const std::vector<DepositBuffer> &buffers, ThreadPool &pool = defaultThreadPool())
+    {
+        merge(buffers, [](size_t) {}, pool);
+    }
+
+private:
+    std::vector<double> stored;
+    double scale;
+    size_t blockSize;
+};
+
+#endif // PHEROMONE_STORE_H
@@ -0,0 +1,472 @@
+#ifndef PSO_H
+#define PSO_H
+
+// Particle Swarm Optimization over D-dimensional real vectors, laid out like
+// gwo.h for swarms of 100k+ particles.
+//
+// Positions, velocities and personal bests are separate AlignedBuffers (a
+// structure of arrays), each a row per particle padded to whole cache
+// lines, so the update is a flat loop over three rows that vectorizes
+// across dimensions, with the multiply-adds fused on FMA targets. Padding
+// columns have bounds and velocity limit 0 and stay zero. Every step:
+//
+//   v = w v + c1 r1 (pbest - x) + c2 r2 (gbest - x), clamped to +-vmax
+//   x = x + v, kept inside the bounds (absorbing or reflecting walls)
+//
+// then the particle is re-evaluated and its personal best updated; particles
+// are split across the thread pool. The objective is called as
+//
+//   double f(const double *x, size_t dims)
+//
+// from several threads at once (it must not modify shared state).
+//
+// Best-update modes:
+//   - PSO_SYNCHRONOUS: every particle of a step follows the global best of
+//     the previous step (the classic formulation);
+//   - PSO_ASYNCHRONOUS: a particle follows improvements made earlier in the
+//     same step. Each chunk of particles keeps its own running best, merged
+//     into the global best at the end of the step, so threads share nothing
+//     while they run and the chunks (fixed by the swarm size, not the
+//     thread count) keep a run reproducible.
+// r1 and r2 come from the counter generator in rng.h, keyed by (seed,
+// iteration, particle), as in the GWO.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "rng.h"
+#include "simd_level.h"
+#include "thread_pool.h"
+
+static const size_t PSO_LANES = CACHE_LINE / sizeof(double);
+
+// Population elements per parallelFor chunk at most
+static const size_t PSO_GRAIN_ELEMENTS = 1 << 15;
+
+// Chunks a swarm is split into at least (when it has that many particles),
+// so that a small swarm with an expensive objective spreads over the
+// threads. Fixed rather than taken from the pool, because the asynchronous
+// mode's results depend on the chunks.
+static const size_t PSO_MIN_CHUNKS = 16;
+
+enum PsoBoundary
+{
+    PSO_ABSORB, // stop at the wall: x = bound, v = 0
+    PSO_REFLECT // bounce off the wall: mirror x, reverse v
+};
+
+enum PsoMode
+{
+    PSO_SYNCHRONOUS,
+    PSO_ASYNCHRONOUS
+};
+
+struct PsoParams
+{
+    double inertia;       // w
+    double cognitive;     // c1, pull towards the personal best
+    double social;        // c2, pull towards the global best
+    double velocityLimit; // vmax as a fraction of each dimension's range
+    PsoBoundary boundary;
+    PsoMode mode;
+    uint64_t seed;
+
+    // Constriction coefficients (Clerc and Kennedy)
+    PsoParams()
+        : inertia(0.7298), cognitive(1.49618), social(1.49618), velocityLimit(0.2), boundary(PSO_ABSORB),
+          mode(PSO_SYNCHRONOUS), seed(1) {}
+};
+
+// One particle's velocity and position update; `key` seeds its (r1, r2)
+// pairs. Compiled per ISA. A particle that leaves the bounds stops at the
+// wall with v = 0 (absorb) or is mirrored back into range with v = -v
+// (reflect); both are written branch-free so the loop vectorizes.
+#define PSO_DEFINE_UPDATE(NAME, ATTR)                                                                   \
+    ATTR inline void psoUpdate##NAME(double *__restrict x, double *__restrict v, const double *pbest,   \
+                                     const double *gbest, const double *lo, const double *hi,           \
+                                     const double *vmax, size_t padded, double w, double c1, double c2, \
+                                     uint64_t key, bool reflect)                                        \
+    {                                                                                                   \
+        const double bounce = reflect ? 1.0 : 0.0;                                                      \
+        for (size_t k = 0; k < padded; k += PSO_LANES)                                                  \
+            for (size_t j = 0; j < PSO_LANES; j++)                                                      \
+            {                                                                                           \
+                float r1, r2;                                                                           \
+                counterUnitPair(key, k + j, r1, r2);                                                    \
+                const double xi = x[k + j];                                                             \
+                double vi = w * v[k + j] + c1 * r1 * (pbest[k + j] - xi) + c2 * r2 * (gbest[k + j] - xi); \
+                const double vm = vmax[k + j], l = lo[k + j], h = hi[k + j];                            \
+                vi = vi < -vm ? -vm : vi;                                                               \
+                vi = vi > vm ? vm : vi;                                                                 \
+                double xn = xi + vi;                                                                    \
+                double xc = xn < l ? l : xn;                                                            \
+                xc = xc > h ? h : xc;                                                                   \
+                const double hit = xc != xn ? 1.0 : 0.0;                                                \
+                vi -= (1.0 + bounce) * hit * vi;                                                        \
+                xn = xc + bounce * (xc - xn);                                                           \
+                xn = xn < l ? l : xn;                                                                   \
+                xn = xn > h ? h : xn;                                                                   \
+                x[k + j] = xn;                                                                          \
+                v[k + j] = vi;                                                                          \
+            }                                                                                           \
+    }
+
+PSO_DEFINE_UPDATE(Default, )
+#ifdef FUZZY_X86
+PSO_DEFINE_UPDATE(Avx2, FUZZY_TARGET("avx2,fma"))
+PSO_DEFINE_UPDATE(Avx512, FUZZY_TARGET("avx512f,avx512dq"))
+#endif
+
+#undef PSO_DEFINE_UPDATE
+
+inline void psoUpdate(double *x, double *v, const double *pbest, const double *gbest, const double *lo,
+                      const double *hi, const double *vmax, size_t padded, double w, double c1, double c2,
+                      uint64_t key, bool reflect)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        psoUpdateAvx512(x, v, pbest, gbest, lo, hi, vmax, padded, w, c1, c2, key, reflect);
+        return;
+    case SIMD_AVX2:
+        psoUpdateAvx2(x, v, pbest, gbest, lo, hi, vmax, padded, w, c1, c2, key, reflect);
+        return;
+    default:
+        break;
+    }
+#endif
+    psoUpdateDefault(x, v, pbest, gbest, lo, hi, vmax, padded, w, c1, c2, key, reflect);
+}
+
+class ParticleSwarmOptimizer
+{
+public:
+    // Same bounds [lower, upper] in every dimension
+    ParticleSwarmOptimizer(size_t particles, size_t dims, double lower, double upper,
+                           const PsoParams &params = PsoParams(), ThreadPool &pool = defaultThreadPool())
+        : params(params), pool(pool)
+    {
+        std::vector<double> lo(dims, lower), hi(dims, upper);
+        setup(particles, dims, lo.data(), hi.data());
+    }
+
+    // Per-dimension bounds lower[d] <= x[d] <= upper[d]
+    ParticleSwarmOptimizer(size_t particles, size_t dims, const double *lower, const double *upper,
+                           const PsoParams &params = PsoParams(), ThreadPool &pool = defaultThreadPool())
+        : params(params), pool(pool)
+    {
+        setup(particles, dims, lower, upper);
+    }
+
+    // Scatters the particles uniformly over the bounds with velocities
+    // uniform in +-vmax, evaluates them and picks the global best; also
+    // restarts the iteration count
+    template <typename Objective>
+    void initialize(const Objective &f)
+    {
+        iter = 0;
+        forEachChunk([&](size_t p0, size_t p1, size_t)
+                     {
+            for (size_t p = p0; p < p1; p++)
+            {
+                scatter(p);
+                double *x = positions.data() + p * stride;
+                fit[p] = f(x, dims);
+                copyRow(personal.data() + p * stride, x);
+                personalFit[p] = fit[p];
+            } });
+        bestFit = HUGE_VAL;
+        mergeBest(personalFit.data(), personal.data(), particles);
+        started = true;
+    }
+
+    // One iteration: move every particle, re-evaluate it and update the
+    // personal and global bests
+    template <typename Objective>
+    void step(const Objective &f)
+    {
+        if (!started)
+            initialize(f);
+        iter++;
+        const bool async = params.mode == PSO_ASYNCHRONOUS;
+        forEachChunk([&](size_t p0, size_t p1, size_t chunk)
+                     {
+            double *guide = best.data();
+            double *guideFit = &bestFit;
+            if (async)
+            {
+                // This chunk's running best, starting from the global one
+                guide = chunkBest.data() + chunk * stride;
+                guideFit = &chunkFit[chunk];
+                copyRow(guide, best.data());
+                *guideFit = bestFit;
+            }
+            for (size_t p = p0; p < p1; p++)
+            {
+                double *x = positions.data() + p * stride, *pb = personal.data() + p * stride;
+                psoUpdate(x, velocities.data() + p * stride, pb, guide, lower.data(), upper.data(), vmax.data(),
+                          stride, params.inertia, params.cognitive, params.social, particleKey(p, iter),
+                          params.boundary == PSO_REFLECT);
+                const double fx = f(x, dims);
+                fit[p] = fx;
+                if (fx < personalFit[p])
+                {
+                    copyRow(pb, x);
+                    personalFit[p] = fx;
+                    if (async && fx < *guideFit)
+                    {
+                        copyRow(guide, x);
+                        *guideFit = fx;
+                    }
+                }
+            } });
+        if (async)
+            mergeBest(chunkFit.data(), chunkBest.data(), chunkFit.size());
+        else
+            mergeBest(personalFit.data(), personal.data(), particles);
+    }
+
+    // Initializes and runs `iterations` steps; returns the best fitness found
+    template <typename Objective>
+    double run(const Objective &f, size_t iterations)
+    {
+        initialize(f);
+        for (size_t t = 0; t < iterations; t++)
+            step(f);
+        return bestFit;
+    }
+
+    // Asynchronous use (async_evaluator.h): particles are placed, moved and
+    // given their fitness one at a time, in any order, instead of through
+    // initialize() and step()
+
+    // Forgets the personal and global bests and the iteration count
+    void restart()
+    {
+        iter = 0;
+        fit.fill(HUGE_VAL);
+        personalFit.fill(HUGE_VAL);
+        bestFit = HUGE_VAL;
+        started = false;
+    }
+
+    // Puts particle p at its initial random point and velocity
+    void scatter(size_t p)
+    {
+        double *x = positions.data() + p * stride, *v = velocities.data() + p * stride;
+        const uint64_t key = mix64(seed ^ mix64(p));
+        for (size_t d = 0; d < stride; d++)
+        {
+            float u1, u2;
+            counterUnitPair(key, d, u1, u2);
+            x[d] = lower[d] + (upper[d] - lower[d]) * u1;
+            v[d] = vmax[d] * (2.0 * u2 - 1.0);
+        }
+    }
+
+    // Moves particle p toward its personal best and the current global
+    // best. `tick` keys the random numbers (step() uses the iteration) and
+    // must change between moves of one particle; p needs a fitness first.
+    void move(size_t p, uint64_t tick)
+    {
+        const double *guide = bestFit < HUGE_VAL ? best.data() : personal.data() + p * stride;
+        psoUpdate(positions.data() + p * stride, velocities.data() + p * stride, personal.data() + p * stride,
+                  guide, lower.data(), upper.data(), vmax.data(), stride, params.inertia, params.cognitive,
+                  params.social, particleKey(p, tick), params.boundary == PSO_REFLECT);
+    }
+
+    // Records the fitness of particle p at its current position and updates
+    // its personal best and the global best
+    void setFitness(size_t p, double fx)
+    {
+        const double *x = positions.data() + p * stride;
+        fit[p] = fx;
+        if (fx < personalFit[p])
+        {
+            copyRow(personal.data() + p * stride, x);
+            personalFit[p] = fx;
+        }
+        if (fx < bestFit)
+        {
+            copyRow(best.data(), x);
+            bestFit = fx;
+        }
+    }
+
+    // Moves particle p to x (dims values) with known fitness fx, e.g. a
+    // migrant from another swarm; x also becomes its personal best, and the
+    // global best if it beats it. The velocity is kept.
+    void replace(size_t p, const double *x, double fx)
+    {
+        double *row = positions.data() + p * stride;
+        for (size_t d = 0; d < stride; d++)
+            row[d] = d < dims ? x[d] : 0.0;
+        copyRow(personal.data() + p * stride, row);
+        fit[p] = fx;
+        personalFit[p] = fx;
+        if (fx < bestFit)
+        {
+            copyRow(best.data(), row);
+            bestFit = fx;
+        }
+    }
+
+    size_t particleCount() const { return particles; }
+    size_t dimensions() const { return dims; }
+    size_t iteration() const { return iter; }
+    const PsoParams &parameters() const { return params; }
+
+    const double *position(size_t p) const { return positions.data() + p * stride; }
+    const double *velocity(size_t p) const { return velocities.data() + p * stride; }
+    double fitness(size_t p) const { return fit[p]; }
+    const double *personalBest(size_t p) const { return personal.data() + p * stride; }
+    double personalBestFitness(size_t p) const { return personalFit[p]; }
+    const double *bestPosition() const { return best.data(); }
+    double bestFitness() const { return bestFit; }
+
+private:
+    PsoParams params;
+    ThreadPool &pool;
+    size_t particles, dims, stride, grain, iter;
+    uint64_t seed;
+    bool started;
+    AlignedBuffer<double> positions, velocities, personal; // [particle][stride]
+    AlignedBuffer<double> fit, personalFit;
+    AlignedBuffer<double> lower, upper, vmax; // [stride], zero in the padding
+    AlignedBuffer<double> best;               // [stride]
+    double bestFit;
+    AlignedBuffer<double> chunkBest, chunkFit; // asynchronous mode, [chunk][stride]
+
+    void setup(size_t particleCount, size_t dimCount, const double *lo, const double *hi)
+    {
+        particles = particleCount;
+        dims = dimCount;
+        stride = paddedCount<double>(dims);
+        grain = std::min(PSO_GRAIN_ELEMENTS / stride, (particles + PSO_MIN_CHUNKS - 1) / PSO_MIN_CHUNKS);
+        grain = grain ? grain : 1;
+        iter = 0;
+        seed = mix64(params.seed);
+        started = false;
+        positions.resize(particles * stride);
+        velocities.resize(particles * stride);
+        personal.resize(particles * stride);
+        fit.resize(particles);
+        personalFit.resize(particles);
+        lower.resize(stride);
+        upper.resize(stride);
+        vmax.resize(stride);
+        best.resize(stride);
+        bestFit = HUGE_VAL;
+        const size_t chunks = (particles + grain - 1) / grain;
+        chunkBest.resize(chunks * stride);
+        chunkFit.resize(chunks);
+        for (size_t d = 0; d < dims; d++)
+        {
+            lower[d] = lo[d];
+            upper[d] = hi[d];
+            vmax[d] = params.velocityLimit * (hi[d] - lo[d]);
+        }
+    }
+
+    // fn(first, last, chunk) over fixed chunks of particles
+    template <typename F>
+    void forEachChunk(F fn)
+    {
+        const size_t g = grain;
+        pool.parallelFor(0, particles, g, [&](size_t lo, size_t hi)
+                         { fn(lo, hi, lo / g); });
+    }
+
+    // 64-bit stream key for particle p at iteration `tick`
+    uint64_t particleKey(size_t p, uint64_t tick) const
+    {
+        return mix64(seed ^ mix64((tick << 32) ^ p));
+    }
+
+    // Global best = the best of itself and rows[0 .. count)
+    void mergeBest(const double *rowFit, const double *rows, size_t count)
+    {
+        size_t bestRow = count;
+        double f = bestFit;
+        for (size_t r = 0; r < count; r++)
+        {
+            if (rowFit[r] < f)
+            {
+                f = rowFit[r];
+                bestRow = r;
+            }
+        }
+        if (bestRow < count)
+        {
+            copyRow(best.data(), rows + bestRow * stride);
+            bestFit = f;
+        }
+    }
+
+    void copyRow(double *dst, const double *src) const
+    {
+        for (size_t d = 0; d < stride; d++)
+            dst[d] = src[d];
+    }
+};
+
+// runSearch() adapter (metaheuristic.h)
+template <typename Objective>
+class PsoSearch
+{
+public:
+    PsoSearch(ParticleSwarmOptimizer &pso, const Objective &f) : pso(pso), f(f) {}
+
+    size_t start()
+    {
+        pso.initialize(f);
+        return pso.particleCount();
+    }
+
+    size_t step(double)
+    {
+        pso.step(f);
+        return pso.particleCount();
+    }
+
+    double bestFitness() const { return pso.bestFitness(); }
+
+    // Asynchronous hooks (async_evaluator.h): the first proposal for a
+    // member is its initial point, later ones move it
+    void restart()
+    {
+        pso.restart();
+        ticks.assign(populationSize(), 0);
+    }
+
+    const double *propose(size_t i, double)
+    {
+        if (ticks[i]++ == 0)
+            pso.scatter(i);
+        else
+            pso.move(i, ticks[i] - 1);
+        return pso.position(i);
+    }
+
+    void accept(size_t i, double fx) { pso.setFitness(i, fx); }
+
+    // Migration hooks (island_model.h); members are the personal bests
+    size_t dimensions() const { return pso.dimensions(); }
+    size_t populationSize() const { return pso.particleCount(); }
+    const double *member(size_t i) const { return pso.personalBest(i); }
+    double memberFitness(size_t i) const { return pso.personalBestFitness(i); }
+    void replaceMember(size_t i, const double *x, double fx) { pso.replace(i, x, fx); }
+    const double *bestPosition() const { return pso.bestPosition(); }
+
+private:
+    ParticleSwarmOptimizer &pso;
+    Objective f;
+    std::vector<uint64_t> ticks; // proposals per member
+};
+
+#endif // PSO_H
@@ -1,26 +1,24 @@
 #include <iostream>
 #include <vector>
 #include <algorithm> // for max and min
+#include <chrono>
+
+#include "composition_stream.h"
+#include "fuzzy_closure.h"
+#include "fuzzy_composition.h"
+#include "fuzzy_relation.h"
+
 using namespace std;
 
 typedef vector<float> FuzzySet;
-typedef vector<vector<float>> FuzzyRelation;
 
 FuzzySet maxMinComposition(const FuzzySet &A, const FuzzyRelation &R)
 {
-    int m = A.size();         // Size of set A
-    int n = R[0].size();      // Number of columns in relation R
+    int n = R.cols();         // Number of columns in relation R
     FuzzySet result(n, 0.0f); // Resulting fuzzy set
 
-    for (int j = 0; j < n; ++j)
-    {
-        float maxVal = 0.0f;
-        for (int i = 0; i < m; ++i)
-        {
-            maxVal = max(maxVal, min(A[i], R[i][j]));
-        }
-        result[j] = maxVal;
-    }
+    // result[j] = max_i min(A[i], R[i][j]), accumulated one row of R at a time
+    composeSet<IntersectionOp>(A.data(), R.view(), result.data());
     return result;
 }
 
@@ -32,6 +30,16 @@ void printSet(const FuzzySet &set, const string &label)
     cout << endl;
 }
 
+void printRelation(const FuzzyRelation &R)
+{
+    for (size_t i = 0; i < R.rows(); i++)
+    {
+        for (size_t j = 0; j < R.cols(); j++)
+            cout << R(i, j) << " ";
+        cout << endl;
+    }
+}
+
 int main()
 {
     // Fuzzy set A with 3 elements
@@ -49,14 +57,59 @@ int main()
     // Display results
     printSet(A, "Fuzzy Set A");
     cout << "Fuzzy Relation R:" << endl;
-    for (const auto &row : R)
+    printRelation(R);
+
+    printSet(result, "Result of A o R (Max-Min)");
+
+    // Several query sets composed with R in one batched pass (one row per query)
+    FuzzyRelation queries = {
+        {0.7, 0.4, 1.0},
+        {0.2, 0.9, 0.5},
+        {1.0, 0.0, 0.3}};
+    FuzzyRelation batchResult;
+    maxMinCompositionBatch(queries, R, batchResult);
+    cout << "\nBatched A o R for " << queries.rows() << " queries:" << endl;
+    printRelation(batchResult);
+
+    // Streaming: queries arrive one by one and are grouped into batches of
+    // at most 2, or whatever has arrived within 1 ms
+    cout << "\nStreamed queries:" << endl;
+    CompositionStream<float> stream(R, 2, chrono::milliseconds(1));
+    for (size_t q = 0; q < queries.rows(); q++)
     {
-        for (float val : row)
-            cout << val << " ";
-        cout << endl;
+        stream.submit(queries.row(q), [q](const float *res, size_t n)
+                      { cout << "query " << q << ": ";
+                        for (size_t j = 0; j < n; j++)
+                            cout << res[j] << " ";
+                        cout << endl; });
     }
+    stream.flush();
+    cout << "Batches: " << stream.batches() << ", average size " << stream.averageBatchSize() << endl;
 
-    printSet(result, "Result of A o R (Max-Min)");
+    // Similarity relation (reflexive, symmetric) over 5 items
+    FuzzyRelation similarity = {
+        {1.0, 0.8, 0.0, 0.1, 0.2},
+        {0.8, 1.0, 0.4, 0.0, 0.9},
+        {0.0, 0.4, 1.0, 0.0, 0.0},
+        {0.1, 0.0, 0.0, 1.0, 0.5},
+        {0.2, 0.9, 0.0, 0.5, 1.0}};
+
+    FuzzyRelation closure, scratch;
+    size_t squarings = transitiveClosureInto(similarity, closure, scratch);
+    cout << "\nTransitive closure (" << squarings << " squarings):" << endl;
+    printRelation(closure);
+
+    // Clusters at each alpha-cut of the closure
+    float alphas[] = {0.4f, 0.5f, 0.8f, 0.9f};
+    for (float alpha : alphas)
+    {
+        vector<int> labels;
+        size_t classes = equivalenceClasses(closure, alpha, labels);
+        cout << "alpha = " << alpha << ": " << classes << " classes { ";
+        for (int label : labels)
+            cout << label << " ";
+        cout << "}" << endl;
+    }
 
     return 0;
 }
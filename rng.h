@@ -0,0 +1,222 @@
+#ifndef RNG_H
+#define RNG_H
+
+// Seedable random number generation for the optimizers, replacing the
+// global rand() stream.
+//
+// Xoshiro256 is xoshiro256** (Blackman and Vigna): 256 bits of state,
+// period 2^256 - 1, seeded through splitmix64. jump() advances it by 2^128
+// draws, so Xoshiro256(seed, k) gives stream k of a seed: non-overlapping
+// sequences that threads can own without sharing any state. It meets the
+// UniformRandomBitGenerator requirements, so it also works with std::shuffle
+// and the <random> distributions.
+//
+// The counter functions are the stateless alternative used inside SIMD
+// loops: value i of stream `key` is mix64(key + i * RNG_COUNTER_STEP), that
+// is splitmix64 started at `key`, with a 64-bit key and counter. Streams are
+// windows of one 2^64-long sequence, so two streams of m values with random
+// keys overlap with probability about 2m / 2^64; keys should be hashes
+// (mix64) rather than small integers. Each value gives a 24-bit float pair
+// or a 53-bit double, and vectorizes on AVX2 and AVX-512. fillUniform
+// produces a whole buffer of doubles that way, stamped per ISA like the
+// other kernels. Either way a run is reproducible from its seed whatever the
+// thread count.
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "simd_level.h"
+
+// splitmix64 finalizer: a well-mixed 64-bit hash
+inline uint64_t mix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Spacing between consecutive counter values of one stream (the splitmix64
+// increment, odd, so a stream only repeats after 2^64 values)
+static const uint64_t RNG_COUNTER_STEP = 0x9E3779B97F4A7C15ull;
+
+// 64 random bits: value i of stream key
+inline uint64_t counterBits(uint64_t key, uint64_t i)
+{
+    return mix64(key + i * RNG_COUNTER_STEP);
+}
+
+// Uniform [0, 1) with 24 bits: value i of stream key
+inline float counterUnit(uint64_t key, uint64_t i)
+{
+    return (float)(int)(counterBits(key, i) >> 40) * (1.0f / 16777216.0f);
+}
+
+// Two uniforms [0, 1) with 24 bits each, from disjoint bits of one value, at
+// half the cost of two counterUnit calls
+inline void counterUnitPair(uint64_t key, uint64_t i, float &u, float &v)
+{
+    const uint64_t h = counterBits(key, i);
+    u = (float)(int)(h >> 40) * (1.0f / 16777216.0f);
+    v = (float)(int)(h & 0xFFFFFFu) * (1.0f / 16777216.0f);
+}
+
+// Uniform [0, 1) with 53 bits: value i of stream key. The bits go through
+// two int conversions, which AVX2 has, instead of an int64 one, which it
+// does not.
+inline double counterDouble(uint64_t key, uint64_t i)
+{
+    const uint64_t h = counterBits(key, i);
+    const double hi = (double)(int)(h >> 38);
+    const double lo = (double)(int)((h >> 11) & 0x7FFFFFFu);
+    return (hi * 134217728.0 + lo) * (1.0 / 9007199254740992.0);
+}
+
+// out[i] = counterDouble(key, first + i)
+static const size_t RNG_STRIP = 64;
+
+#define RNG_DEFINE_FILL(NAME, ATTR)                                                                    \
+    ATTR inline void fillUniform##NAME(double *__restrict out, size_t n, uint64_t key, uint64_t first) \
+    {                                                                                                  \
+        const size_t blocked = n - n % RNG_STRIP;                                                      \
+        size_t i = 0;                                                                                  \
+        for (; i < blocked; i += RNG_STRIP)                                                            \
+        {                                                                                              \
+            const uint64_t base = first + i;                                                           \
+            for (uint64_t j = 0; j < RNG_STRIP; j++)                                                   \
+                out[i + j] = counterDouble(key, base + j);                                             \
+        }                                                                                              \
+        for (; i < n; i++)                                                                             \
+            out[i] = counterDouble(key, first + i);                                                    \
+    }
+
+RNG_DEFINE_FILL(Default, )
+#ifdef FUZZY_X86
+RNG_DEFINE_FILL(Avx2, FUZZY_TARGET("avx2,fma"))
+RNG_DEFINE_FILL(Avx512, FUZZY_TARGET("avx512f,avx512dq"))
+#endif
+
+#undef RNG_DEFINE_FILL
+
+inline void fillUniform(double *out, size_t n, uint64_t key, uint64_t first = 0)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        fillUniformAvx512(out, n, key, first);
+        return;
+    case SIMD_AVX2:
+        fillUniformAvx2(out, n, key, first);
+        return;
+    default:
+        break;
+    }
+#endif
+    fillUniformDefault(out, n, key, first);
+}
+
+class Xoshiro256
+{
+public:
+    typedef uint64_t result_type;
+
+    // Stream `stream` of `seed`: the splitmix64-seeded state advanced by
+    // `stream` jumps of 2^128
+    explicit Xoshiro256(uint64_t seed = 1, uint64_t stream = 0)
+    {
+        reseed(seed, stream);
+    }
+
+    void reseed(uint64_t seed, uint64_t stream = 0)
+    {
+        uint64_t x = seed;
+        for (int i = 0; i < 4; i++)
+        {
+            s[i] = mix64(x);
+            x += 0x9E3779B97F4A7C15ull;
+        }
+        for (uint64_t k = 0; k < stream; k++)
+            jump();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~(result_type)0; }
+
+    result_type operator()()
+    {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform [0, 1) with 53 bits
+    double nextDouble()
+    {
+        return (double)((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Uniform [lo, hi)
+    double uniform(double lo, double hi)
+    {
+        return lo + (hi - lo) * nextDouble();
+    }
+
+    // Uniform integer in [0, n), unbiased (Lemire's multiply-and-reject)
+    uint32_t below(uint32_t n)
+    {
+        uint64_t m = (uint64_t)(uint32_t)((*this)() >> 32) * n;
+        uint32_t low = (uint32_t)m;
+        if (low < n)
+        {
+            const uint32_t threshold = (uint32_t)(-n) % n;
+            while (low < threshold)
+            {
+                m = (uint64_t)(uint32_t)((*this)() >> 32) * n;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // out[0 .. n) = uniform [0, 1): one draw picks a counter stream, which
+    // fillUniform expands with the SIMD hash
+    void fill(double *out, size_t n)
+    {
+        fillUniform(out, n, (*this)(), 0);
+    }
+
+    // Advances the state by 2^128 draws
+    void jump()
+    {
+        static const uint64_t JUMP[4] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull,
+                                         0x39ABDC4529B1661Cull};
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 4; i++)
+            for (int b = 0; b < 64; b++)
+            {
+                if (JUMP[i] & ((uint64_t)1 << b))
+                    for (int w = 0; w < 4; w++)
+                        t[w] ^= s[w];
+                (*this)();
+            }
+        for (int w = 0; w < 4; w++)
+            s[w] = t[w];
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+#endif // RNG_H
@@ -0,0 +1,342 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+// Weighted random selection for the metaheuristics' next-move and parent
+// choices (ACO next hop, roulette-wheel selection).
+//
+// WeightedSampler is per-thread scratch. The caller writes non-negative
+// weights into weights(n) and draws an index with one of:
+//   - roulette():   exact, probability w[i] / sum. The prefix sums are taken
+//                   column-wise: lane j accumulates w[j], w[j + L], ... so the
+//                   scan is one SIMD add per row with no cross-lane shuffles.
+//                   A draw picks a lane from the L lane totals, then binary
+//                   searches that column, O(n / L + log n). Any fixed order
+//                   of the items gives the same distribution;
+//   - iRoulette():  the independent roulette, argmax of w[i] * u[i] with u[i]
+//                   uniform. It has no prefix dependency, so it is a single
+//                   SIMD pass (the u[i] are counter hashes computed in the
+//                   loop), but it only approximates w[i] / sum: it favours
+//                   heavy items. Meant for very large candidate sets;
+//   - tournament(): the heaviest of `size` uniformly drawn items,
+//                   O(size) whatever n is. Approximate as well.
+// Each returns -1 when every weight is zero (or falls back to roulette()
+// when a tournament only drew zero weights). Once reserved, nothing
+// allocates.
+//
+// AliasTable is Walker's alias method (Vose's construction): O(n) to build,
+// O(1) per draw. It pays off when one distribution is sampled many times,
+// e.g. a node's move weights shared by every ant. buildAlias() and
+// aliasDraw() do the same on caller-owned arrays, for many small tables
+// laid out back to back.
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "rng.h"
+#include "simd_level.h"
+
+// Doubles per cache line: the row width of the column-wise prefix sums
+static const size_t SAMPLER_LANES = CACHE_LINE / sizeof(double);
+
+enum SelectionMethod
+{
+    SELECT_ROULETTE,   // exact
+    SELECT_I_ROULETTE, // independent roulette
+    SELECT_TOURNAMENT
+};
+
+// columnPrefix: prefix[r L + j] = w[j] + w[L + j] + ... + w[r L + j], for
+// `padded` (a multiple of L) weights.
+// independentKeys: key[i] = w[i] * u[i] with u[i] = counterUnit(seed, i) +
+// 2^-25, never zero; returns the largest key.
+#define SAMPLER_DEFINE_KERNELS(NAME, ATTR)                                                              \
+    ATTR inline void columnPrefix##NAME(const double *__restrict w, double *__restrict prefix,          \
+                                        size_t padded)                                                  \
+    {                                                                                                   \
+        double acc[SAMPLER_LANES];                                                                      \
+        for (size_t j = 0; j < SAMPLER_LANES; j++)                                                      \
+            acc[j] = 0.0;                                                                               \
+        for (size_t r = 0; r < padded; r += SAMPLER_LANES)                                              \
+            for (size_t j = 0; j < SAMPLER_LANES; j++)                                                  \
+            {                                                                                           \
+                acc[j] += w[r + j];                                                                     \
+                prefix[r + j] = acc[j];                                                                 \
+            }                                                                                           \
+    }                                                                                                   \
+                                                                                                        \
+    ATTR inline double independentKeys##NAME(const double *__restrict w, double *__restrict key,        \
+                                             size_t padded, uint64_t seed)                              \
+    {                                                                                                   \
+        double top[SAMPLER_LANES];                                                                      \
+        for (size_t j = 0; j < SAMPLER_LANES; j++)                                                      \
+            top[j] = 0.0;                                                                               \
+        for (size_t r = 0; r < padded; r += SAMPLER_LANES)                                              \
+            for (size_t j = 0; j < SAMPLER_LANES; j++)                                                  \
+            {                                                                                           \
+                const float u = counterUnit(seed, r + j) + (1.0f / 33554432.0f);                        \
+                const double k = w[r + j] * (double)u;                                                  \
+                key[r + j] = k;                                                                         \
+                top[j] = k > top[j] ? k : top[j];                                                       \
+            }                                                                                           \
+        double best = 0.0;                                                                              \
+        for (size_t j = 0; j < SAMPLER_LANES; j++)                                                      \
+            best = top[j] > best ? top[j] : best;                                                       \
+        return best;                                                                                    \
+    }
+
+SAMPLER_DEFINE_KERNELS(Default, )
+#ifdef FUZZY_X86
+SAMPLER_DEFINE_KERNELS(Avx2, FUZZY_TARGET("avx2,fma"))
+SAMPLER_DEFINE_KERNELS(Avx512, FUZZY_TARGET("avx512f,avx512dq"))
+#endif
+
+#undef SAMPLER_DEFINE_KERNELS
+
+inline void columnPrefix(const double *w, double *prefix, size_t padded)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        columnPrefixAvx512(w, prefix, padded);
+        return;
+    case SIMD_AVX2:
+        columnPrefixAvx2(w, prefix, padded);
+        return;
+    default:
+        break;
+    }
+#endif
+    columnPrefixDefault(w, prefix, padded);
+}
+
+inline double independentKeys(const double *w, double *key, size_t padded, uint64_t seed)
+{
+#ifdef FUZZY_X86
+    switch (simdLevel())
+    {
+    case SIMD_AVX512:
+        return independentKeysAvx512(w, key, padded, seed);
+    case SIMD_AVX2:
+        return independentKeysAvx2(w, key, padded, seed);
+    default:
+        break;
+    }
+#endif
+    return independentKeysDefault(w, key, padded, seed);
+}
+
+class WeightedSampler
+{
+public:
+    WeightedSampler() : count(0), padded(0) {}
+
+    // Room for up to n weights
+    void reserve(size_t n)
+    {
+        const size_t need = (n + SAMPLER_LANES - 1) / SAMPLER_LANES * SAMPLER_LANES;
+        if (need > w.size())
+        {
+            w.resize(need);
+            scratch.resize(need);
+        }
+    }
+
+    // The buffer for the next draw's n weights; the padding after them is
+    // zeroed here
+    double *weights(size_t n)
+    {
+        reserve(n);
+        count = n;
+        padded = (n + SAMPLER_LANES - 1) / SAMPLER_LANES * SAMPLER_LANES;
+        for (size_t i = n; i < padded; i++)
+            w[i] = 0.0;
+        return w.data();
+    }
+
+    size_t size() const { return count; }
+
+    int roulette(Xoshiro256 &rng)
+    {
+        const size_t L = SAMPLER_LANES;
+        if (padded == 0)
+            return -1;
+        double *prefix = scratch.data();
+        columnPrefix(w.data(), prefix, padded);
+        const double *lane = prefix + padded - L; // column totals
+        double total = 0.0;
+        for (size_t j = 0; j < L; j++)
+            total += lane[j];
+        if (total <= 0.0)
+            return -1;
+
+        // Lane, then the offset into its column; rounding can run off the
+        // end, which the clamp below handles
+        double r = rng.nextDouble() * total;
+        size_t j = 0, last = 0;
+        for (; j < L; j++)
+        {
+            if (lane[j] > 0.0)
+            {
+                last = j;
+                if (r < lane[j])
+                    break;
+            }
+            r -= lane[j];
+        }
+        if (j == L)
+        {
+            j = last;
+            r = lane[j];
+        }
+
+        // First row whose prefix exceeds r
+        size_t lo = 0, hi = padded / L - 1;
+        while (lo < hi)
+        {
+            const size_t mid = (lo + hi) / 2;
+            if (prefix[mid * L + j] > r)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        while (w[lo * L + j] == 0.0)
+            lo--;
+        return (int)(lo * L + j);
+    }
+
+    int iRoulette(Xoshiro256 &rng)
+    {
+        if (padded == 0)
+            return -1;
+        double *key = scratch.data();
+        const double best = independentKeys(w.data(), key, padded, rng());
+        if (best <= 0.0)
+            return -1;
+        size_t i = 0;
+        while (key[i] != best)
+            i++;
+        return (int)i;
+    }
+
+    int tournament(Xoshiro256 &rng, size_t size)
+    {
+        if (count == 0)
+            return -1;
+        int best = -1;
+        double bestWeight = 0.0;
+        for (size_t t = 0; t < size; t++)
+        {
+            const uint32_t i = rng.below((uint32_t)count);
+            if (w[i] > bestWeight)
+            {
+                bestWeight = w[i];
+                best = (int)i;
+            }
+        }
+        return best >= 0 ? best : roulette(rng);
+    }
+
+    int select(SelectionMethod method, Xoshiro256 &rng, size_t tournamentSize = 4)
+    {
+        switch (method)
+        {
+        case SELECT_I_ROULETTE:
+            return iRoulette(rng);
+        case SELECT_TOURNAMENT:
+            return tournament(rng, tournamentSize);
+        default:
+            return roulette(rng);
+        }
+    }
+
+private:
+    AlignedBuffer<double> w, scratch; // scratch: prefix sums or keys
+    size_t count, padded;
+};
+
+// Alias table of the n weights w in prob[0 .. n) and alias[0 .. n) (indices
+// within the table); small and large are work lists kept by the caller.
+// Returns the weight sum; a table whose sum is 0 must not be drawn from.
+inline double buildAlias(const double *w, size_t n, double *prob, int *alias, std::vector<int> &small,
+                         std::vector<int> &large)
+{
+    small.clear();
+    large.clear();
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++)
+        total += w[i];
+    if (total <= 0.0)
+        return 0.0;
+
+    // Scaled so the mean is 1; each column is topped up from one large item
+    const double scale = (double)n / total;
+    for (size_t i = 0; i < n; i++)
+    {
+        prob[i] = w[i] * scale;
+        alias[i] = (int)i;
+        (prob[i] < 1.0 ? small : large).push_back((int)i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        const int s = small.back(), l = large.back();
+        small.pop_back();
+        alias[s] = l;
+        prob[l] -= 1.0 - prob[s];
+        if (prob[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Leftovers are 1 up to rounding
+    for (size_t i = 0; i < large.size(); i++)
+        prob[large[i]] = 1.0;
+    for (size_t i = 0; i < small.size(); i++)
+        prob[small[i]] = 1.0;
+    return total;
+}
+
+// Index drawn from an alias table of n > 0 entries, with u uniform in [0, 1)
+inline int aliasDraw(const double *prob, const int *alias, size_t n, double u)
+{
+    u *= (double)n;
+    size_t i = (size_t)u;
+    i = i < n ? i : n - 1;
+    return u - (double)i < prob[i] ? (int)i : alias[i];
+}
+
+class AliasTable
+{
+public:
+    AliasTable() : total(0.0) {}
+
+    // Tables for the n weights w; the work lists are kept for the next build
+    void build(const double *w, size_t n)
+    {
+        prob.resize(n);
+        alias.resize(n);
+        total = buildAlias(w, n, prob.data(), alias.data(), small, large);
+    }
+
+    size_t size() const { return prob.size(); }
+    double weightSum() const { return total; }
+
+    // One draw, or -1 when every weight was zero
+    int sample(Xoshiro256 &rng) const
+    {
+        if (total <= 0.0)
+            return -1;
+        return aliasDraw(prob.data(), alias.data(), prob.size(), rng.nextDouble());
+    }
+
+private:
+    std::vector<double> prob;
+    std::vector<int> alias;
+    std::vector<int> small, large;
+    double total;
+};
+
+#endif // SAMPLER_H
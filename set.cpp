@@ -1,6 +1,10 @@
 #include <iostream>
 #include <vector>
 #include <algorithm> // for std::max and std::min
+
+#include "fuzzy_expr.h"
+#include "fuzzy_tnorm.h"
+
 using namespace std;
 
 int main() {
@@ -10,16 +14,17 @@ int main() {
     vector<float> A = {0.2, 0.4, 0.7, 1.0, 0.5};
     vector<float> B = {0.3, 0.6, 0.5, 0.8, 0.4};
     
-    vector<float> union_set(SIZE);
-    vector<float> intersection_set(SIZE);
     vector<float> complement_A(SIZE);
 
-    // Compute union, intersection, and complement
-    for (int i = 0; i < SIZE; ++i) {
-        union_set[i] = max(A[i], B[i]);
-        intersection_set[i] = min(A[i], B[i]);
-        complement_A[i] = 1.0f - A[i];
-    }
+    // Compute union, intersection (Zadeh max/min), and complement
+    vector<float> union_set = tnormUnion<ZadehTNorm>(A, B);
+    vector<float> intersection_set = tnormIntersection<ZadehTNorm>(A, B);
+    fuzzyComplement(A.data(), complement_A.data(), SIZE);
+
+    // Same operations under other t-norms
+    vector<float> product_union = tnormUnion<ProductTNorm>(A, B);
+    vector<float> product_intersection = tnormIntersection<ProductTNorm>(A, B);
+    vector<float> luk_intersection = tnormIntersection<LukasiewiczTNorm>(A, B);
 
     // Display results
     cout << "Fuzzy Set A: ";
@@ -37,6 +42,15 @@ int main() {
     cout << "\nComplement (¬A): ";
     for (float val : complement_A) cout << val << " ";
 
+    cout << "\n\nProbabilistic sum (A + B - AB): ";
+    for (float val : product_union) cout << val << " ";
+
+    cout << "\nAlgebraic product (AB): ";
+    for (float val : product_intersection) cout << val << " ";
+
+    cout << "\nLukasiewicz (max(0, A + B - 1)): ";
+    for (float val : luk_intersection) cout << val << " ";
+
     cout << endl;
     return 0;
 }
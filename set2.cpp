@@ -1,101 +1,129 @@
 #include <iostream>
 #include <vector>
-#include <algorithm>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <functional>
+#include <fstream>
+#include "control_surface.h"
+#include "controller_batch.h"
+#include "fuzzy_inference.h"
 using namespace std;
 
-
-int getTempCategory(float temp)
-{
-    // 0 = cold 1 = warm 2 = hot
-    if (temp <= 15.0f)
-        return 0; 
-    else if (temp > 15.0f && temp < 30.0f)
-        return 1; 
-    else
-        return 2;
-}
-
-
-int getHumidityCategory(float hum)
+// Fan controller: Mamdani inference from temperature and humidity. The
+// cold/warm/hot and low/medium/high terms cross 0.5 at the old crisp
+// thresholds (15/30 degrees, 40/70 %), and the rules are the old switch table.
+// Pass a rule base file as the first argument to use a different one.
+//
+//   set2 [rules.txt] [--csv | --bin] [--header fan_surface.h]
+//
+// With --csv / --bin the program reads a temperature,humidity feed from
+// stdin (CSV lines or pairs of raw floats) and writes one fan speed per line.
+// --header writes the compiled control surface as a standalone header.
+const char *FAN_RULES =
+    "method mamdani\n"
+    "and min\n"
+    "implication min\n"
+    "defuzzify centroid\n"
+    "resolution 101\n"
+    "\n"
+    "input temperature 0 45\n"
+    "term cold trapezoidal 0 0 10 20\n"
+    "term warm trapezoidal 10 20 25 35\n"
+    "term hot trapezoidal 25 35 45 45\n"
+    "\n"
+    "input humidity 0 100\n"
+    "term low trapezoidal 0 0 30 50\n"
+    "term medium trapezoidal 30 50 60 80\n"
+    "term high trapezoidal 60 80 100 100\n"
+    "\n"
+    "output fan 0 100\n"
+    "term low triangular 0 0 50\n"
+    "term medium triangular 20 50 80\n"
+    "term high triangular 50 100 100\n"
+    "\n"
+    "rule if temperature is cold and humidity is low then fan is low\n"
+    "rule if temperature is cold and humidity is medium then fan is medium\n"
+    "rule if temperature is cold and humidity is high then fan is medium\n"
+    "rule if temperature is warm and humidity is low then fan is medium\n"
+    "rule if temperature is warm and humidity is medium then fan is medium\n"
+    "rule if temperature is warm and humidity is high then fan is high\n"
+    "rule if temperature is hot and humidity is low then fan is medium\n"
+    "rule if temperature is hot and humidity is medium then fan is high\n"
+    "rule if temperature is hot and humidity is high then fan is high\n";
+
+// Output term the crisp speed belongs to most
+string speedLabel(const FuzzyVariable &fan, float speed)
 {
-    if (hum <= 40.0f)
-        return 0; // Low
-    else if (hum > 40.0f && hum < 70.0f)
-        return 1; // Medium
-    else
-        return 2; // High
+    size_t best = 0;
+    for (size_t t = 1; t < fan.terms.size(); t++)
+        if (fan.terms[t].mf(speed) > fan.terms[best].mf(speed))
+            best = t;
+    return fan.terms[best].name;
 }
 
-string getFanSpeed(int temp_cat, int hum_cat)
+// Writes each chunk's output column as text, one value per line
+struct SpeedWriter
 {
-    int speed = 0; 
+    string buffer;
 
-    switch (temp_cat)
+    void operator()(const float *const *, const float *const *out, size_t rows)
     {
-    case 0: // Cold
-        switch (hum_cat)
-        {
-        case 0:
-            speed = 0;
-            break; 
-        case 1:
-            speed = 1;
-            break; 
-        case 2:
-            speed = 1;
-            break; 
-        }
-        break;
-
-    case 1: // Warm
-        switch (hum_cat)
+        buffer.clear();
+        char number[32];
+        for (size_t k = 0; k < rows; k++)
         {
-        case 0:
-            speed = 1;
-            break; 
-        case 1:
-            speed = 1;
-            break; 
-        case 2:
-            speed = 2;
-            break; 
+            int len = snprintf(number, sizeof(number), "%.3f\n", out[0][k]);
+            buffer.append(number, len);
         }
-        break;
+        cout.write(buffer.data(), buffer.size());
+    }
+};
 
-    case 2: 
-        switch (hum_cat)
-        {
-        case 0:
-            speed = 1;
-            break; // Low -> Medium
-        case 1:
-            speed = 2;
-            break; // Medium -> High
-        case 2:
-            speed = 2;
-            break; // High -> High
-        }
-        break;
+int main(int argc, char **argv)
+{
+    const char *rulesFile = 0, *headerFile = 0;
+    int streamFormat = -1;
+    for (int a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--csv") == 0)
+            streamFormat = SENSOR_CSV;
+        else if (strcmp(argv[a], "--bin") == 0)
+            streamFormat = SENSOR_BINARY;
+        else if (strcmp(argv[a], "--header") == 0 && a + 1 < argc)
+            headerFile = argv[++a];
+        else
+            rulesFile = argv[a];
+    }
 
-    default:
-        return "Unknown";
+    FuzzyController controller;
+    string error;
+    bool loaded = rulesFile ? controller.loadFile(rulesFile, error) : controller.loadString(FAN_RULES, error);
+    if (!loaded)
+    {
+        cout << "Rule base error: " << error << endl;
+        return 1;
+    }
+    if (controller.inputCount() != 2 || controller.outputCount() != 1)
+    {
+        cout << "Rule base must have 2 inputs (temperature, humidity) and 1 output." << endl;
+        return 1;
     }
 
-    switch (speed)
+    if (streamFormat >= 0)
     {
-    case 0:
-        return "Low";
-    case 1:
-        return "Medium";
-    case 2:
-        return "High";
-    default:
-        return "Unknown";
+        ios::sync_with_stdio(false);
+        ControllerStream stream(controller);
+        SpeedWriter writer;
+        size_t rows;
+        if (!stream.process(cin, (SensorFormat)streamFormat, ref(writer), rows, error))
+        {
+            cerr << "Feed error after " << rows << " rows: " << error << endl;
+            return 1;
+        }
+        return 0;
     }
-}
 
-int main()
-{
     vector<float> temperatures = {12.5, 20.0, 31.0, 16.5};
     vector<float> humidities = {35.0, 50.0, 75.0, 65.0};
 
@@ -105,17 +133,35 @@ int main()
         return 1;
     }
 
-    cout << "Temp\tHum\tFan Speed" << endl;
-    cout << "-----------------------------" << endl; 
+    // Precomputed surface for O(1) lookups
+    const size_t surfacePoints = 129;
+    ControlSurface surface;
+    surface.compile(controller, surfacePoints);
+    if (headerFile)
+    {
+        ofstream header(headerFile);
+        surface.writeHeader(header, "fan");
+    }
+
+    cout << "Temp\tHum\tFan Speed\t\tSurface" << endl;
+    cout << "---------------------------------------------" << endl;
+
+    // The two vectors are already input columns, so evaluate them in one batch
+    vector<float> speeds(temperatures.size());
+    const float *columns[2] = {temperatures.data(), humidities.data()};
+    float *speedColumn = speeds.data();
+    evaluateBatchParallel(controller, columns, &speedColumn, speeds.size());
 
     for (size_t i = 0; i < temperatures.size(); ++i)
     {
-        int temp_cat = getTempCategory(temperatures[i]);
-        int hum_cat = getHumidityCategory(humidities[i]);
-        string fan_speed = getFanSpeed(temp_cat, hum_cat);
-
-        cout << temperatures[i] << "\t" << humidities[i] << "\t" << fan_speed << endl;
+        float in[2] = {temperatures[i], humidities[i]};
+        cout << temperatures[i] << "\t" << humidities[i] << "\t" << speeds[i] << " (" << speedLabel(controller.output(0), speeds[i]) << ")"
+             << "\t" << surface(in) << endl;
     }
 
+    cout << endl
+         << "Control surface " << surfacePoints << "x" << surfacePoints << ", " << surface.memoryBytes() / 1024
+         << " KB, max deviation " << surface.maxDeviation() << endl;
+
     return 0;
 }
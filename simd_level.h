@@ -0,0 +1,80 @@
+#ifndef SIMD_LEVEL_H
+#define SIMD_LEVEL_H
+
+// Runtime ISA dispatch shared by every per-ISA kernel: the widest SIMD level
+// the CPU supports (AVX-512, AVX2 or SSE2), detected once, and the target
+// attribute the kernels are stamped with. Other targets run the scalar loop.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// The AVX-512 intrinsics pass _mm512_undefined_ps() as the unused merge
+// source, which GCC 12 reports as maybe-uninitialized once they are inlined
+// (the warnings point into these headers, so this covers only them)
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+#define FUZZY_X86 1
+#define FUZZY_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+enum SimdLevel
+{
+    SIMD_SCALAR = 0,
+    SIMD_SSE2 = 1,
+    SIMD_AVX2 = 2,
+    SIMD_AVX512 = 3
+};
+
+inline SimdLevel detectSimdLevel()
+{
+#ifdef FUZZY_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+inline SimdLevel &activeSimdLevel()
+{
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+inline SimdLevel simdLevel()
+{
+    return activeSimdLevel();
+}
+
+// Force a narrower path (benchmarks, comparing against the scalar loop).
+// Requests above what the CPU supports are clamped.
+inline void setSimdLevel(SimdLevel level)
+{
+    SimdLevel best = detectSimdLevel();
+    activeSimdLevel() = level > best ? best : level;
+}
+
+inline const char *simdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SIMD_AVX512:
+        return "AVX-512";
+    case SIMD_AVX2:
+        return "AVX2";
+    case SIMD_SSE2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+#endif // SIMD_LEVEL_H
@@ -1,42 +1,94 @@
 #include <iostream>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <chrono>
+#include "pso.h"
 using namespace std;
 
-int main()
+// Objective function: Sphere function f(x) = sum of x_d^2
+struct SphereFn
 {
-    srand(time(0)); // Seed random number generator
+    double operator()(const double *x, size_t dims) const
+    {
+        double sum = 0.0;
+        for (size_t d = 0; d < dims; d++)
+            sum += x[d] * x[d];
+        return sum;
+    }
+};
 
+//   swanalgo [seed [particles iterations dimensions]] [--async] [--reflect]
+//
+// Without arguments it runs the original small swarm: 5 particles in 3
+// dimensions.
+int main(int argc, char **argv)
+{
+    // Seed random number generator; pass a seed as the first argument to repeat a run
+    uint64_t seed = time(0);
     int swarmSize = 5;     // Number of particles
+    int iterations = 100;  // Number of velocity/position updates
     int dimensions = 3;    // Dimensions of the problem
     double minPos = -10.0; // Minimum position
     double maxPos = 10.0;  // Maximum position
 
-    vector<vector<double>> position(swarmSize, vector<double>(dimensions));
-    vector<vector<double>> velocity(swarmSize, vector<double>(dimensions));
-
-    // Initialize positions and velocities
-    for (int i = 0; i < swarmSize; i++)
+    PsoParams params;
+    vector<const char *> numbers;
+    for (int a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--async") == 0)
+            params.mode = PSO_ASYNCHRONOUS;
+        else if (strcmp(argv[a], "--reflect") == 0)
+            params.boundary = PSO_REFLECT;
+        else
+            numbers.push_back(argv[a]);
+    }
+    if (numbers.size() >= 1)
+        seed = strtoull(numbers[0], 0, 10);
+    if (numbers.size() >= 4)
     {
-        for (int d = 0; d < dimensions; d++)
-        {
-            position[i][d] = minPos + (maxPos - minPos) * ((double)rand() / RAND_MAX);
-            velocity[i][d] = ((double)rand() / RAND_MAX) * (maxPos - minPos) / 2.0;
-        }
+        swarmSize = atoi(numbers[1]);
+        iterations = atoi(numbers[2]);
+        dimensions = atoi(numbers[3]);
     }
+    if (swarmSize < 1 || iterations < 0 || dimensions < 1)
+    {
+        cout << "Invalid parameters." << endl;
+        return 1;
+    }
+    params.seed = seed;
+
+    ParticleSwarmOptimizer pso(swarmSize, dimensions, minPos, maxPos, params);
 
-    // Print initialized values
-    for (int i = 0; i < swarmSize; i++)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    double best = pso.run(SphereFn(), iterations);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    // Final particles, for small swarms
+    for (int i = 0; i < swarmSize && i < 5; i++)
     {
         cout << "Particle " << i + 1 << " Position: ";
-        for (double p : position[i])
-            cout << p << " ";
+        for (int d = 0; d < dimensions && d < 5; d++)
+            cout << pso.position(i)[d] << " ";
         cout << " | Velocity: ";
-        for (double v : velocity[i])
-            cout << v << " ";
+        for (int d = 0; d < dimensions && d < 5; d++)
+            cout << pso.velocity(i)[d] << " ";
         cout << endl;
     }
 
+    // Best solution, first few coordinates for large dimensions
+    const double *x = pso.bestPosition();
+    cout << "Best solution found: x = (";
+    for (int d = 0; d < dimensions && d < 5; d++)
+        cout << (d ? ", " : "") << x[d];
+    if (dimensions > 5)
+        cout << ", ...";
+    cout << "), f(x) = " << best << endl;
+    cout << "Seed: " << seed << " (" << (params.mode == PSO_ASYNCHRONOUS ? "asynchronous" : "synchronous")
+         << " best updates)" << endl;
+    cout << swarmSize << " particles x " << dimensions << " dimensions x " << iterations << " iterations in "
+         << elapsed.count() << " s" << endl;
+
     return 0;
 }
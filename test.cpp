@@ -2,40 +2,10 @@
 #include <vector>
 #include <algorithm> // for max and min
 
-using namespace std;
-
-// union
-vector<double> fuzzyUnion(const vector<double> &A, const vector<double> &B)
-{
-    vector<double> result(A.size());
-    for (size_t i = 0; i < A.size(); i++)
-    {
-        result[i] = max(A[i], B[i]);
-    }
-    return result;
-}
-
-//  intersection
-vector<double> fuzzyIntersection(const vector<double> &A, const vector<double> &B)
-{
-    vector<double> result(A.size());
-    for (size_t i = 0; i < A.size(); i++)
-    {
-        result[i] = min(A[i], B[i]);
-    }
-    return result;
-}
+#include "fuzzy_expr.h"
+#include "fuzzy_tnorm.h"
 
-// complement
-vector<double> fuzzyComplement(const vector<double> &A)
-{
-    vector<double> result(A.size());
-    for (size_t i = 0; i < A.size(); i++)
-    {
-        result[i] = 1.0 - A[i];
-    }
-    return result;
-}
+using namespace std;
 
 // Helper to print a fuzzy set
 void printSet(const vector<double> &S)
@@ -58,9 +28,10 @@ int main()
     cout << "Set B: ";
     printSet(B);
 
-    vector<double> uni = fuzzyUnion(A, B);
-    vector<double> inter = fuzzyIntersection(A, B);
-    vector<double> compA = fuzzyComplement(A);
+    vector<double> uni = tnormUnion<ZadehTNorm>(A, B);
+    vector<double> inter = tnormIntersection<ZadehTNorm>(A, B);
+    vector<double> compA;
+    fuzzyComplementInto(A, compA);
 
     cout << "A union B: ";
     printSet(uni);
@@ -0,0 +1,198 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// Small persistent thread pool. submit() queues a fire-and-forget task;
+// parallelFor() splits an index range into chunks that the workers and the
+// calling thread pull from a shared counter, and returns once every chunk
+// has run. parallelFor may be called from inside a pool task: the caller
+// keeps working through chunks itself, so it never waits on a queued helper.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum ThreadPoolKind
+{
+    THREAD_POOL_SERIAL // no workers, see serialThreadPool()
+};
+
+class ThreadPool
+{
+public:
+    // threads = number of worker threads; 0 means one per hardware thread
+    // beyond the caller (at least one, so submitted tasks always run)
+    explicit ThreadPool(size_t threads = 0) : stopping(false)
+    {
+        if (threads == 0)
+        {
+            size_t hw = std::thread::hardware_concurrency();
+            threads = hw > 1 ? hw - 1 : 1;
+        }
+        for (size_t i = 0; i < threads; i++)
+            workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+
+    // No workers: parallelFor runs every chunk on the caller and submit()
+    // runs the task at once
+    explicit ThreadPool(ThreadPoolKind) : stopping(false) {}
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t workerCount() const { return workers.size(); }
+
+    // Threads that take part in a parallelFor (workers plus the caller)
+    size_t concurrency() const { return workers.size() + 1; }
+
+    // Grain for a parallelFor over `count` items: at most maxGrain, and
+    // small enough that every thread taking part gets a chunk, so a small
+    // population of expensive items is still spread out
+    size_t spreadGrain(size_t count, size_t maxGrain) const
+    {
+        const size_t grain = std::min(maxGrain, (count + concurrency() - 1) / concurrency());
+        return grain ? grain : 1;
+    }
+
+    void submit(std::function<void()> task)
+    {
+        if (workers.empty())
+        {
+            task();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    // Calls fn(lo, hi) for consecutive chunks of at most `grain` indices
+    // covering [begin, end). Chunks may run concurrently and in any order.
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F fn)
+    {
+        if (end <= begin)
+            return;
+        if (grain == 0)
+            grain = 1;
+        size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1 || workers.empty())
+        {
+            for (size_t lo = begin; lo < end; lo += grain)
+                fn(lo, std::min(end, lo + grain));
+            return;
+        }
+
+        // Shared with the helper tasks, which may start after we return
+        std::shared_ptr<ForLoop> loop(new ForLoop());
+        loop->begin = begin;
+        loop->end = end;
+        loop->grain = grain;
+        loop->chunks = chunks;
+        loop->next = 0;
+        loop->done = 0;
+        loop->body = [&fn](size_t lo, size_t hi)
+        { fn(lo, hi); };
+
+        size_t helpers = std::min(workers.size(), chunks - 1);
+        for (size_t h = 0; h < helpers; h++)
+            submit([loop]()
+                   { loop->run(); });
+
+        loop->run();
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->finished.wait(lock, [&loop]()
+                            { return loop->done.load() == loop->chunks; });
+    }
+
+private:
+    struct ForLoop
+    {
+        size_t begin, end, grain, chunks;
+        std::atomic<size_t> next;
+        std::atomic<size_t> done;
+        std::function<void(size_t, size_t)> body;
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        void run()
+        {
+            size_t completed = 0;
+            for (;;)
+            {
+                size_t c = next.fetch_add(1);
+                if (c >= chunks)
+                    break;
+                size_t lo = begin + c * grain;
+                body(lo, std::min(end, lo + grain));
+                completed++;
+            }
+            if (completed && done.fetch_add(completed) + completed == chunks)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]()
+                          { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+// Process-wide pool shared by the parallel kernels
+inline ThreadPool &defaultThreadPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+// Pool that runs everything on the calling thread, for code that already
+// has a thread of its own per task (e.g. the islands of island_model.h);
+// it has no state, so any number of threads can share it
+inline ThreadPool &serialThreadPool()
+{
+    static ThreadPool pool(THREAD_POOL_SERIAL);
+    return pool;
+}
+
+#endif // THREAD_POOL_H
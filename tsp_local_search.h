@@ -0,0 +1,327 @@
+#ifndef TSP_LOCAL_SEARCH_H
+#define TSP_LOCAL_SEARCH_H
+
+// Local search for TSP tours: 2-opt and Or-opt (moving a segment of 1 to 3
+// cities, either way round), applied until no improving move is left.
+//
+// The standard speed-ups make a pass cost roughly O(n k) rather than
+// O(n^2):
+//   - moves are only tried towards a city's k nearest neighbours, and only
+//     while the new edge is shorter than the one it replaces;
+//   - don't-look bits: cities wait in a queue, and a city whose
+//     neighbourhood gave no improvement leaves it until a move touches one
+//     of its edges;
+//   - the tour is an array plus each city's position, so succ/pred are
+//     O(1). A 2-opt move reverses the shorter side of the tour (at most
+//     n / 2 swaps), and an Or-opt move is done as two or three such
+//     exchanges.
+//
+// Calls for different `worker` indices may run concurrently, each with its
+// own scratch (reserve() sets how many). attachLocalSearch() plugs the
+// search into AcoTspSolver as the stage between construction and the
+// pheromone update, with one worker per ant; given a memo cache it reuses
+// the improved tour of a constructed tour seen before.
+
+#include <cstddef>
+#include <vector>
+
+#include "aco_tsp.h"
+#include "memo_cache.h"
+#include "thread_pool.h"
+
+// Moves must gain more than this; TSPLIB lengths are integers, so this only
+// guards against rounding
+static const double LOCAL_SEARCH_EPSILON = 1e-7;
+
+// Longest segment Or-opt moves
+static const int OR_OPT_SEGMENT = 3;
+
+class TspLocalSearch
+{
+public:
+    // Neighbour lists of `neighbours` cities each, shared by all workers
+    TspLocalSearch(const TspInstance &tsp, size_t neighbours = 10, size_t workers = 1,
+                   ThreadPool &pool = defaultThreadPool())
+        : useTwoOpt(true), useOrOpt(true), tsp(tsp), n(tsp.n)
+    {
+        k = neighbours < n - 1 ? neighbours : n - 1;
+        k = k ? k : 1;
+        buildCandidateLists(tsp, k, neighbour, pool);
+        reserve(workers);
+    }
+
+    bool useTwoOpt, useOrOpt;
+
+    size_t neighbourCount() const { return k; }
+
+    // Scratch for `workers` concurrent improve() calls
+    void reserve(size_t workers)
+    {
+        if (scratch.size() < workers)
+            scratch.resize(workers);
+    }
+
+    // Improves `tour` (length `length`) in place and returns its new length
+    double improve(std::vector<int> &tour, double length, size_t worker = 0)
+    {
+        if (n < 5 || tour.size() != n)
+            return length;
+        Scratch &s = scratch[worker];
+        s.tour = &tour;
+        s.pos.resize(n);
+        s.queued.assign(n, 1);
+        s.queue.resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            s.pos[tour[i]] = (int)i;
+            s.queue[i] = tour[i];
+        }
+        s.head = 0;
+        s.count = n;
+
+        while (s.count > 0)
+        {
+            const int a = s.queue[s.head];
+            s.head = s.head + 1 < n ? s.head + 1 : 0;
+            s.count--;
+            s.queued[a] = 0;
+            double gain = 0.0;
+            if (useTwoOpt)
+                gain = twoOpt(s, a);
+            if (gain == 0.0 && useOrOpt)
+                gain = orOpt(s, a);
+            length -= gain;
+        }
+        return length;
+    }
+
+    double improve(std::vector<int> &tour, size_t worker = 0)
+    {
+        return improve(tour, tourLength(tsp, tour), worker);
+    }
+
+private:
+    struct Scratch
+    {
+        std::vector<int> *tour;
+        std::vector<int> pos;
+        std::vector<char> queued; // don't-look bit cleared
+        std::vector<int> queue;   // ring of cities to look at
+        size_t head, count;
+    };
+
+    const TspInstance &tsp;
+    size_t n, k;
+    std::vector<int> neighbour; // [city][k]
+    std::vector<Scratch> scratch;
+
+    double dist(int a, int b) const { return tsp.distance(a, b); }
+
+    int succ(const Scratch &s, int c) const
+    {
+        const size_t p = s.pos[c] + 1;
+        return (*s.tour)[p < n ? p : 0];
+    }
+
+    int pred(const Scratch &s, int c) const
+    {
+        const size_t p = s.pos[c];
+        return (*s.tour)[p ? p - 1 : n - 1];
+    }
+
+    void push(Scratch &s, int c) const
+    {
+        if (s.queued[c])
+            return;
+        s.queued[c] = 1;
+        size_t tail = s.head + s.count;
+        s.queue[tail < n ? tail : tail - n] = c;
+        s.count++;
+    }
+
+    // Reverses the tour from `from` forward to `to`, or the rest of the tour
+    // when that is shorter (the same cyclic tour either way)
+    void reversePath(Scratch &s, int from, int to) const
+    {
+        std::vector<int> &t = *s.tour;
+        size_t i = s.pos[from], j = s.pos[to];
+        size_t len = (j + n - i) % n + 1;
+        if (2 * len > n)
+        {
+            i = j + 1 < n ? j + 1 : 0;
+            j = s.pos[from] ? s.pos[from] - 1 : n - 1;
+            len = n - len;
+        }
+        for (size_t m = 0; m < len / 2; m++)
+        {
+            const int ci = t[i], cj = t[j];
+            t[i] = cj;
+            s.pos[cj] = (int)i;
+            t[j] = ci;
+            s.pos[ci] = (int)j;
+            i = i + 1 < n ? i + 1 : 0;
+            j = j ? j - 1 : n - 1;
+        }
+    }
+
+    // Replaces tour edges (a, b) and (c, d), traversed in the same
+    // direction, by (a, c) and (b, d)
+    void exchange(Scratch &s, int a, int b, int c, int d) const
+    {
+        if (succ(s, a) == b)
+            reversePath(s, b, c);
+        else
+            reversePath(s, c, b);
+        push(s, a);
+        push(s, b);
+        push(s, c);
+        push(s, d);
+    }
+
+    // First improving 2-opt move with a new edge (a, c); returns its gain
+    double twoOpt(Scratch &s, int a)
+    {
+        const int *nb = &neighbour[a * k];
+        for (int dir = 0; dir < 2; dir++)
+        {
+            const int b = dir == 0 ? succ(s, a) : pred(s, a);
+            const double ab = dist(a, b);
+            for (size_t m = 0; m < k; m++)
+            {
+                const int c = nb[m];
+                const double ac = dist(a, c);
+                if (ac >= ab)
+                    break;
+                const int d = dir == 0 ? succ(s, c) : pred(s, c);
+                if (c == b || d == a)
+                    continue;
+                const double gain = ab + dist(c, d) - ac - dist(b, d);
+                if (gain > LOCAL_SEARCH_EPSILON)
+                {
+                    if (dir == 0)
+                        exchange(s, a, b, c, d);
+                    else
+                        exchange(s, b, a, d, c);
+                    return gain;
+                }
+            }
+        }
+        return 0.0;
+    }
+
+    // First improving move of a segment that starts at a (running forward
+    // or backward) to between a neighbour c of either end and a city next to
+    // c; returns its gain
+    double orOpt(Scratch &s, int a)
+    {
+        for (int dir = 0; dir < 2; dir++)
+        {
+            int end = a;
+            for (int len = 1; len <= OR_OPT_SEGMENT; len++)
+            {
+                if (len > 1)
+                    end = dir == 0 ? succ(s, end) : pred(s, end);
+                // The segment runs forward from s1 to s2
+                const int s1 = dir == 0 ? a : end, s2 = dir == 0 ? end : a;
+                const int p = pred(s, s1), nx = succ(s, s2);
+                if (p == s2 || nx == p)
+                    break;
+                const double removeGain = dist(p, s1) + dist(s2, nx) - dist(p, nx);
+                if (removeGain <= LOCAL_SEARCH_EPSILON)
+                    continue;
+                for (int side = 0; side < 2; side++)
+                {
+                    const int from = side == 0 ? s1 : s2;
+                    const int *nb = &neighbour[from * k];
+                    for (size_t m = 0; m < k; m++)
+                    {
+                        const int c = nb[m];
+                        const double fc = dist(from, c);
+                        if (fc >= removeGain)
+                            break;
+                        if (inSegment(s, c, s1, len) || c == p)
+                            continue;
+                        // Insert between c and e, on whichever side of c
+                        // keeps `from` next to it
+                        for (int after = 0; after < 2; after++)
+                        {
+                            const int e = after == 0 ? succ(s, c) : pred(s, c);
+                            if (inSegment(s, e, s1, len) || (after == 0 && e == p) || (after == 1 && c == nx))
+                                continue;
+                            const int other = from == s1 ? s2 : s1;
+                            const double gain = removeGain + dist(c, e) - fc - dist(other, e);
+                            if (gain > LOCAL_SEARCH_EPSILON)
+                            {
+                                // Forward order c, e: reversed when `from`,
+                                // next to c, is s2
+                                const int x = after == 0 ? c : e, y = after == 0 ? e : c;
+                                const bool reversed = (after == 0) == (from == s2);
+                                moveSegment(s, s1, s2, p, nx, x, y, reversed);
+                                return gain;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return 0.0;
+    }
+
+    // Whether c is one of the len cities forward from s1
+    bool inSegment(const Scratch &s, int c, int s1, int len) const
+    {
+        return (size_t)((s.pos[c] + n - s.pos[s1]) % n) < (size_t)len;
+    }
+
+    // Moves segment s1..s2 (forward, between p and nx) to between x and its
+    // successor y, reversed (x, s2 .. s1, y) or not (x, s1 .. s2, y)
+    void moveSegment(Scratch &s, int s1, int s2, int p, int nx, int x, int y, bool reversed)
+    {
+        // p s1..s2 nx .. x y  ->  p x .. nx s2..s1 y  ->  p nx .. x s2..s1 y
+        exchange(s, p, s1, x, y);
+        exchange(s, p, x, nx, s2);
+        if (!reversed && s1 != s2)
+            exchange(s, x, s2, s1, y);
+    }
+};
+
+// Runs `search` on every ant's tour inside the solver's iteration, one
+// scratch per ant
+inline void attachLocalSearch(AcoTspSolver &solver, TspLocalSearch &search)
+{
+    search.reserve(solver.antCount());
+    solver.setTourStage([&search](size_t ant, std::vector<int> &tour, double length)
+                        { return search.improve(tour, length, ant); });
+}
+
+// An improved tour and its length, cached by the tour it came from
+struct ImprovedTour
+{
+    double length;
+    std::vector<int> tour;
+
+    ImprovedTour() : length(0.0) {}
+};
+
+// As above, but an ant whose constructed tour is in `cache` (whatever its
+// rotation or direction) takes the improved tour from there instead of
+// searching again
+inline void attachLocalSearch(AcoTspSolver &solver, TspLocalSearch &search, MemoCache<ImprovedTour> &cache)
+{
+    search.reserve(solver.antCount());
+    solver.setTourStage([&search, &cache](size_t ant, std::vector<int> &tour, double length)
+                        {
+        const MemoKey key = tourKey(tour);
+        ImprovedTour improved;
+        if (cache.find(key, improved))
+        {
+            tour.swap(improved.tour);
+            return improved.length;
+        }
+        improved.length = search.improve(tour, length, ant);
+        improved.tour = tour;
+        cache.insert(key, improved);
+        return improved.length; });
+}
+
+#endif // TSP_LOCAL_SEARCH_H